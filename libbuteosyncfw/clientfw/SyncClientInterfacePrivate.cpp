@@ -22,7 +22,6 @@
  */
 
 #include <QString>
-#include <QDomDocument>
 #include <ProfileManager.h>
 #include <SyncProfile.h>
 #include <SyncResults.h>
@@ -40,6 +39,8 @@ SyncClientInterfacePrivate::SyncClientInterfacePrivate(SyncClientInterface *aPar
     : iParent(aParent)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+    SyncResults::registerDBusTypes();
+
     iServiceWatcher.addWatchedService(SYNC_DBUS_SERVICE);
     iServiceWatcher.setConnection(QDBusConnection::sessionBus());
     connect(&iServiceWatcher, &QDBusServiceWatcher::serviceOwnerChanged,
@@ -51,8 +52,9 @@ SyncClientInterfacePrivate::SyncClientInterfacePrivate(SyncClientInterface *aPar
     connect(iSyncDaemon, SIGNAL(signalProfileChanged(QString, int, QString)),
             this, SLOT(slotProfileChanged(QString, int, QString)));
 
-    connect(iSyncDaemon, SIGNAL(resultsAvailable(QString, QString)), this,
-            SLOT(resultsAvailable(QString, QString)));
+    // The typed signal carries the same results without the xml round trip
+    connect(iSyncDaemon, SIGNAL(syncResultsAvailable(QString, Buteo::SyncResults)),
+            this, SIGNAL(resultsAvailable(QString, Buteo::SyncResults)));
 
     connect(this, SIGNAL(profileChanged(QString, int, QString)),
             iParent, SIGNAL(profileChanged(QString, int, QString)));
@@ -170,19 +172,6 @@ void SyncClientInterfacePrivate::slotProfileChanged(QString aProfileId, int aCha
     emit profileChanged(aProfileId, aChangeType, aProfileAsXml);
 }
 
-void SyncClientInterfacePrivate::resultsAvailable(QString aProfileId,
-                                                  QString aLastResultsAsXml)
-{
-    FUNCTION_CALL_TRACE(lcButeoTrace);
-    QDomDocument doc;
-    if (doc.setContent(aLastResultsAsXml, true)) {
-        Buteo::SyncResults results(doc.documentElement());
-        emit resultsAvailable(aProfileId, results);
-    } else {
-        qCDebug(lcButeoCore) << "Invalid Profile Xml Received from msyncd";
-    }
-}
-
 bool SyncClientInterfacePrivate::setSyncSchedule(const QString &aProfileId,
                                                  const SyncSchedule &aSchedule)
 {
@@ -204,10 +193,7 @@ bool SyncClientInterfacePrivate::saveSyncResults(const QString &aProfileId,
     FUNCTION_CALL_TRACE(lcButeoTrace);
     bool status = false;
     if (iSyncDaemon) {
-        QString resultsAsXmlString = aSyncResults.toString();
-        if (!resultsAsXmlString.isEmpty()) {
-            status = iSyncDaemon->saveSyncResults(aProfileId, resultsAsXmlString);
-        }
+        status = iSyncDaemon->storeSyncResults(aProfileId, aSyncResults);
     }
     return status;
 }
@@ -232,15 +218,12 @@ Buteo::SyncResults SyncClientInterfacePrivate::getLastSyncResult(const QString &
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     if (iSyncDaemon) {
-        QString resultASXmlString = iSyncDaemon->getLastSyncResult(aProfileId);
-        QDomDocument doc;
-
-        if (doc.setContent(resultASXmlString, true)) {
-            Buteo::SyncResults result(doc.documentElement());
-            return result;
-        } else {
-            qCCritical(lcButeoCore) << "Invalid Profile Xml Received from msyncd";
+        QDBusPendingReply<Buteo::SyncResults> reply = iSyncDaemon->lastSyncResults(aProfileId);
+        reply.waitForFinished();
+        if (reply.isValid()) {
+            return reply.value();
         }
+        qCCritical(lcButeoCore) << "Invalid sync results received from msyncd:" << reply.error().message();
     }
     return SyncResults(QDateTime(),
                        SyncResults::SYNC_RESULT_INVALID, SyncResults::NO_ERROR);
@@ -197,19 +197,6 @@ public slots:
      */
     void slotProfileChanged(QString aProfileId, int aChangeType, QString aChangedProfileAsXml);
 
-    /*! \brief this is the slot where we will receive the xml data for results from msyncd
-     * the xml looks like this
-     * \code <syncresults scheduled="false" majorcode="0" minorcode = "0" time="2010-06-01T06:43:32">
-     *  <target name="">
-     *   <local modified="0" added="0" deleted="0"/>
-     *  <remote modified="0" added="4" deleted="0"/>
-     *  </target>
-     * </syncresults>
-     *\endcode
-     * @param aProfileId - id of the profile
-     * @param aLastSyncResultAsXml - last sync result as xml
-     */
-    void resultsAvailable(QString aProfileId, QString aLastSyncResultAsXml);
 
 signals:
     /*! \brief Signal that gets emitted on receiving profileChanged from msyncd
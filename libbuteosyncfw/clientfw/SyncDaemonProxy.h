@@ -43,6 +43,8 @@
 #include <QtCore/QVariant>
 #include <QtDBus/QtDBus>
 
+#include "SyncResults.h"
+
 /*! \brief Proxy class for interface com.meego.msyncd
  */
 class SyncDaemonProxy: public QDBusAbstractInterface
@@ -102,6 +104,14 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QLatin1String("getLastSyncResult"), argumentList);
     }
 
+    //! \see SyncDBusInterface::lastSyncResults()
+    inline QDBusPendingReply<Buteo::SyncResults> lastSyncResults(const QString &aProfileId)
+    {
+        QList<QVariant> argumentList;
+        argumentList << qVariantFromValue(aProfileId);
+        return asyncCallWithArgumentList(QLatin1String("lastSyncResults"), argumentList);
+    }
+
     //! \see SyncDBusInterface::isLastSyncScheduled()
     inline QDBusPendingReply<bool> isLastSyncScheduled(const QString &aProfileId)
     {
@@ -180,6 +190,14 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QLatin1String("setSyncSchedule"), argumentList);
     }
 
+    //! \see SyncDBusInterface::storeSyncResults()
+    inline QDBusPendingReply<bool> storeSyncResults(const QString &aProfileId, const Buteo::SyncResults &aSyncResults)
+    {
+        QList<QVariant> argumentList;
+        argumentList << qVariantFromValue(aProfileId) << qVariantFromValue(aSyncResults);
+        return asyncCallWithArgumentList(QLatin1String("storeSyncResults"), argumentList);
+    }
+
     //! \see SyncDBusInterface::startSync()
     inline QDBusPendingReply<bool> startSync(const QString &aProfileId)
     {
@@ -248,6 +266,9 @@ Q_SIGNALS: // SIGNALS
     //! \see SyncDBusInterface::signalProfileChanged()
     void signalProfileChanged(const QString &aProfileName, int aChangeType, const QString &aProfileAsXml);
 
+    //! \see SyncDBusInterface::syncResultsAvailable()
+    void syncResultsAvailable(const QString &aProfileName, const Buteo::SyncResults &aResults);
+
     //! \see SyncDBusInterface::syncStatus()
     void syncStatus(const QString &aProfileName, int aStatus, const QString &aMessage, int aErrorCode);
 
@@ -0,0 +1,186 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "AsyncLogWriter.h"
+#include "Metrics.h"
+
+using namespace Buteo;
+
+// Records waiting for the writer thread, beyond which records are
+// dropped.
+static const int MAX_QUEUED_RECORDS = 4096;
+
+AsyncLogWriter *AsyncLogWriter::instance()
+{
+    // Never destroyed, the handler may still be called during exit.
+    static AsyncLogWriter *writer = new AsyncLogWriter;
+    return writer;
+}
+
+AsyncLogWriter::AsyncLogWriter()
+    : iWriteMutex(QMutex::Recursive)
+    , iDropped(0)
+    , iReportedDropped(0)
+    , iInstalled(false)
+    , iStopping(false)
+    , iPreviousHandler(nullptr)
+{
+}
+
+void AsyncLogWriter::install()
+{
+    if (iInstalled) {
+        return;
+    }
+
+    iInstalled = true;
+    iPreviousHandler = qInstallMessageHandler(handleMessage);
+    start(QThread::LowPriority);
+}
+
+void AsyncLogWriter::shutdown()
+{
+    {
+        QMutexLocker locker(&iMutex);
+        if (!iInstalled || iStopping) {
+            return;
+        }
+        iStopping = true;
+        iNotEmpty.wakeAll();
+    }
+    wait();
+}
+
+quint64 AsyncLogWriter::droppedCount() const
+{
+    QMutexLocker locker(&iMutex);
+    return iDropped;
+}
+
+void AsyncLogWriter::handleMessage(QtMsgType aType, const QMessageLogContext &aContext, const QString &aMessage)
+{
+    AsyncLogWriter *writer = instance();
+
+    // Fatal messages abort once the handler returns, and records logged by
+    // the writer thread itself cannot wait for the queue.
+    if (aType == QtFatalMsg) {
+        // Hold the write lock until the fatal record is out, so that the
+        // writer thread cannot interleave with it.
+        QMutexLocker locker(&writer->iWriteMutex);
+        writer->flush();
+        writer->iPreviousHandler(aType, aContext, aMessage);
+        return;
+    }
+    if (QThread::currentThread() == writer) {
+        writer->iPreviousHandler(aType, aContext, aMessage);
+        return;
+    }
+
+    writer->enqueue(aType, aContext, aMessage);
+}
+
+void AsyncLogWriter::enqueue(QtMsgType aType, const QMessageLogContext &aContext, const QString &aMessage)
+{
+    QMutexLocker locker(&iMutex);
+
+    if (iQueue.count() >= MAX_QUEUED_RECORDS && !iStopping) {
+        ++iDropped;
+        static MetricsCounter *dropCounter = Metrics::instance()->counter(
+                    QStringLiteral("msyncd_log_records_dropped_total"));
+        dropCounter->add();
+        return;
+    }
+
+    if (iStopping) {
+        locker.unlock();
+        iPreviousHandler(aType, aContext, aMessage);
+        return;
+    }
+
+    // Only wake the writer when it may be waiting, later records are
+    // picked up in the same batch.
+    if (iQueue.isEmpty()) {
+        iNotEmpty.wakeOne();
+    }
+    Record record = { aType, QByteArray(aContext.category), QByteArray(aContext.file), aContext.line,
+                      QByteArray(aContext.function), aMessage };
+    iQueue.append(record);
+}
+
+void AsyncLogWriter::run()
+{
+    forever {
+        QVector<Record> batch;
+        quint64 dropped = 0;
+        bool stopping = false;
+        {
+            QMutexLocker locker(&iMutex);
+            while (iQueue.isEmpty() && !iStopping) {
+                iNotEmpty.wait(&iMutex);
+            }
+            batch.swap(iQueue);
+            dropped = iDropped - iReportedDropped;
+            iReportedDropped = iDropped;
+            stopping = iStopping;
+        }
+
+        {
+            QMutexLocker locker(&iWriteMutex);
+            write(batch, dropped);
+        }
+
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+void AsyncLogWriter::flush()
+{
+    QMutexLocker writeLocker(&iWriteMutex);
+
+    QVector<Record> batch;
+    quint64 dropped = 0;
+    {
+        QMutexLocker locker(&iMutex);
+        batch.swap(iQueue);
+        dropped = iDropped - iReportedDropped;
+        iReportedDropped = iDropped;
+    }
+
+    write(batch, dropped);
+}
+
+void AsyncLogWriter::write(const QVector<Record> &aRecords, quint64 aDropped)
+{
+    if (aDropped > 0) {
+        QMessageLogContext context(nullptr, 0, nullptr, "buteo.core");
+        iPreviousHandler(QtWarningMsg, context,
+                         QStringLiteral("Log queue full, %1 records dropped").arg(aDropped));
+    }
+
+    for (const Record &record : aRecords) {
+        QMessageLogContext context(record.iFile.isNull() ? nullptr : record.iFile.constData(), record.iLine,
+                                   record.iFunction.isNull() ? nullptr : record.iFunction.constData(),
+                                   record.iCategory.isNull() ? "default" : record.iCategory.constData());
+        iPreviousHandler(record.iType, context, record.iMessage);
+    }
+}
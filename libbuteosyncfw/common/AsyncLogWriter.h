@@ -0,0 +1,113 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef ASYNCLOGWRITER_H
+#define ASYNCLOGWRITER_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+namespace Buteo {
+
+/*!
+ * \brief Writes log output on a dedicated thread.
+ *
+ * Once installed, the message handler only queues the already formatted
+ * record; the writer thread passes the queued records in batches to the
+ * previous message handler, which writes them to stderr or the journal.
+ *
+ * The queue is bounded. When it is full, records are dropped and counted
+ * rather than making the logging thread wait, whatever their type. The
+ * number of dropped records is reported in the log once there is room
+ * again. Fatal messages flush the queue and are written synchronously.
+ */
+class AsyncLogWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    //! Returns the writer instance
+    static AsyncLogWriter *instance();
+
+    /*!
+     * \brief Starts the writer thread and installs the message handler.
+     *
+     * Message handlers installed after this one, such as LogRingBuffer,
+     * still run on the logging thread before the record is queued.
+     */
+    void install();
+
+    /*!
+     * \brief Writes out the queued records and stops the writer thread.
+     *
+     * Records logged afterwards are written synchronously.
+     */
+    void shutdown();
+
+    //! Number of records dropped because the queue was full
+    quint64 droppedCount() const;
+
+protected:
+    //! \see QThread::run
+    virtual void run();
+
+private:
+    // The context strings are copied, they are not guaranteed to outlive
+    // the logging call (e.g. records from a plugin that gets unloaded).
+    struct Record {
+        QtMsgType iType;
+        QByteArray iCategory;
+        QByteArray iFile;
+        int iLine;
+        QByteArray iFunction;
+        QString iMessage;
+    };
+
+    AsyncLogWriter();
+
+    static void handleMessage(QtMsgType aType, const QMessageLogContext &aContext, const QString &aMessage);
+
+    void enqueue(QtMsgType aType, const QMessageLogContext &aContext, const QString &aMessage);
+
+    void write(const QVector<Record> &aRecords, quint64 aDropped);
+
+    void flush();
+
+    mutable QMutex iMutex;
+    // Serializes writing between the writer thread and fatal messages.
+    // Recursive, as a fatal message may come from the writer thread.
+    QMutex iWriteMutex;
+    QWaitCondition iNotEmpty;
+    QVector<Record> iQueue;
+    quint64 iDropped;
+    quint64 iReportedDropped;
+    bool iInstalled;
+    bool iStopping;
+    QtMessageHandler iPreviousHandler;
+};
+
+}
+
+#endif // ASYNCLOGWRITER_H
@@ -29,11 +29,18 @@
 /*!
  * Creates a trace message to log when the function is entered and exited.
  * Logs also to time spent in the function.
+ *
+ * The tracer lives on the stack and only keeps pointers to the category
+ * and to the function name literal, so nothing is allocated even when
+ * tracing is enabled. Defining BUTEO_DISABLE_CALL_TRACE compiles the
+ * trace points out altogether.
  */
+#ifdef BUTEO_DISABLE_CALL_TRACE
+#define FUNCTION_CALL_TRACE(loggingCategory) \
+    do { } while (0)
+#else
 #define FUNCTION_CALL_TRACE(loggingCategory) \
-    QScopedPointer<Buteo::LogTimer> timerDebugVariable( \
-            Buteo::isLoggingEnabled(loggingCategory()) \
-            ? new Buteo::LogTimer(QString::fromUtf8(loggingCategory().categoryName()), QString(Q_FUNC_INFO)) \
-            : nullptr)
+    const Buteo::CallTrace callTraceVariable(loggingCategory(), Q_FUNC_INFO)
+#endif
 
 #endif // LOGMACROS_H
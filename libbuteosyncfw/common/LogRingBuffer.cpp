@@ -0,0 +1,301 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "LogRingBuffer.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace Buteo;
+
+static const char *const CAPTURED_CATEGORIES[] = { "buteo.core", "buteo.msyncd", "buteo.plugin" };
+static const int CAPTURED_CATEGORY_COUNT = sizeof(CAPTURED_CATEGORIES) / sizeof(CAPTURED_CATEGORIES[0]);
+
+// Message types enabled for each captured category by the logging rules,
+// before the capture filter forced them all on. Only used with debug
+// capture.
+static QAtomicInt originalLevels[CAPTURED_CATEGORY_COUNT];
+static bool captureDebug = false;
+
+static QLoggingCategory::CategoryFilter previousFilter = nullptr;
+static QtMessageHandler previousHandler = nullptr;
+
+static int capturedIndex(const char *aCategory)
+{
+    if (aCategory) {
+        for (int i = 0; i < CAPTURED_CATEGORY_COUNT; ++i) {
+            if (strcmp(aCategory, CAPTURED_CATEGORIES[i]) == 0) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+static int levelBit(QtMsgType aType)
+{
+    switch (aType) {
+    case QtDebugMsg:
+        return 0x1;
+    case QtInfoMsg:
+        return 0x2;
+    case QtWarningMsg:
+        return 0x4;
+    case QtCriticalMsg:
+        return 0x8;
+    default:
+        return 0x10;
+    }
+}
+
+static void captureFilter(QLoggingCategory *aCategory)
+{
+    if (previousFilter) {
+        previousFilter(aCategory);
+    }
+
+    int index = capturedIndex(aCategory->categoryName());
+    if (index < 0) {
+        return;
+    }
+
+    int levels = 0;
+    levels |= aCategory->isDebugEnabled() ? levelBit(QtDebugMsg) : 0;
+    levels |= aCategory->isInfoEnabled() ? levelBit(QtInfoMsg) : 0;
+    levels |= aCategory->isWarningEnabled() ? levelBit(QtWarningMsg) : 0;
+    levels |= aCategory->isCriticalEnabled() ? levelBit(QtCriticalMsg) : 0;
+    originalLevels[index].store(levels);
+
+    aCategory->setEnabled(QtDebugMsg, true);
+    aCategory->setEnabled(QtInfoMsg, true);
+    aCategory->setEnabled(QtWarningMsg, true);
+    aCategory->setEnabled(QtCriticalMsg, true);
+}
+
+static void captureHandler(QtMsgType aType, const QMessageLogContext &aContext, const QString &aMessage)
+{
+    int index = capturedIndex(aContext.category);
+    if (index >= 0) {
+        LogRingBuffer::instance()->append(aType, CAPTURED_CATEGORIES[index], aMessage);
+        if (captureDebug && aType != QtFatalMsg && !(originalLevels[index].load() & levelBit(aType))) {
+            return;
+        }
+    }
+
+    if (previousHandler) {
+        previousHandler(aType, aContext, aMessage);
+    }
+}
+
+static void appendText(char *aBuffer, int &aPos, const char *aText, int aLength)
+{
+    memcpy(aBuffer + aPos, aText, aLength);
+    aPos += aLength;
+}
+
+static void appendNumber(char *aBuffer, int &aPos, qint64 aNumber)
+{
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = '0' + (aNumber % 10);
+        aNumber /= 10;
+    } while (aNumber > 0 && count < int(sizeof(digits)));
+    while (count > 0) {
+        aBuffer[aPos++] = digits[--count];
+    }
+}
+
+static char typeLetter(QtMsgType aType)
+{
+    switch (aType) {
+    case QtDebugMsg:
+        return 'D';
+    case QtInfoMsg:
+        return 'I';
+    case QtWarningMsg:
+        return 'W';
+    case QtCriticalMsg:
+        return 'C';
+    default:
+        return 'F';
+    }
+}
+
+LogRingBuffer *LogRingBuffer::instance()
+{
+    static LogRingBuffer buffer;
+    return &buffer;
+}
+
+LogRingBuffer::LogRingBuffer()
+    : iNext(0)
+{
+    for (int i = 0; i < SLOT_COUNT; ++i) {
+        iSlots[i].iBusy.store(0);
+        iSlots[i].iSequence = 0;
+    }
+    iDumpPrefix[0] = '\0';
+}
+
+void LogRingBuffer::install(const QString &aDumpPrefix, bool aCaptureDebug)
+{
+    if (previousHandler) {
+        return;
+    }
+
+    qstrncpy(iDumpPrefix, QFile::encodeName(aDumpPrefix).constData(), MAX_PATH_LENGTH);
+    captureDebug = aCaptureDebug;
+    previousHandler = qInstallMessageHandler(captureHandler);
+    if (captureDebug) {
+        previousFilter = QLoggingCategory::installFilter(captureFilter);
+    }
+}
+
+void LogRingBuffer::append(QtMsgType aType, const char *aCategory, const QString &aMessage)
+{
+    const QByteArray text = aMessage.toUtf8();
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+    const qint64 sequence = iNext.fetchAndAddRelaxed(1);
+
+    Slot &slot = iSlots[sequence % SLOT_COUNT];
+    if (!slot.iBusy.testAndSetAcquire(0, 1)) {
+        return;
+    }
+    slot.iTimestamp = timestamp;
+    slot.iType = aType;
+    slot.iCategory = aCategory;
+    slot.iLength = qMin(text.size(), int(MAX_TEXT_LENGTH));
+    memcpy(slot.iText, text.constData(), slot.iLength);
+    slot.iSequence = sequence + 1;
+    slot.iBusy.storeRelease(0);
+}
+
+QString LogRingBuffer::dump()
+{
+    char path[MAX_PATH_LENGTH + 32];
+    int fd = openDumpFile(path);
+    if (fd < 0) {
+        return QString();
+    }
+    bool written = dumpToFd(fd);
+    if (::close(fd) != 0 || !written) {
+        return QString();
+    }
+
+    // Keep the most recent dumps only. The timestamps have the same number
+    // of digits, so name order is age order.
+    const QFileInfo prefix(QFile::decodeName(iDumpPrefix));
+    QDir dir = prefix.dir();
+    QStringList dumps = dir.entryList(QStringList() << prefix.fileName() + QStringLiteral("-*.log"),
+                                      QDir::Files, QDir::Name);
+    while (dumps.count() > MAX_DUMP_FILES) {
+        dir.remove(dumps.takeFirst());
+    }
+
+    return QFile::decodeName(path);
+}
+
+bool LogRingBuffer::dump(const QString &aPath)
+{
+    int fd = ::open(QFile::encodeName(aPath).constData(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = dumpToFd(fd);
+    return (::close(fd) == 0) && written;
+}
+
+void LogRingBuffer::dumpFromSignalHandler()
+{
+    LogRingBuffer *buffer = instance();
+    char path[MAX_PATH_LENGTH + 32];
+    int fd = buffer->openDumpFile(path);
+    if (fd >= 0) {
+        buffer->dumpToFd(fd);
+        ::close(fd);
+    }
+}
+
+int LogRingBuffer::openDumpFile(char *aPath)
+{
+    // Called from signal handlers, so no allocations here.
+    if (iDumpPrefix[0] == '\0') {
+        return -1;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    const qint64 msecs = qint64(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+
+    int pos = 0;
+    appendText(aPath, pos, iDumpPrefix, int(strlen(iDumpPrefix)));
+    aPath[pos++] = '-';
+    appendNumber(aPath, pos, msecs);
+    appendText(aPath, pos, ".log", 4);
+    aPath[pos] = '\0';
+
+    return ::open(aPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+}
+
+bool LogRingBuffer::dumpToFd(int aFd)
+{
+    // Called from signal handlers, so no allocations and no locks here.
+    char line[MAX_TEXT_LENGTH + 64];
+    bool ok = true;
+
+    const qint64 end = iNext.load();
+    const qint64 begin = qMax<qint64>(0, end - SLOT_COUNT);
+    for (qint64 sequence = begin; sequence < end; ++sequence) {
+        Slot &slot = iSlots[sequence % SLOT_COUNT];
+        if (!slot.iBusy.testAndSetAcquire(0, 1)) {
+            continue;
+        }
+
+        int pos = 0;
+        if (slot.iSequence == sequence + 1) {
+            appendNumber(line, pos, slot.iTimestamp);
+            line[pos++] = ' ';
+            line[pos++] = typeLetter(slot.iType);
+            line[pos++] = ' ';
+            appendText(line, pos, slot.iCategory, qMin(int(strlen(slot.iCategory)), 32));
+            line[pos++] = ':';
+            line[pos++] = ' ';
+            appendText(line, pos, slot.iText, slot.iLength);
+            line[pos++] = '\n';
+        }
+        slot.iBusy.storeRelease(0);
+
+        if (pos > 0 && ::write(aFd, line, pos) != pos) {
+            ok = false;
+        }
+    }
+
+    return ok;
+}
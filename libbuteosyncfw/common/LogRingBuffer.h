@@ -0,0 +1,126 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef LOGRINGBUFFER_H
+#define LOGRINGBUFFER_H
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QString>
+#include <QtGlobal>
+
+namespace Buteo {
+
+/*!
+ * \brief Keeps the most recent log records of the buteo.core, buteo.msyncd
+ *        and buteo.plugin categories in memory.
+ *
+ * Once installed, the records enabled by the logging rules
+ * (MSYNCD_LOGGING_LEVEL, QT_LOGGING_RULES) are captured into a fixed size
+ * ring buffer. Debug capture can be turned on separately, in which case
+ * the extra records are kept in the buffer only and not passed on to the
+ * regular message handler; this makes every debug statement in those
+ * categories format its message, so it is off by default. The buffer can
+ * be written to a file on demand, including from a signal handler.
+ *
+ * Writers never block: a record that would overwrite a slot which is
+ * being written or read at the same moment is dropped.
+ */
+class LogRingBuffer
+{
+public:
+    //! Returns the buffer instance
+    static LogRingBuffer *instance();
+
+    /*!
+     * \brief Starts capturing log records.
+     *
+     * Installs a message handler, and a logging category filter if debug
+     * capture is on. Should be called once, early in main().
+     *
+     * @param aDumpPrefix Path prefix for dump files, which are named
+     *        "<prefix>-<msecs since epoch>.log"
+     * @param aCaptureDebug Also capture records disabled by the logging
+     *        rules
+     */
+    void install(const QString &aDumpPrefix, bool aCaptureDebug = false);
+
+    /*!
+     * \brief Writes the buffered records to a new dump file, oldest first.
+     *
+     * Only the most recent MAX_DUMP_FILES dump files are kept.
+     *
+     * @return Path of the written file, empty on failure
+     */
+    QString dump();
+
+    /*!
+     * \brief Writes the buffered records to the given file, oldest first.
+     *
+     * @param aPath File to write to
+     * @return True on success
+     */
+    bool dump(const QString &aPath);
+
+    /*!
+     * \brief Writes the buffered records to a new dump file.
+     *
+     * Only uses async-signal-safe functions, so it may be called from a
+     * handler for fatal signals. Old dump files are not pruned.
+     */
+    static void dumpFromSignalHandler();
+
+    //! Adds a record to the buffer
+    void append(QtMsgType aType, const char *aCategory, const QString &aMessage);
+
+private:
+    enum {
+        SLOT_COUNT = 1024,
+        MAX_TEXT_LENGTH = 240,
+        MAX_PATH_LENGTH = 512,
+        MAX_DUMP_FILES = 5
+    };
+
+    struct Slot {
+        QAtomicInt iBusy;
+        qint64 iSequence;  // sequence number + 1, 0 for an empty slot
+        qint64 iTimestamp;
+        QtMsgType iType;
+        const char *iCategory;
+        int iLength;
+        char iText[MAX_TEXT_LENGTH];
+    };
+
+    LogRingBuffer();
+
+    bool dumpToFd(int aFd);
+    int openDumpFile(char *aPath);
+
+    QAtomicInteger<qint64> iNext;
+    Slot iSlots[SLOT_COUNT];
+    char iDumpPrefix[MAX_PATH_LENGTH];
+
+    Q_DISABLE_COPY(LogRingBuffer)
+};
+
+}
+
+#endif // LOGRINGBUFFER_H
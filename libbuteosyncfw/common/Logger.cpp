@@ -44,6 +44,18 @@ LogTimer::~LogTimer()
     qCDebug(m_category) << m_func << ":Exit, execution time:" << m_timer.elapsed() << "ms";
 }
 
+void CallTrace::entry()
+{
+    QMessageLogger(nullptr, 0, nullptr, m_category->categoryName()).debug() << m_func << ":Entry";
+    m_timer.start();
+}
+
+void CallTrace::exit()
+{
+    QMessageLogger(nullptr, 0, nullptr, m_category->categoryName()).debug()
+            << m_func << ":Exit, execution time:" << m_timer.elapsed() << "ms";
+}
+
 bool Buteo::isLoggingEnabled(const QLoggingCategory &loggingCategory)
 {
     return loggingCategory.isDebugEnabled() && !forceDisableTraceLogging;
@@ -33,6 +33,8 @@ namespace Buteo {
 
 /*!
  * \brief Helper class for timing function execution time.
+ *
+ * Kept for existing users; FUNCTION_CALL_TRACE uses the cheaper CallTrace.
  */
 class LogTimer
 {
@@ -59,6 +61,54 @@ private:
 
 bool isLoggingEnabled(const QLoggingCategory &loggingCategory);
 
+/*!
+ * \brief Stack-only function entry/exit tracer, see FUNCTION_CALL_TRACE.
+ *
+ * Unlike LogTimer it does not copy the category or the function name,
+ * and the check for a disabled category is inlined.
+ */
+class CallTrace
+{
+public:
+    /*!
+     * \brief Constructor. Creates an entry message to the log if
+     *        loggingCategory has debug output enabled.
+     *
+     * @param loggingCategory Category to log to, must outlive the tracer.
+     * @param func Name of the function, must be a string literal.
+     */
+    inline CallTrace(const QLoggingCategory &loggingCategory, const char *func)
+        : m_category(nullptr)
+        , m_func(func)
+    {
+        if (loggingCategory.isDebugEnabled() && isLoggingEnabled(loggingCategory)) {
+            m_category = &loggingCategory;
+            entry();
+        }
+    }
+
+    /*!
+     * \brief Destructor. Creates an exit message to the log, including
+     *        function execution time.
+     */
+    inline ~CallTrace()
+    {
+        if (m_category) {
+            exit();
+        }
+    }
+
+private:
+    void entry();
+    void exit();
+
+    const QLoggingCategory *m_category;
+    const char *m_func;
+    QElapsedTimer m_timer;
+
+    Q_DISABLE_COPY(CallTrace)
+};
+
 void configureLegacyLogging();
 
 }
@@ -0,0 +1,227 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "Metrics.h"
+#include "LogMacros.h"
+
+#include <QSaveFile>
+#include <QTextStream>
+
+using namespace Buteo;
+
+static const qint64 BUCKET_BOUNDS[] = { 1, 5, 10, 50, 100, 500, 1000, 5000, 10000, 30000, 60000 };
+
+MetricsCounter::MetricsCounter()
+    : iValue(0)
+{
+}
+
+void MetricsCounter::add(qint64 aValue)
+{
+    iValue.fetchAndAddRelaxed(aValue);
+}
+
+qint64 MetricsCounter::value() const
+{
+    return iValue.load();
+}
+
+MetricsGauge::MetricsGauge()
+    : iValue(0)
+{
+}
+
+void MetricsGauge::set(qint64 aValue)
+{
+    iValue.store(aValue);
+}
+
+void MetricsGauge::add(qint64 aDelta)
+{
+    iValue.fetchAndAddRelaxed(aDelta);
+}
+
+qint64 MetricsGauge::value() const
+{
+    return iValue.load();
+}
+
+MetricsHistogram::MetricsHistogram()
+    : iCount(0)
+    , iSum(0)
+{
+    Q_STATIC_ASSERT(sizeof(BUCKET_BOUNDS) / sizeof(BUCKET_BOUNDS[0]) == BOUND_COUNT);
+    for (int i = 0; i <= BOUND_COUNT; ++i) {
+        iBuckets[i].store(0);
+    }
+}
+
+void MetricsHistogram::record(qint64 aMsecs)
+{
+    int index = 0;
+    while (index < BOUND_COUNT && aMsecs > BUCKET_BOUNDS[index]) {
+        ++index;
+    }
+    iBuckets[index].fetchAndAddRelaxed(1);
+    iCount.fetchAndAddRelaxed(1);
+    iSum.fetchAndAddRelaxed(aMsecs);
+}
+
+qint64 MetricsHistogram::count() const
+{
+    return iCount.load();
+}
+
+qint64 MetricsHistogram::sum() const
+{
+    return iSum.load();
+}
+
+qint64 MetricsHistogram::bucketCount(int aIndex) const
+{
+    if (aIndex < 0 || aIndex > BOUND_COUNT) {
+        return 0;
+    }
+    return iBuckets[aIndex].load();
+}
+
+QVector<qint64> MetricsHistogram::bucketBounds()
+{
+    QVector<qint64> bounds;
+    bounds.reserve(BOUND_COUNT);
+    for (int i = 0; i < BOUND_COUNT; ++i) {
+        bounds.append(BUCKET_BOUNDS[i]);
+    }
+    return bounds;
+}
+
+MetricsTimer::MetricsTimer(MetricsHistogram *aHistogram)
+    : iHistogram(aHistogram)
+{
+    iTimer.start();
+}
+
+MetricsTimer::~MetricsTimer()
+{
+    if (iHistogram) {
+        iHistogram->record(iTimer.elapsed());
+    }
+}
+
+Metrics *Metrics::instance()
+{
+    static Metrics metrics;
+    return &metrics;
+}
+
+Metrics::Metrics()
+{
+}
+
+Metrics::~Metrics()
+{
+    qDeleteAll(iCounters);
+    qDeleteAll(iGauges);
+    qDeleteAll(iHistograms);
+}
+
+MetricsCounter *Metrics::counter(const QString &aName)
+{
+    QMutexLocker locker(&iMutex);
+    MetricsCounter *&counter = iCounters[aName];
+    if (!counter) {
+        counter = new MetricsCounter;
+    }
+    return counter;
+}
+
+MetricsGauge *Metrics::gauge(const QString &aName)
+{
+    QMutexLocker locker(&iMutex);
+    MetricsGauge *&gauge = iGauges[aName];
+    if (!gauge) {
+        gauge = new MetricsGauge;
+    }
+    return gauge;
+}
+
+MetricsHistogram *Metrics::histogram(const QString &aName)
+{
+    QMutexLocker locker(&iMutex);
+    MetricsHistogram *&histogram = iHistograms[aName];
+    if (!histogram) {
+        histogram = new MetricsHistogram;
+    }
+    return histogram;
+}
+
+QString Metrics::toText() const
+{
+    QString text;
+    QTextStream out(&text);
+
+    QMutexLocker locker(&iMutex);
+
+    for (auto it = iCounters.constBegin(); it != iCounters.constEnd(); ++it) {
+        out << "# TYPE " << it.key() << " counter\n"
+            << it.key() << ' ' << it.value()->value() << '\n';
+    }
+
+    for (auto it = iGauges.constBegin(); it != iGauges.constEnd(); ++it) {
+        out << "# TYPE " << it.key() << " gauge\n"
+            << it.key() << ' ' << it.value()->value() << '\n';
+    }
+
+    const QVector<qint64> bounds = MetricsHistogram::bucketBounds();
+    for (auto it = iHistograms.constBegin(); it != iHistograms.constEnd(); ++it) {
+        const MetricsHistogram *histogram = it.value();
+        out << "# TYPE " << it.key() << " histogram\n";
+        // Buckets are exported cumulatively, as the format expects.
+        qint64 cumulative = 0;
+        for (int i = 0; i < bounds.count(); ++i) {
+            cumulative += histogram->bucketCount(i);
+            out << it.key() << "_bucket{le=\"" << bounds.at(i) << "\"} " << cumulative << '\n';
+        }
+        cumulative += histogram->bucketCount(bounds.count());
+        out << it.key() << "_bucket{le=\"+Inf\"} " << cumulative << '\n'
+            << it.key() << "_sum " << histogram->sum() << '\n'
+            << it.key() << "_count " << histogram->count() << '\n';
+    }
+
+    out.flush();
+    return text;
+}
+
+bool Metrics::writeToFile(const QString &aPath) const
+{
+    QSaveFile file(aPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(lcButeoCore) << "Failed to open metrics file for writing:" << aPath;
+        return false;
+    }
+
+    file.write(toText().toUtf8());
+    if (!file.commit()) {
+        qCWarning(lcButeoCore) << "Failed to write metrics file:" << aPath;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,185 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+namespace Buteo {
+
+/*!
+ * \brief Monotonically increasing counter.
+ *
+ * Updates are lock-free, so a counter can be bumped from any thread.
+ */
+class MetricsCounter
+{
+public:
+    MetricsCounter();
+
+    //! Adds aValue to the counter
+    void add(qint64 aValue = 1);
+
+    //! Current counter value
+    qint64 value() const;
+
+private:
+    QAtomicInteger<qint64> iValue;
+};
+
+/*!
+ * \brief Value that can go up and down, for example a queue length.
+ */
+class MetricsGauge
+{
+public:
+    MetricsGauge();
+
+    //! Sets the gauge to aValue
+    void set(qint64 aValue);
+
+    //! Adds aDelta (which may be negative) to the gauge
+    void add(qint64 aDelta);
+
+    //! Current gauge value
+    qint64 value() const;
+
+private:
+    QAtomicInteger<qint64> iValue;
+};
+
+/*!
+ * \brief Latency histogram with fixed millisecond buckets.
+ *
+ * The bucket bounds are shared by all histograms, see bucketBounds().
+ * Recording a sample is lock-free.
+ */
+class MetricsHistogram
+{
+public:
+    MetricsHistogram();
+
+    //! Records a sample of aMsecs milliseconds
+    void record(qint64 aMsecs);
+
+    //! Number of recorded samples
+    qint64 count() const;
+
+    //! Sum of all recorded samples in milliseconds
+    qint64 sum() const;
+
+    /*!
+     * \brief Number of samples that fell into bucket aIndex.
+     *
+     * Bucket i holds samples <= bucketBounds()[i]; the last bucket,
+     * at index bucketBounds().count(), holds everything larger.
+     */
+    qint64 bucketCount(int aIndex) const;
+
+    //! Upper bounds of the histogram buckets in milliseconds
+    static QVector<qint64> bucketBounds();
+
+private:
+    enum { BOUND_COUNT = 11 };
+
+    QAtomicInteger<qint64> iBuckets[BOUND_COUNT + 1];
+    QAtomicInteger<qint64> iCount;
+    QAtomicInteger<qint64> iSum;
+
+    Q_DISABLE_COPY(MetricsHistogram)
+};
+
+/*!
+ * \brief Records the lifetime of the object into a histogram.
+ */
+class MetricsTimer
+{
+public:
+    /*!
+     * \brief Constructor, starts timing.
+     *
+     * @param aHistogram Histogram to record into, may be null.
+     */
+    explicit MetricsTimer(MetricsHistogram *aHistogram);
+
+    //! Destructor, records the elapsed time
+    ~MetricsTimer();
+
+private:
+    MetricsHistogram *iHistogram;
+    QElapsedTimer iTimer;
+};
+
+/*!
+ * \brief Process wide registry of counters, gauges and histograms.
+ *
+ * Metrics are created on first lookup and live as long as the process,
+ * so callers may cache the returned pointers. Lookups take a lock,
+ * updates through the returned objects do not.
+ */
+class Metrics
+{
+public:
+    //! Returns the registry instance
+    static Metrics *instance();
+
+    //! Returns counter aName, creating it if needed
+    MetricsCounter *counter(const QString &aName);
+
+    //! Returns gauge aName, creating it if needed
+    MetricsGauge *gauge(const QString &aName);
+
+    //! Returns histogram aName, creating it if needed
+    MetricsHistogram *histogram(const QString &aName);
+
+    /*!
+     * \brief Dumps all metrics in the Prometheus text exposition format.
+     */
+    QString toText() const;
+
+    /*!
+     * \brief Writes toText() atomically to aPath.
+     *
+     * @return True on success
+     */
+    bool writeToFile(const QString &aPath) const;
+
+private:
+    Metrics();
+    ~Metrics();
+
+    mutable QMutex iMutex;
+    QMap<QString, MetricsCounter *> iCounters;
+    QMap<QString, MetricsGauge *> iGauges;
+    QMap<QString, MetricsHistogram *> iHistograms;
+
+    Q_DISABLE_COPY(Metrics)
+};
+
+}
+
+#endif // METRICS_H
@@ -0,0 +1,212 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "TraceRecorder.h"
+#include "LogMacros.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QSaveFile>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace Buteo;
+
+// Upper bound for the in-memory event buffer, so that a forgotten trace
+// cannot grow without limit. Later events are dropped.
+static const int MAX_TRACE_EVENTS = 200000;
+
+QAtomicInt TraceRecorder::iEnabled(0);
+
+static qint64 currentThreadId()
+{
+    static thread_local qint64 threadId = static_cast<qint64>(syscall(SYS_gettid));
+    return threadId;
+}
+
+TraceRecorder *TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return &recorder;
+}
+
+TraceRecorder::TraceRecorder()
+{
+    iClock.start();
+    // One writer keeps back to back traces in order.
+    iWriter.setMaxThreadCount(1);
+}
+
+bool TraceRecorder::start(const QString &aPath)
+{
+    QMutexLocker locker(&iMutex);
+
+    if (iEnabled.load()) {
+        qCWarning(lcButeoCore) << "Trace recording already running, writing to" << iPath;
+        return false;
+    }
+
+    iPath = aPath;
+    iEvents.clear();
+    iClock.restart();
+    iEnabled.store(1);
+    qCInfo(lcButeoCore) << "Trace recording started, writing to" << iPath;
+    return true;
+}
+
+bool TraceRecorder::stop()
+{
+    QVector<Event> events;
+    QString path;
+    {
+        QMutexLocker locker(&iMutex);
+        if (!iEnabled.load()) {
+            return false;
+        }
+        iEnabled.store(0);
+        events.swap(iEvents);
+        path = iPath;
+    }
+
+    // Serializing a full buffer takes a while, keep it off the caller's
+    // thread which usually is the main loop.
+    class WriteTask : public QRunnable
+    {
+    public:
+        WriteTask(const QString &aPath, const QVector<Event> &aEvents)
+            : iPath(aPath), iEvents(aEvents) {}
+        void run() override
+        {
+            TraceRecorder::write(iPath, iEvents);
+        }
+    private:
+        QString iPath;
+        QVector<Event> iEvents;
+    };
+
+    iWriter.start(new WriteTask(path, events));
+    return true;
+}
+
+bool TraceRecorder::waitForWritten(int aTimeout)
+{
+    return iWriter.waitForDone(aTimeout);
+}
+
+bool TraceRecorder::write(const QString &aPath, const QVector<Event> &aEvents)
+{
+    if (aEvents.count() >= MAX_TRACE_EVENTS) {
+        qCWarning(lcButeoCore) << "Trace buffer was full, later events were dropped";
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    foreach (const Event &event, aEvents) {
+        QJsonObject object;
+        object.insert(QStringLiteral("name"), QLatin1String(event.iName));
+        object.insert(QStringLiteral("cat"), QLatin1String(event.iCategory));
+        object.insert(QStringLiteral("ph"), QString(QLatin1Char(event.iPhase)));
+        object.insert(QStringLiteral("ts"), event.iTimestamp);
+        object.insert(QStringLiteral("pid"), pid);
+        object.insert(QStringLiteral("tid"), event.iThreadId);
+        if (event.iPhase == 'X') {
+            object.insert(QStringLiteral("dur"), event.iDuration);
+        } else if (event.iPhase == 'b' || event.iPhase == 'e') {
+            object.insert(QStringLiteral("id2"),
+                          QJsonObject{{QStringLiteral("local"), event.iProfile}});
+        } else if (event.iPhase == 'i') {
+            object.insert(QStringLiteral("s"), QStringLiteral("t"));
+        }
+        if (!event.iProfile.isEmpty()) {
+            object.insert(QStringLiteral("args"),
+                          QJsonObject{{QStringLiteral("profile"), event.iProfile}});
+        }
+        traceEvents.append(object);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("traceEvents"), traceEvents);
+    root.insert(QStringLiteral("displayTimeUnit"), QStringLiteral("ms"));
+
+    QSaveFile file(aPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcButeoCore) << "Failed to open trace file for writing:" << aPath;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCWarning(lcButeoCore) << "Failed to write trace file:" << aPath;
+        return false;
+    }
+
+    qCInfo(lcButeoCore) << "Trace recording stopped," << aEvents.count() << "events written to" << aPath;
+    return true;
+}
+
+qint64 TraceRecorder::now() const
+{
+    return iClock.nsecsElapsed() / 1000;
+}
+
+void TraceRecorder::complete(const char *aName, const char *aCategory, qint64 aStartUs,
+                             const QString &aProfile)
+{
+    if (isEnabled()) {
+        record(aName, aCategory, 'X', aStartUs, now() - aStartUs, aProfile);
+    }
+}
+
+void TraceRecorder::instant(const char *aName, const char *aCategory, const QString &aProfile)
+{
+    if (isEnabled()) {
+        record(aName, aCategory, 'i', now(), 0, aProfile);
+    }
+}
+
+void TraceRecorder::asyncBegin(const char *aName, const char *aCategory, const QString &aProfile)
+{
+    if (isEnabled()) {
+        record(aName, aCategory, 'b', now(), 0, aProfile);
+    }
+}
+
+void TraceRecorder::asyncEnd(const char *aName, const char *aCategory, const QString &aProfile)
+{
+    if (isEnabled()) {
+        record(aName, aCategory, 'e', now(), 0, aProfile);
+    }
+}
+
+void TraceRecorder::record(const char *aName, const char *aCategory, char aPhase,
+                           qint64 aTimestamp, qint64 aDuration, const QString &aProfile)
+{
+    Event event = { aName, aCategory, aPhase, aTimestamp, aDuration, currentThreadId(), aProfile };
+
+    QMutexLocker locker(&iMutex);
+    // Recording may have been stopped while waiting for the lock.
+    if (iEnabled.load() && iEvents.count() < MAX_TRACE_EVENTS) {
+        iEvents.append(event);
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+namespace Buteo {
+
+/*!
+ * \brief Records a timeline of sync activity in the Chrome trace event
+ *        format.
+ *
+ * The resulting file can be loaded in chrome://tracing or Perfetto.
+ * Recording is off by default; while it is off, every entry point
+ * returns after a single atomic load. Events are kept in memory and
+ * written out on a worker thread when recording is stopped.
+ */
+class TraceRecorder
+{
+public:
+    //! Returns the recorder instance
+    static TraceRecorder *instance();
+
+    //! Returns true if events are being recorded
+    static inline bool isEnabled()
+    {
+        return iEnabled.load() != 0;
+    }
+
+    /*!
+     * \brief Starts recording, dropping any previously recorded events.
+     *
+     * @param aPath File to write the trace to when recording stops
+     * @return False if recording was already on
+     */
+    bool start(const QString &aPath);
+
+    /*!
+     * \brief Stops recording and queues the trace file to be written on a
+     *        worker thread.
+     *
+     * @return False if recording was not on
+     */
+    bool stop();
+
+    /*!
+     * \brief Waits until queued trace files have been written.
+     *
+     * @param aTimeout Timeout in milliseconds, -1 to wait forever
+     * @return False if the timeout expired first
+     */
+    bool waitForWritten(int aTimeout = -1);
+
+    //! Current trace timestamp in microseconds
+    qint64 now() const;
+
+    /*!
+     * \brief Records a span on the current thread.
+     *
+     * @param aName Event name, must be a string literal
+     * @param aCategory Event category, must be a string literal
+     * @param aStartUs Start timestamp from now()
+     * @param aProfile Profile the event relates to, may be empty
+     */
+    void complete(const char *aName, const char *aCategory, qint64 aStartUs,
+                  const QString &aProfile = QString());
+
+    /*!
+     * \brief Records a point in time on the current thread.
+     */
+    void instant(const char *aName, const char *aCategory,
+                 const QString &aProfile = QString());
+
+    /*!
+     * \brief Begins a span which may end on another thread or in another
+     *        event loop iteration. Spans are matched by name and profile.
+     */
+    void asyncBegin(const char *aName, const char *aCategory, const QString &aProfile);
+
+    //! Ends a span started with asyncBegin()
+    void asyncEnd(const char *aName, const char *aCategory, const QString &aProfile);
+
+private:
+    struct Event {
+        const char *iName;
+        const char *iCategory;
+        char iPhase;
+        qint64 iTimestamp;
+        qint64 iDuration;
+        qint64 iThreadId;
+        QString iProfile;
+    };
+
+    TraceRecorder();
+
+    static bool write(const QString &aPath, const QVector<Event> &aEvents);
+
+    void record(const char *aName, const char *aCategory, char aPhase,
+                qint64 aTimestamp, qint64 aDuration, const QString &aProfile);
+
+    static QAtomicInt iEnabled;
+
+    mutable QMutex iMutex;
+    QElapsedTimer iClock;
+    QString iPath;
+    QVector<Event> iEvents;
+    QThreadPool iWriter;
+
+    Q_DISABLE_COPY(TraceRecorder)
+};
+
+/*!
+ * \brief Records the lifetime of the object as a span, if recording is on.
+ */
+class TraceScope
+{
+public:
+    /*!
+     * \brief Constructor.
+     *
+     * @param aName Span name, must be a string literal
+     * @param aCategory Span category, must be a string literal
+     * @param aProfile Profile the span relates to, may be empty
+     */
+    inline TraceScope(const char *aName, const char *aCategory,
+                      const QString &aProfile = QString())
+        : iName(nullptr)
+        , iCategory(aCategory)
+        , iStart(0)
+    {
+        if (TraceRecorder::isEnabled()) {
+            iName = aName;
+            iProfile = aProfile;
+            iStart = TraceRecorder::instance()->now();
+        }
+    }
+
+    inline ~TraceScope()
+    {
+        if (iName && TraceRecorder::isEnabled()) {
+            TraceRecorder::instance()->complete(iName, iCategory, iStart, iProfile);
+        }
+    }
+
+private:
+    const char *iName;
+    const char *iCategory;
+    qint64 iStart;
+    QString iProfile;
+
+    Q_DISABLE_COPY(TraceScope)
+};
+
+}
+
+#endif // TRACERECORDER_H
@@ -20,9 +20,13 @@ DEFINES += DEFAULT_PLUGIN_PATH=\"\\\"$$[QT_INSTALL_LIBS]/buteo-plugins-qt5\\\"\"
 
 # there might be something still here which shouldn't really be publicly offered
 PUBLIC_HEADERS += \
+           common/AsyncLogWriter.h \
            common/Logger.h \
            common/LogMacros.h \
+           common/LogRingBuffer.h \
+           common/Metrics.h \
            common/SyncCommonDefs.h \
+           common/TraceRecorder.h \
            common/TransportTracker.h \
            common/NetworkManager.h \
            clientfw/SyncClientInterface.h \
@@ -34,6 +38,7 @@ PUBLIC_HEADERS += \
            pluginmgr/StorageChangeNotifierPlugin.h \
            pluginmgr/StorageChangeNotifierPluginLoader.h \
            pluginmgr/StorageItem.h \
+           pluginmgr/StorageItemCursor.h \
            pluginmgr/StoragePlugin.h \
            pluginmgr/StoragePluginLoader.h \
            pluginmgr/SyncPluginBase.h \
@@ -57,11 +62,20 @@ PUBLIC_HEADERS += \
 HEADERS += $$PUBLIC_HEADERS \
            clientfw/SyncClientInterfacePrivate.h \
            clientfw/SyncDaemonProxy.h \
+           pluginmgr/OOPPeerServer.h \
+           pluginmgr/OOPPluginCall.h \
+           pluginmgr/OOPProcessRegistry.h \
+           pluginmgr/OOPResourcePolicy.h \
+           pluginmgr/PluginCache.h \
            profile/Profile_p.h \
            profile/SyncSchedule_p.h \
 
 
-SOURCES += common/Logger.cpp \
+SOURCES += common/AsyncLogWriter.cpp \
+           common/Logger.cpp \
+           common/LogRingBuffer.cpp \
+           common/Metrics.cpp \
+           common/TraceRecorder.cpp \
            common/TransportTracker.cpp \
            common/NetworkManager.cpp \
            clientfw/SyncClientInterface.cpp \
@@ -72,6 +86,7 @@ SOURCES += common/Logger.cpp \
            pluginmgr/PluginManager.cpp \
            pluginmgr/ServerPlugin.cpp \
            pluginmgr/StorageItem.cpp \
+           pluginmgr/StorageItemCursor.cpp \
            pluginmgr/StoragePlugin.cpp \
            pluginmgr/SyncPluginBase.cpp \
            pluginmgr/SyncPluginLoader.cpp \
@@ -88,6 +103,11 @@ SOURCES += common/Logger.cpp \
            profile/TargetResults.cpp \
            pluginmgr/OOPClientPlugin.cpp \
            pluginmgr/OOPServerPlugin.cpp \
+           pluginmgr/OOPPeerServer.cpp \
+           pluginmgr/OOPPluginCall.cpp \
+           pluginmgr/OOPProcessRegistry.cpp \
+           pluginmgr/OOPResourcePolicy.cpp \
+           pluginmgr/PluginCache.cpp \
            pluginmgr/ButeoPluginIface.cpp
 
 usb-moded {
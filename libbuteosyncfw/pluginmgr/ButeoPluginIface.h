@@ -21,6 +21,7 @@
 #include <QtDBus/QtDBus>
 
 #include <SyncCommonDefs.h>
+#include <SyncResults.h>
 
 /*
  * Proxy class for interface com.buteo.msyncd.baseplugin
@@ -78,6 +79,22 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QLatin1String("resume"), argumentList);
     }
 
+    inline QDBusPendingReply<bool> setListenSocket(const QDBusUnixFileDescriptor &aSocket)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(aSocket);
+        return asyncCallWithArgumentList(QLatin1String("setListenSocket"), argumentList);
+    }
+
+    inline QDBusPendingReply<bool> setPluginParams(const QString &aPluginName, const QString &aProfileName,
+                                                   const QString &aPluginFilePath)
+    {
+        QList<QVariant> argumentList;
+        argumentList << QVariant::fromValue(aPluginName) << QVariant::fromValue(aProfileName)
+                     << QVariant::fromValue(aPluginFilePath);
+        return asyncCallWithArgumentList(QLatin1String("setPluginParams"), argumentList);
+    }
+
     inline QDBusPendingReply<bool> startListen()
     {
         QList<QVariant> argumentList;
@@ -102,6 +119,12 @@ public Q_SLOTS: // METHODS
         return asyncCallWithArgumentList(QLatin1String("suspend"), argumentList);
     }
 
+    inline QDBusPendingReply<Buteo::SyncResults> syncResults()
+    {
+        QList<QVariant> argumentList;
+        return asyncCallWithArgumentList(QLatin1String("syncResults"), argumentList);
+    }
+
     inline QDBusPendingReply<bool> uninit()
     {
         QList<QVariant> argumentList;
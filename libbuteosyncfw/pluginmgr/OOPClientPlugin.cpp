@@ -20,20 +20,31 @@
 * 02110-1301 USA
 */
 
-#include <QDomDocument>
 #include "OOPClientPlugin.h"
+#include "OOPResourcePolicy.h"
 #include "LogMacros.h"
+#include "OOPPluginCall.h"
 
 #include <QRegularExpression>
+#include <QThread>
 
 using namespace Buteo;
 
+// Deadlines of the calls to the plugin process, in milliseconds
+static const int INIT_TIMEOUT = 60000;
+static const int START_SYNC_TIMEOUT = 30000;
+static const int UNINIT_TIMEOUT = 30000;
+static const int CLEANUP_TIMEOUT = 60000;
+static const int SYNC_RESULTS_TIMEOUT = 10000;
+static const int NOTIFY_TIMEOUT = 5000;
+
 OOPClientPlugin::OOPClientPlugin(const QString &aPluginName,
                                  const SyncProfile &aProfile,
                                  PluginCbInterface *aCbInterface,
                                  QProcess &aProcess)
     : ClientPlugin(aPluginName, aProfile, aCbInterface)
     , iDone(false)
+    , iHaveSyncResults(false)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
@@ -45,10 +56,47 @@ OOPClientPlugin::OOPClientPlugin(const QString &aPluginName,
                               ? QLatin1String(DBUS_SERVICE_NAME_PREFIX) + QStringLiteral("profile-") + profileName
                               : QLatin1String(DBUS_SERVICE_NAME_PREFIX) + profileName;
 
-    // Initialise dbus for client
-    iOopPluginIface = new ButeoPluginIface(servicePath,
+    SyncResults::registerDBusTypes();
+
+    // Initialise dbus for client, a private connection replaces the session
+    // bus later if the runner provides one
+    setupInterface(servicePath, QDBusConnection::sessionBus());
+
+    // Handle the signals from the process
+    connect(&aProcess, SIGNAL(error(QProcess::ProcessError)),
+            this, SLOT(onProcessError(QProcess::ProcessError)));
+
+    connect(&aProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
+            this, SLOT(onProcessFinished(int, QProcess::ExitStatus)));
+}
+
+OOPClientPlugin::~OOPClientPlugin()
+{
+    delete iOopPluginIface;
+    iOopPluginIface = nullptr;
+}
+
+void OOPClientPlugin::setConnection(const QDBusConnection &aConnection)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    // The plugin thread uses the interface without locking, so it can only
+    // be replaced while the plugin still lives on this thread.
+    if (thread() != QThread::currentThread()) {
+        qCWarning(lcButeoCore) << "Plugin already runs on its own thread, keeping its connection";
+        return;
+    }
+
+    // Peer connections have no bus, so there is no service name either
+    delete iOopPluginIface;
+    setupInterface(QString(), aConnection);
+}
+
+void OOPClientPlugin::setupInterface(const QString &aService, const QDBusConnection &aConnection)
+{
+    iOopPluginIface = new ButeoPluginIface(aService,
                                            DBUS_SERVICE_OBJ_PATH,
-                                           QDBusConnection::sessionBus());
+                                           aConnection);
     iOopPluginIface->setTimeout(60000); // one minute.
 
     // Chain the signals received over dbus
@@ -69,40 +117,28 @@ OOPClientPlugin::OOPClientPlugin(const QString &aPluginName,
 
     connect(iOopPluginIface, SIGNAL(syncProgressDetail(const QString &, int)),
             this, SIGNAL(syncProgressDetail(const QString &, int)));
-
-    // Handle the signals from the process
-    connect(&aProcess, SIGNAL(error(QProcess::ProcessError)),
-            this, SLOT(onProcessError(QProcess::ProcessError)));
-
-    connect(&aProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
-            this, SLOT(onProcessFinished(int, QProcess::ExitStatus)));
-}
-
-OOPClientPlugin::~OOPClientPlugin()
-{
-    delete iOopPluginIface;
-    iOopPluginIface = nullptr;
 }
 
 bool OOPClientPlugin::init()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
-    QDBusPendingReply<bool> reply = iOopPluginIface->init();
-    reply.waitForFinished();
 
-    if (!reply.isValid()) {
-        qCWarning(lcButeoCore) << "Invalid reply for init from plugin";
-        return false;
-    }
-
-    return reply.value();
+    // The result is reported through error(). The runner handles calls in
+    // order, so startSync() can be sent right after this; the runner
+    // refuses it if init failed, and only the first error is reported.
+    watchResult(oopPluginCall(iOopPluginIface, QStringLiteral("init"), QList<QVariant>(), INIT_TIMEOUT),
+                QStringLiteral("init"));
+    return true;
 }
 
 bool OOPClientPlugin::uninit()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->uninit();
+    // Waited for, as the runner process may be stopped right after this.
+    // Called from the client thread, so this does not block msyncd.
+    QDBusPendingReply<bool> reply = oopPluginCall(iOopPluginIface, QStringLiteral("uninit"),
+                                                  QList<QVariant>(), UNINIT_TIMEOUT);
     reply.waitForFinished();
     if (!reply.isValid()) {
         qCWarning(lcButeoCore) << "Invalid reply for uninit from plugin";
@@ -116,31 +152,26 @@ bool OOPClientPlugin::startSync()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->startSync();
-    reply.waitForFinished();
-    if (!reply.isValid()) {
-        qCWarning(lcButeoCore) << "Invalid reply for startSync from plugin";
-        return false;
-    }
-
-    return reply.value();
+    watchResult(oopPluginCall(iOopPluginIface, QStringLiteral("startSync"), QList<QVariant>(), START_SYNC_TIMEOUT),
+                QStringLiteral("startSync"));
+    return true;
 }
 
 void OOPClientPlugin::abortSync(Sync::SyncStatus aStatus)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<void> reply = iOopPluginIface->abortSync((uchar) aStatus);
-    reply.waitForFinished();
-    if (!reply.isValid())
-        qCWarning(lcButeoCore) << "Invalid reply for abortSync from plugin";
+    oopPluginNotify(iOopPluginIface, QStringLiteral("abortSync"),
+                    QList<QVariant>() << QVariant::fromValue(static_cast<uchar>(aStatus)), NOTIFY_TIMEOUT);
 }
 
 bool OOPClientPlugin::cleanUp()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->cleanUp();
+    // Profile removal needs the result, so this one is still waited for.
+    QDBusPendingReply<bool> reply = oopPluginCall(iOopPluginIface, QStringLiteral("cleanUp"),
+                                                  QList<QVariant>(), CLEANUP_TIMEOUT);
     reply.waitForFinished();
     if (!reply.isValid()) {
         qCWarning(lcButeoCore) << "Invalid reply for cleanUp from plugin";
@@ -154,39 +185,62 @@ SyncResults OOPClientPlugin::getSyncResults() const
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<QString> reply = iOopPluginIface->getSyncResults();
+    // Fetched by finish() before the session is reported finished, so
+    // msyncd does not call the plugin process from its main thread.
+    QMutexLocker locker(&iSyncResultsMutex);
+    if (iHaveSyncResults) {
+        return iSyncResults;
+    }
+
+    // The typed variant saves building and parsing an XML document for
+    // results with many item details
+    QDBusPendingReply<SyncResults> reply = oopPluginCall(iOopPluginIface, QStringLiteral("syncResults"),
+                                                         QList<QVariant>(), SYNC_RESULTS_TIMEOUT);
     reply.waitForFinished();
     if (!reply.isValid()) {
-        qCWarning(lcButeoCore) << "Invalid reply for getSyncResults from plugin";
+        qCWarning(lcButeoCore) << "Invalid reply for syncResults from plugin";
         return SyncResults(QDateTime::currentDateTime(),
                            SyncResults::SYNC_RESULT_INVALID, SyncResults::PLUGIN_ERROR);
     }
 
-    QString resultAsXml = reply.value();
-    QDomDocument doc;
-    if (doc.setContent(resultAsXml, true)) {
-        SyncResults syncResult(doc.documentElement());
-        return syncResult;
-    } else {
-        qCCritical(lcButeoCore) << "Invalid sync results returned from plugin";
-        return SyncResults(QDateTime::currentDateTime(),
-                           SyncResults::SYNC_RESULT_INVALID, SyncResults::NO_ERROR);
-    }
+    return reply.value();
 }
 
 void OOPClientPlugin::connectivityStateChanged(Sync::ConnectivityType aType, bool aState)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<void> reply = iOopPluginIface->connectivityStateChanged(aType, aState);
-    reply.waitForFinished();
-    if (!reply.isValid())
-        qCWarning(lcButeoCore) << "Invalid reply for connectivityStateChanged from plugin";
+    oopPluginNotify(iOopPluginIface, QStringLiteral("connectivityStateChanged"),
+                    QList<QVariant>() << QVariant::fromValue(static_cast<int>(aType)) << QVariant::fromValue(aState),
+                    NOTIFY_TIMEOUT);
+}
+
+void OOPClientPlugin::watchResult(const QDBusPendingCall &aCall, const QString &aMethod)
+{
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(aCall, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, aMethod](QDBusPendingCallWatcher *aWatcher) {
+        QDBusPendingReply<bool> reply = *aWatcher;
+        aWatcher->deleteLater();
+        if (!reply.isValid()) {
+            qCWarning(lcButeoCore) << "Invalid reply for" << aMethod << "from plugin:" << reply.error().message();
+            onError(iProfile.name(), QStringLiteral("Plugin did not respond to ") + aMethod,
+                    SyncResults::PLUGIN_TIMEOUT);
+        } else if (!reply.value()) {
+            onError(iProfile.name(), QStringLiteral("Plugin failed to ") + aMethod, SyncResults::PLUGIN_ERROR);
+        }
+    });
 }
 
 void OOPClientPlugin::onProcessError(QProcess::ProcessError error)
 {
-    if (!iDone) {
+    // Emitted before finished(), so a crash is classified here
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    if (!iDone && error == QProcess::Crashed && process
+            && OOPResourcePolicy::limitExceeded(*process)) {
+        onError(iProfile.name(),
+                "Plugin process exceeded its resource limits",
+                SyncResults::PLUGIN_RESOURCE_LIMIT);
+    } else if (!iDone) {
         onError(iProfile.name(),
                 "Plugin process error: " + QString::number(error),
                 SyncResults::PLUGIN_ERROR);
@@ -213,7 +267,7 @@ void OOPClientPlugin::onError(QString aProfileName, QString aMessage, int aError
 {
     if (!iDone) {
         iDone = true;
-        emit error(aProfileName, aMessage, static_cast<SyncResults::MinorCode>(aErrorCode));
+        finish(false, aProfileName, aMessage, aErrorCode);
     }
 }
 
@@ -221,6 +275,36 @@ void OOPClientPlugin::onSuccess(QString aProfileName, QString aMessage)
 {
     if (!iDone) {
         iDone = true;
-        emit success(aProfileName, aMessage);
+        finish(true, aProfileName, aMessage, SyncResults::NO_ERROR);
     }
 }
+
+void OOPClientPlugin::finish(bool aSuccess, const QString &aProfileName, const QString &aMessage, int aErrorCode)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(
+        oopPluginCall(iOopPluginIface, QStringLiteral("syncResults"), QList<QVariant>(), SYNC_RESULTS_TIMEOUT), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, aSuccess, aProfileName, aMessage, aErrorCode](QDBusPendingCallWatcher *aWatcher) {
+        QDBusPendingReply<SyncResults> reply = *aWatcher;
+        aWatcher->deleteLater();
+        {
+            QMutexLocker locker(&iSyncResultsMutex);
+            if (reply.isValid()) {
+                iSyncResults = reply.value();
+            } else {
+                qCWarning(lcButeoCore) << "Invalid reply for syncResults from plugin:" << reply.error().message();
+                iSyncResults = SyncResults(QDateTime::currentDateTime(),
+                                           SyncResults::SYNC_RESULT_INVALID, SyncResults::PLUGIN_ERROR);
+            }
+            iHaveSyncResults = true;
+        }
+
+        if (aSuccess) {
+            emit success(aProfileName, aMessage);
+        } else {
+            emit error(aProfileName, aMessage, static_cast<SyncResults::MinorCode>(aErrorCode));
+        }
+    });
+}
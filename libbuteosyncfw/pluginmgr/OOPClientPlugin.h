@@ -23,6 +23,9 @@
 #define OOPCLIENTPLUGIN_H
 
 #include <ClientPlugin.h>
+#include <QDBusConnection>
+#include <QDBusPendingCall>
+#include <QMutex>
 #include <QProcess>
 
 namespace Buteo {
@@ -46,6 +49,17 @@ public:
     virtual Buteo::SyncResults getSyncResults() const;
     virtual bool cleanUp();
 
+    /*! \brief Talks to the plugin process over aConnection
+     *
+     * Used to move from the session bus to a private connection to the
+     * plugin process, once the process has attached to it. The D-Bus
+     * interface is replaced, so this must happen before the plugin is
+     * moved to its own thread; later calls are ignored.
+     *
+     * @param aConnection Peer connection to the plugin process
+     */
+    void setConnection(const QDBusConnection &aConnection);
+
 public slots:
     virtual void connectivityStateChanged(Sync::ConnectivityType aType,
                                           bool aState);
@@ -56,7 +70,20 @@ public slots:
     void onSuccess(QString aProfileName, QString aMessage);
 
 private:
+    void setupInterface(const QString &aService, const QDBusConnection &aConnection);
+
+    // Reports a failed or negative reply to aCall through error()
+    void watchResult(const QDBusPendingCall &aCall, const QString &aMethod);
+
+    // Fetches the final results without blocking, then emits success()
+    // or error()
+    void finish(bool aSuccess, const QString &aProfileName, const QString &aMessage, int aErrorCode);
+
     bool iDone;
+
+    mutable QMutex iSyncResultsMutex;
+    bool iHaveSyncResults;
+    Buteo::SyncResults iSyncResults;
 };
 
 }
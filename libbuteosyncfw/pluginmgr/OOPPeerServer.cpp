@@ -0,0 +1,124 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "OOPPeerServer.h"
+#include "LogMacros.h"
+
+#include <QDBusServer>
+#include <QDir>
+
+using namespace Buteo;
+
+static const QString PEER_OBJECT_PATH = QStringLiteral("/msyncd");
+static const QString DBUS_LOCAL_PATH = QStringLiteral("/org/freedesktop/DBus/Local");
+static const QString DBUS_LOCAL_INTERFACE = QStringLiteral("org.freedesktop.DBus.Local");
+
+OOPPeerServer::OOPPeerServer(const QString &aSocketDir, QObject *aParent)
+    : QObject(aParent)
+    , iServer(nullptr)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    // The directory is private to the user, and the EXTERNAL
+    // authentication only lets the same user in.
+    QDir().mkpath(aSocketDir);
+    iServer = new QDBusServer(QStringLiteral("unix:dir=") + aSocketDir, this);
+
+    if (iServer->isConnected()) {
+        connect(iServer, &QDBusServer::newConnection, this, &OOPPeerServer::onNewConnection);
+        qCDebug(lcButeoCore) << "Listening for plugin runners at" << iServer->address();
+    } else {
+        qCWarning(lcButeoCore) << "Unable to listen for plugin runners, using the session bus:"
+                               << iServer->lastError().message();
+    }
+}
+
+OOPPeerServer::~OOPPeerServer()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    for (const QString &name : iPeers) {
+        QDBusConnection::disconnectFromPeer(name);
+    }
+}
+
+bool OOPPeerServer::isConnected() const
+{
+    return iServer->isConnected();
+}
+
+QString OOPPeerServer::address() const
+{
+    return iServer->address();
+}
+
+QDBusConnection OOPPeerServer::peerConnection(const QString &aProfileName) const
+{
+    // A default constructed name refers to no connection
+    return QDBusConnection(iPeers.value(aProfileName));
+}
+
+bool OOPPeerServer::attach(const QString &aProfileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    const QString name = connection().name();
+    const QString previous = iPeers.value(aProfileName);
+    if (!previous.isEmpty() && previous != name) {
+        QDBusConnection::disconnectFromPeer(previous);
+    }
+
+    qCDebug(lcButeoCore) << "Plugin runner for" << aProfileName << "attached on" << name;
+    iPeers.insert(aProfileName, name);
+    return true;
+}
+
+void OOPPeerServer::onNewConnection(const QDBusConnection &aConnection)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QDBusConnection connection(aConnection);
+    if (!connection.registerObject(PEER_OBJECT_PATH, this, QDBusConnection::ExportScriptableSlots)) {
+        qCWarning(lcButeoCore) << "Unable to serve plugin runner connection" << connection.name();
+        QDBusConnection::disconnectFromPeer(connection.name());
+        return;
+    }
+
+    // libdbus reports the end of a connection with a local signal
+    connection.connect(QString(), DBUS_LOCAL_PATH, DBUS_LOCAL_INTERFACE, QStringLiteral("Disconnected"),
+                       this, SLOT(onPeerDisconnected()));
+}
+
+void OOPPeerServer::onPeerDisconnected()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    const QString name = connection().name();
+    for (auto it = iPeers.begin(); it != iPeers.end();) {
+        if (it.value() == name) {
+            qCDebug(lcButeoCore) << "Plugin runner for" << it.key() << "disconnected";
+            it = iPeers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    QDBusConnection::disconnectFromPeer(name);
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef OOPPEERSERVER_H
+#define OOPPEERSERVER_H
+
+#include <QDBusConnection>
+#include <QDBusContext>
+#include <QHash>
+#include <QObject>
+
+class QDBusServer;
+
+namespace Buteo {
+
+/*!
+ * \brief Private D-Bus server for out-of-process plugin runners.
+ *
+ * Runners connect to address() directly instead of going through the
+ * session bus daemon. Once connected, a runner calls attach() with its
+ * profile name, and then serves the usual com.buteo.msyncd.baseplugin
+ * interface at "/" on the peer connection.
+ */
+class OOPPeerServer : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.buteo.msyncd.pluginpeer")
+
+public:
+    /*!
+     * \brief Constructor, starts listening.
+     *
+     * @param aSocketDir Directory for the listening socket
+     * @param aParent Parent object
+     */
+    explicit OOPPeerServer(const QString &aSocketDir, QObject *aParent = nullptr);
+
+    virtual ~OOPPeerServer();
+
+    //! Returns true if the server is listening
+    bool isConnected() const;
+
+    //! Address runners should connect to
+    QString address() const;
+
+    /*!
+     * \brief Returns the connection of the runner for aProfileName.
+     *
+     * @return Connected peer connection, or a disconnected one if the
+     *  runner has not attached
+     */
+    QDBusConnection peerConnection(const QString &aProfileName) const;
+
+public slots:
+    //! Called by a runner on its peer connection
+    Q_SCRIPTABLE bool attach(const QString &aProfileName);
+
+private slots:
+    void onNewConnection(const QDBusConnection &aConnection);
+
+    //! Called on a peer connection when the runner goes away
+    void onPeerDisconnected();
+
+private:
+    QDBusServer *iServer;
+
+    // profile name -> connection name
+    QHash<QString, QString> iPeers;
+
+#ifdef SYNCFW_UNIT_TESTS
+    friend class OOPPeerServerTest;
+#endif
+};
+
+}
+
+#endif // OOPPEERSERVER_H
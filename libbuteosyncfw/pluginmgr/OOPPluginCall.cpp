@@ -0,0 +1,52 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "OOPPluginCall.h"
+#include "ButeoPluginIface.h"
+#include "LogMacros.h"
+
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+
+using namespace Buteo;
+
+QDBusPendingCall Buteo::oopPluginCall(ButeoPluginIface *aIface, const QString &aMethod,
+                                      const QList<QVariant> &aArguments, int aTimeout)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(aIface->service(), aIface->path(),
+                                                          aIface->interface(), aMethod);
+    message.setArguments(aArguments);
+    return aIface->connection().asyncCall(message, aTimeout);
+}
+
+void Buteo::oopPluginNotify(ButeoPluginIface *aIface, const QString &aMethod,
+                            const QList<QVariant> &aArguments, int aTimeout)
+{
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(
+                oopPluginCall(aIface, aMethod, aArguments, aTimeout));
+    QObject::connect(watcher, &QDBusPendingCallWatcher::finished, [aMethod](QDBusPendingCallWatcher *aWatcher) {
+        if (aWatcher->isError()) {
+            qCWarning(lcButeoCore) << "Invalid reply for" << aMethod << "from plugin:"
+                                   << aWatcher->error().message();
+        }
+        aWatcher->deleteLater();
+    });
+}
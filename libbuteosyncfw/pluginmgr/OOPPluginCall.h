@@ -0,0 +1,60 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef OOPPLUGINCALL_H
+#define OOPPLUGINCALL_H
+
+#include <QDBusPendingCall>
+#include <QList>
+#include <QVariant>
+
+class ButeoPluginIface;
+
+namespace Buteo {
+
+/*!
+ * \brief Calls aMethod of an out-of-process plugin without blocking.
+ *
+ * Unlike the generated proxy, which uses one timeout for every method,
+ * each call gets its own deadline.
+ *
+ * @param aIface Plugin interface
+ * @param aMethod Method name
+ * @param aArguments Method arguments
+ * @param aTimeout Deadline in milliseconds
+ * @return Pending call, which fails if the deadline passes
+ */
+QDBusPendingCall oopPluginCall(ButeoPluginIface *aIface, const QString &aMethod,
+                               const QList<QVariant> &aArguments, int aTimeout);
+
+/*!
+ * \brief Calls aMethod of an out-of-process plugin and does not wait
+ *        for the result.
+ *
+ * A failed call is only logged. Can be used from any thread with an
+ * event loop.
+ */
+void oopPluginNotify(ButeoPluginIface *aIface, const QString &aMethod,
+                     const QList<QVariant> &aArguments, int aTimeout);
+
+}
+
+#endif // OOPPLUGINCALL_H
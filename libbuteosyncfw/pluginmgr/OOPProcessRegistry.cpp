@@ -0,0 +1,239 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "OOPProcessRegistry.h"
+#include "LogMacros.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVector>
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace Buteo;
+
+// Index of the starttime field of /proc/<pid>/stat, counted from the
+// first field after the command name.
+static const int STAT_STARTTIME_INDEX = 19;
+
+// How often runners without a pidfd are checked while waiting for them
+static const int STALE_POLL_INTERVAL = 50;
+
+OOPProcessRegistry::OOPProcessRegistry(const QString &aPath)
+    : iPath(aPath)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QFile file(iPath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    while (!file.atEnd()) {
+        const QList<QByteArray> fields = file.readLine().simplified().split(' ');
+        bool pidOk = false;
+        bool startTimeOk = false;
+        const qint64 pid = fields.value(0).toLongLong(&pidOk);
+        const qint64 startTime = fields.value(1).toLongLong(&startTimeOk);
+        if (pidOk && startTimeOk && pid > 0) {
+            iProcesses.insert(pid, startTime);
+        }
+    }
+}
+
+void OOPProcessRegistry::add(qint64 aPid)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    const qint64 startTime = processStartTime(aPid);
+    if (startTime < 0) {
+        // Already gone
+        return;
+    }
+
+    iProcesses.insert(aPid, startTime);
+    save();
+}
+
+void OOPProcessRegistry::remove(qint64 aPid)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iProcesses.remove(aPid)) {
+        save();
+    }
+}
+
+bool OOPProcessRegistry::contains(qint64 aPid) const
+{
+    return iProcesses.contains(aPid);
+}
+
+int OOPProcessRegistry::reapStale(int aTimeout)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QVector<StaleRunner> runners;
+    for (auto it = iProcesses.constBegin(); it != iProcesses.constEnd(); ++it) {
+        StaleRunner runner = { it.key(), it.value(), -1 };
+#ifdef SYS_pidfd_open
+        // A pidfd keeps referring to the same process, so once the start
+        // time has been checked the signals cannot hit a recycled pid.
+        runner.iPidFd = syscall(SYS_pidfd_open, static_cast<pid_t>(runner.iPid), 0);
+        if (runner.iPidFd < 0 && errno == ESRCH) {
+            continue;
+        }
+        // Otherwise a kernel without pidfd support, fall back to kill()
+#endif
+        if (processStartTime(runner.iPid) != runner.iStartTime) {
+            if (runner.iPidFd >= 0) {
+                close(runner.iPidFd);
+            }
+            continue;
+        }
+
+        if (sendSignal(runner, SIGTERM)) {
+            qCInfo(lcButeoCore) << "Terminated stale plugin runner" << runner.iPid;
+            runners.append(runner);
+        } else {
+            qCWarning(lcButeoCore) << "Failed to terminate plugin runner" << runner.iPid << strerror(errno);
+            if (runner.iPidFd >= 0) {
+                close(runner.iPidFd);
+            }
+        }
+    }
+    const int count = runners.count();
+
+    // Wait for the runners to exit. A pidfd becomes readable once its
+    // process has exited, the others are checked at an interval.
+    QElapsedTimer timer;
+    timer.start();
+    forever {
+        for (int i = runners.count() - 1; i >= 0; --i) {
+            if (!isAlive(runners.at(i))) {
+                if (runners.at(i).iPidFd >= 0) {
+                    close(runners.at(i).iPidFd);
+                }
+                runners.removeAt(i);
+            }
+        }
+
+        const qint64 remaining = aTimeout - timer.elapsed();
+        if (runners.isEmpty() || remaining <= 0) {
+            break;
+        }
+
+        QVector<struct pollfd> fds;
+        for (const StaleRunner &runner : runners) {
+            if (runner.iPidFd >= 0) {
+                struct pollfd fd = { runner.iPidFd, POLLIN, 0 };
+                fds.append(fd);
+            }
+        }
+        poll(fds.data(), fds.count(), int(qMin<qint64>(remaining, STALE_POLL_INTERVAL)));
+    }
+
+    for (const StaleRunner &runner : runners) {
+        qCWarning(lcButeoCore) << "Stale plugin runner" << runner.iPid << "did not exit, killing it";
+        sendSignal(runner, SIGKILL);
+        if (runner.iPidFd >= 0) {
+            close(runner.iPidFd);
+        }
+    }
+
+    if (!iProcesses.isEmpty()) {
+        iProcesses.clear();
+        save();
+    }
+    return count;
+}
+
+qint64 OOPProcessRegistry::processStartTime(qint64 aPid)
+{
+    QFile stat(QStringLiteral("/proc/%1/stat").arg(aPid));
+    if (!stat.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    // The command name may contain spaces and parentheses, so the fields
+    // are counted from its closing parenthesis.
+    const QByteArray content = stat.readAll();
+    const int nameEnd = content.lastIndexOf(')');
+    if (nameEnd < 0) {
+        return -1;
+    }
+
+    const QList<QByteArray> fields = content.mid(nameEnd + 1).simplified().split(' ');
+    bool ok = false;
+    const qint64 startTime = fields.value(STAT_STARTTIME_INDEX).toLongLong(&ok);
+    return ok ? startTime : -1;
+}
+
+void OOPProcessRegistry::save() const
+{
+    QDir().mkpath(QFileInfo(iPath).absolutePath());
+
+    QSaveFile file(iPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(lcButeoCore) << "Failed to open plugin runner registry" << iPath;
+        return;
+    }
+
+    for (auto it = iProcesses.constBegin(); it != iProcesses.constEnd(); ++it) {
+        file.write(QByteArray::number(it.key()) + ' ' + QByteArray::number(it.value()) + '\n');
+    }
+
+    if (!file.commit()) {
+        qCWarning(lcButeoCore) << "Failed to write plugin runner registry" << iPath;
+    }
+}
+
+bool OOPProcessRegistry::sendSignal(const StaleRunner &aRunner, int aSignal)
+{
+#ifdef SYS_pidfd_send_signal
+    if (aRunner.iPidFd >= 0) {
+        return syscall(SYS_pidfd_send_signal, aRunner.iPidFd, aSignal, nullptr, 0) == 0;
+    }
+#endif
+
+    // Without a pidfd the pid may have been recycled in the meantime
+    if (processStartTime(aRunner.iPid) != aRunner.iStartTime) {
+        return false;
+    }
+    return kill(static_cast<pid_t>(aRunner.iPid), aSignal) == 0;
+}
+
+bool OOPProcessRegistry::isAlive(const StaleRunner &aRunner)
+{
+    if (aRunner.iPidFd >= 0) {
+        struct pollfd fd = { aRunner.iPidFd, POLLIN, 0 };
+        return poll(&fd, 1, 0) == 0;
+    }
+    return processStartTime(aRunner.iPid) == aRunner.iStartTime;
+}
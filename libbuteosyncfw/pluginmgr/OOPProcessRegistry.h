@@ -0,0 +1,100 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef OOPPROCESSREGISTRY_H
+#define OOPPROCESSREGISTRY_H
+
+#include <QMap>
+#include <QString>
+
+namespace Buteo {
+
+/*!
+ * \brief Persistent record of the out-of-process plugin runners started
+ *        by msyncd.
+ *
+ * Every runner is stored with its pid and the start time the kernel
+ * reports for it, so that a recycled pid is never mistaken for a runner.
+ * Runners left behind by a previous msyncd instance are found from the
+ * file, without scanning the process table.
+ */
+class OOPProcessRegistry
+{
+public:
+    /*!
+     * \brief Constructor, loads the registry from aPath.
+     *
+     * @param aPath Registry file. It should live in a directory which is
+     *  cleared on reboot, as pids are meaningless after one.
+     */
+    explicit OOPProcessRegistry(const QString &aPath);
+
+    //! Records a started runner
+    void add(qint64 aPid);
+
+    //! Forgets a runner which has exited
+    void remove(qint64 aPid);
+
+    //! Returns true if aPid is recorded
+    bool contains(qint64 aPid) const;
+
+    /*!
+     * \brief Terminates all recorded runners which are still alive.
+     *
+     * Sends SIGTERM, waits for the runners to exit and kills the ones
+     * which are still there once aTimeout has passed. Meant to be called
+     * at startup, before any runner of this instance has been added. The
+     * registry is empty afterwards.
+     *
+     * @param aTimeout Time in milliseconds the runners get to exit
+     * @return Number of runners that were terminated
+     */
+    int reapStale(int aTimeout = 3000);
+
+    /*!
+     * \brief Start time of a process in clock ticks since boot.
+     *
+     * @return Start time, or -1 if the process does not exist
+     */
+    static qint64 processStartTime(qint64 aPid);
+
+private:
+    struct StaleRunner {
+        qint64 iPid;
+        qint64 iStartTime;
+        int iPidFd;
+    };
+
+    void save() const;
+
+    static bool sendSignal(const StaleRunner &aRunner, int aSignal);
+
+    static bool isAlive(const StaleRunner &aRunner);
+
+    QString iPath;
+
+    // pid -> start time
+    QMap<qint64, qint64> iProcesses;
+};
+
+}
+
+#endif // OOPPROCESSREGISTRY_H
@@ -0,0 +1,222 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+
+#include "OOPResourcePolicy.h"
+#include "Profile.h"
+#include "ProfileEngineDefs.h"
+#include "LogMacros.h"
+
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace Buteo;
+
+const char *const OOPResourcePolicy::CGROUP_PROPERTY = "buteoCgroup";
+const char *const OOPResourcePolicy::CPU_TIME_LIMIT_PROPERTY = "buteoCpuTimeLimit";
+
+// From linux/ioprio.h, which is not exported to userspace everywhere
+static const int IOPRIO_WHO_PROCESS = 1;
+static const int IOPRIO_CLASS_BE = 2;
+static const int IOPRIO_CLASS_SHIFT = 13;
+
+// Time between SIGXCPU and SIGKILL once the CPU time limit is reached
+static const int CPU_TIME_GRACE = 2;
+
+// Period of the cgroup cpu.max quota in microseconds
+static const int CPU_PERIOD = 100000;
+
+static bool writeGroupFile(const QString &aGroup, const QString &aName, const QByteArray &aValue)
+{
+    QFile file(aGroup + QLatin1Char('/') + aName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(aValue) != aValue.size()) {
+        qCWarning(lcButeoCore) << "Failed to write" << aValue << "to" << file.fileName() << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+OOPResourcePolicy::OOPResourcePolicy()
+    : iNice(0)
+    , iIoPriority(-1)
+    , iMemoryLimit(0)
+    , iCpuTimeLimit(0)
+    , iCpuQuota(0)
+{
+}
+
+OOPResourcePolicy OOPResourcePolicy::fromProfile(const Profile &aProfile, const OOPResourcePolicy &aDefaults)
+{
+    OOPResourcePolicy policy = aDefaults;
+    bool ok = false;
+
+    int nice = aProfile.key(KEY_PLUGIN_NICE).toInt(&ok);
+    if (ok) {
+        policy.iNice = qBound(-20, nice, 19);
+    }
+
+    int ioPriority = aProfile.key(KEY_PLUGIN_IO_PRIORITY).toInt(&ok);
+    if (ok) {
+        policy.iIoPriority = qBound(-1, ioPriority, 7);
+    }
+
+    qint64 memoryLimit = aProfile.key(KEY_PLUGIN_MEMORY_LIMIT).toLongLong(&ok);
+    if (ok) {
+        policy.iMemoryLimit = qMax(Q_INT64_C(0), memoryLimit) * 1024 * 1024;
+    }
+
+    int cpuTimeLimit = aProfile.key(KEY_PLUGIN_CPU_TIME_LIMIT).toInt(&ok);
+    if (ok) {
+        policy.iCpuTimeLimit = qMax(0, cpuTimeLimit);
+    }
+
+    int cpuQuota = aProfile.key(KEY_PLUGIN_CPU_QUOTA).toInt(&ok);
+    if (ok) {
+        policy.iCpuQuota = qMax(0, cpuQuota);
+    }
+
+    return policy;
+}
+
+bool OOPResourcePolicy::isEmpty() const
+{
+    return iNice == 0 && iIoPriority < 0 && iMemoryLimit == 0
+            && iCpuTimeLimit == 0 && iCpuQuota == 0;
+}
+
+QString OOPResourcePolicy::apply(qint64 aPid, const QString &aCgroupParent) const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (isEmpty() || aPid <= 0) {
+        return QString();
+    }
+
+    const pid_t pid = static_cast<pid_t>(aPid);
+
+    // Priorities are per thread on Linux, and the runner may already have
+    // started some, for example the D-Bus thread of a pooled runner.
+    const QStringList tasks = QDir(QStringLiteral("/proc/%1/task").arg(aPid))
+            .entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &task : tasks) {
+        const int tid = task.toInt();
+        if (iNice != 0 && setpriority(PRIO_PROCESS, tid, iNice) != 0) {
+            qCWarning(lcButeoCore) << "Failed to set nice value of plugin runner" << aPid << strerror(errno);
+        }
+        if (iIoPriority >= 0
+                && syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid,
+                           (IOPRIO_CLASS_BE << IOPRIO_CLASS_SHIFT) | iIoPriority) != 0) {
+            qCWarning(lcButeoCore) << "Failed to set I/O priority of plugin runner" << aPid << strerror(errno);
+        }
+    }
+
+    if (iMemoryLimit > 0) {
+        struct rlimit limit;
+        limit.rlim_cur = limit.rlim_max = static_cast<rlim_t>(iMemoryLimit);
+        if (prlimit(pid, RLIMIT_AS, &limit, nullptr) != 0) {
+            qCWarning(lcButeoCore) << "Failed to limit address space of plugin runner" << aPid << strerror(errno);
+        }
+    }
+
+    if (iCpuTimeLimit > 0) {
+        // SIGXCPU first, so that limitExceeded() can tell what happened
+        struct rlimit limit;
+        limit.rlim_cur = static_cast<rlim_t>(iCpuTimeLimit);
+        limit.rlim_max = static_cast<rlim_t>(iCpuTimeLimit + CPU_TIME_GRACE);
+        if (prlimit(pid, RLIMIT_CPU, &limit, nullptr) != 0) {
+            qCWarning(lcButeoCore) << "Failed to limit CPU time of plugin runner" << aPid << strerror(errno);
+        }
+    }
+
+    if (aCgroupParent.isEmpty()) {
+        return QString();
+    }
+
+    const QString group = aCgroupParent + QStringLiteral("/runner-%1").arg(aPid);
+    if (!QDir().mkpath(group)) {
+        qCWarning(lcButeoCore) << "Failed to create cgroup" << group;
+        return QString();
+    }
+
+    // RLIMIT_RSS is not enforced by Linux, memory.max is what caps the
+    // resident set.
+    if (iMemoryLimit > 0) {
+        writeGroupFile(group, QStringLiteral("memory.max"), QByteArray::number(iMemoryLimit));
+    }
+    if (iCpuQuota > 0) {
+        writeGroupFile(group, QStringLiteral("cpu.max"),
+                       QByteArray::number(qint64(CPU_PERIOD) * iCpuQuota / 100) + ' '
+                       + QByteArray::number(CPU_PERIOD));
+    }
+
+    if (!writeGroupFile(group, QStringLiteral("cgroup.procs"), QByteArray::number(aPid))) {
+        removeGroup(group);
+        return QString();
+    }
+
+    return group;
+}
+
+void OOPResourcePolicy::removeGroup(const QString &aPath)
+{
+    if (!aPath.isEmpty() && !QDir().rmdir(aPath)) {
+        qCWarning(lcButeoCore) << "Failed to remove cgroup" << aPath;
+    }
+}
+
+bool OOPResourcePolicy::limitExceeded(const QProcess &aProcess)
+{
+    if (aProcess.exitStatus() != QProcess::CrashExit) {
+        return false;
+    }
+
+    // QProcess reports the terminating signal as the exit code of a crash
+    if (aProcess.exitCode() == SIGXCPU) {
+        return true;
+    }
+
+    const QString group = aProcess.property(CGROUP_PROPERTY).toString();
+    if (group.isEmpty()) {
+        return false;
+    }
+
+    QFile events(group + QStringLiteral("/memory.events"));
+    if (!events.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // cgroup files report no size, so read everything at once
+    const QList<QByteArray> lines = events.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("oom_kill ")) {
+            return line.mid(9).trimmed().toLongLong() > 0;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+
+#ifndef OOPRESOURCEPOLICY_H
+#define OOPRESOURCEPOLICY_H
+
+#include <QString>
+
+class QProcess;
+
+namespace Buteo {
+
+class Profile;
+
+/*!
+ * \brief Resource limits for an out-of-process plugin runner.
+ *
+ * The limits are applied by msyncd to the running process, so they work
+ * the same for freshly spawned runners and for runners taken from the
+ * pool. Unset limits are left as inherited from msyncd.
+ *
+ * The CPU time limit counts the whole life of the process, so a runner
+ * with one is not kept alive for another session.
+ */
+class OOPResourcePolicy
+{
+public:
+    OOPResourcePolicy();
+
+    /*!
+     * \brief Reads the limits from the plugin_* keys of aProfile.
+     *
+     * @param aProfile Profile of the plugin
+     * @param aDefaults Limits used for keys the profile does not set
+     */
+    static OOPResourcePolicy fromProfile(const Profile &aProfile, const OOPResourcePolicy &aDefaults);
+
+    //! Returns true if no limit is set
+    bool isEmpty() const;
+
+    /*!
+     * \brief Applies the limits to a running process.
+     *
+     * If aCgroupParent is set, the process is moved to a new child group
+     * of it, which also caps its resident memory and CPU share. The group
+     * must be removed with removeGroup() once the process has exited.
+     *
+     * @param aPid Process to limit
+     * @param aCgroupParent Delegated cgroup v2 directory, may be empty
+     * @return Path of the created group, empty if none was created
+     */
+    QString apply(qint64 aPid, const QString &aCgroupParent) const;
+
+    //! Removes a group created by apply()
+    static void removeGroup(const QString &aPath);
+
+    /*!
+     * \brief Checks if a runner was killed for exceeding its limits.
+     *
+     * Meant to be called once aProcess has crashed, before the group of
+     * the process is removed.
+     */
+    static bool limitExceeded(const QProcess &aProcess);
+
+    //! Dynamic property of the runner QProcess holding its group path
+    static const char *const CGROUP_PROPERTY;
+
+    //! Dynamic property of the runner QProcess set if its CPU time is limited
+    static const char *const CPU_TIME_LIMIT_PROPERTY;
+
+    // Nice value, 0 leaves the priority unchanged
+    int iNice;
+    // Best-effort I/O priority level 0-7, -1 leaves it unchanged
+    int iIoPriority;
+    // Address space limit in bytes, also the cgroup memory.max; 0 for none
+    qint64 iMemoryLimit;
+    // CPU time limit in seconds for the lifetime of the process, 0 for none
+    int iCpuTimeLimit;
+    // Share of one CPU in percent, cgroup only; 0 for none
+    int iCpuQuota;
+};
+
+}
+
+#endif // OOPRESOURCEPOLICY_H
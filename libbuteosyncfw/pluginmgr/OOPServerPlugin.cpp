@@ -21,12 +21,24 @@
 */
 
 #include "OOPServerPlugin.h"
+#include "OOPResourcePolicy.h"
 #include "LogMacros.h"
+#include "OOPPluginCall.h"
+#include "ProfileEngineDefs.h"
 
+#include <QDBusUnixFileDescriptor>
 #include <QRegularExpression>
+#include <QThread>
 
 using namespace Buteo;
 
+// Deadlines of the calls to the plugin process, in milliseconds
+static const int INIT_TIMEOUT = 60000;
+static const int START_LISTEN_TIMEOUT = 30000;
+static const int UNINIT_TIMEOUT = 30000;
+static const int CLEANUP_TIMEOUT = 60000;
+static const int NOTIFY_TIMEOUT = 5000;
+
 OOPServerPlugin::OOPServerPlugin(const QString &aPluginName,
                                  const Profile &aProfile,
                                  PluginCbInterface *aCbInterface,
@@ -43,10 +55,46 @@ OOPServerPlugin::OOPServerPlugin(const QString &aPluginName,
                               ? QLatin1String(DBUS_SERVICE_NAME_PREFIX) + QStringLiteral("profile-") + profileName
                               : QLatin1String(DBUS_SERVICE_NAME_PREFIX) + profileName;
 
-    // Initialise dbus for server
-    iOopPluginIface = new ButeoPluginIface(servicePath,
+    // Initialise dbus for server, a private connection replaces the session
+    // bus later if the runner provides one
+    setupInterface(servicePath, QDBusConnection::sessionBus());
+
+    // Handle the signals from the process
+    connect(&aProcess, SIGNAL(error(QProcess::ProcessError)),
+            this, SLOT(onProcessError(QProcess::ProcessError)));
+
+    connect(&aProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
+            this, SLOT(onProcessFinished(int, QProcess::ExitStatus)));
+}
+
+OOPServerPlugin::~OOPServerPlugin()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+    delete iOopPluginIface;
+    iOopPluginIface = 0;
+}
+
+void OOPServerPlugin::setConnection(const QDBusConnection &aConnection)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    // The plugin thread uses the interface without locking, so it can only
+    // be replaced while the plugin still lives on this thread.
+    if (thread() != QThread::currentThread()) {
+        qCWarning(lcButeoCore) << "Plugin already runs on its own thread, keeping its connection";
+        return;
+    }
+
+    // Peer connections have no bus, so there is no service name either
+    delete iOopPluginIface;
+    setupInterface(QString(), aConnection);
+}
+
+void OOPServerPlugin::setupInterface(const QString &aService, const QDBusConnection &aConnection)
+{
+    iOopPluginIface = new ButeoPluginIface(aService,
                                            DBUS_SERVICE_OBJ_PATH,
-                                           QDBusConnection::sessionBus());
+                                           aConnection);
     iOopPluginIface->setTimeout(60000); // one minute.
 
     // Chain the signals received over dbus
@@ -65,121 +113,113 @@ OOPServerPlugin::OOPServerPlugin(const QString &aPluginName,
 
     connect(iOopPluginIface, SIGNAL(newSession(const QString &)),
             this, SIGNAL(newSession(const QString &)));
-
-    // Handle the signals from the process
-    connect(&aProcess, SIGNAL(error(QProcess::ProcessError)),
-            this, SLOT(onProcessError(QProcess::ProcessError)));
-
-    connect(&aProcess, SIGNAL(finished(int, QProcess::ExitStatus)),
-            this, SLOT(onProcessFinished(int, QProcess::ExitStatus)));
-}
-
-OOPServerPlugin::~OOPServerPlugin()
-{
-    FUNCTION_CALL_TRACE(lcButeoTrace);
-    delete iOopPluginIface;
-    iOopPluginIface = 0;
 }
 
 bool OOPServerPlugin::init()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->init();
-    reply.waitForFinished();
-    if (!reply.isValid()) {
-        qCWarning(lcButeoCore) << "Invalid reply for init from plugin";
-        return false;
+    // msyncd keeps listening on the endpoint of an on-demand server, so the
+    // process gets the socket with the pending connection instead of
+    // opening the endpoint itself.
+    const QString listenFd = iProfile.key(KEY_LISTEN_FD);
+    if (!listenFd.isEmpty() && !passListenSocket(listenFd.toInt())) {
+        qCWarning(lcButeoCore) << "Unable to pass the listening socket to the plugin process of"
+                               << iProfile.name();
     }
 
-    return reply.value();
+    // Waited for in the server thread, which has no later point to report
+    // a failed start.
+    return waitForResult(QStringLiteral("init"), INIT_TIMEOUT);
 }
 
 bool OOPServerPlugin::uninit()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->uninit();
-    reply.waitForFinished();
-    if (!reply.isValid()) {
-        qCWarning(lcButeoCore) << "Invalid reply for startSync from plugin";
-        return false;
-    }
-
-    return reply.value();
+    return waitForResult(QStringLiteral("uninit"), UNINIT_TIMEOUT);
 }
 
 bool OOPServerPlugin::startListen()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->startListen();
-    reply.waitForFinished();
-    if (!reply.isValid()) {
-        qCWarning(lcButeoCore) << "Invalid reply for startListen from plugin";
-        return false;
-    }
-
-    return reply.value();
+    return waitForResult(QStringLiteral("startListen"), START_LISTEN_TIMEOUT);
 }
 
 void OOPServerPlugin::stopListen()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->stopListen();
-    reply.waitForFinished();
-    if (!reply.isValid())
-        qCWarning(lcButeoCore) << "Invalid reply for stopListen from plugin";
+    oopPluginNotify(iOopPluginIface, QStringLiteral("stopListen"), QList<QVariant>(), NOTIFY_TIMEOUT);
 }
 
 void OOPServerPlugin::suspend()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->suspend();
-    reply.waitForFinished();
-    if (!reply.isValid())
-        qCWarning(lcButeoCore) << "Invalid reply for suspend from plugin";
+    oopPluginNotify(iOopPluginIface, QStringLiteral("suspend"), QList<QVariant>(), NOTIFY_TIMEOUT);
 }
 
 void OOPServerPlugin::resume()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->resume();
-    reply.waitForFinished();
-    if (!reply.isValid())
-        qCWarning(lcButeoCore) << "Invalid reply for resume from plugin";
+    oopPluginNotify(iOopPluginIface, QStringLiteral("resume"), QList<QVariant>(), NOTIFY_TIMEOUT);
 }
 
 bool OOPServerPlugin::cleanUp()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<bool> reply = iOopPluginIface->cleanUp();
-    reply.waitForFinished();
-    if (!reply.isValid()) {
-        qCWarning(lcButeoCore) << "Invalid reply for cleanUp from plugin";
-        return false;
-    }
-
-    return reply.value();
+    return waitForResult(QStringLiteral("cleanUp"), CLEANUP_TIMEOUT);
 }
 
 void OOPServerPlugin::connectivityStateChanged(Sync::ConnectivityType aType, bool aState)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDBusPendingReply<void> reply = iOopPluginIface->connectivityStateChanged(aType, aState);
+    oopPluginNotify(iOopPluginIface, QStringLiteral("connectivityStateChanged"),
+                    QList<QVariant>() << QVariant::fromValue(static_cast<int>(aType)) << QVariant::fromValue(aState),
+                    NOTIFY_TIMEOUT);
+}
+
+bool OOPServerPlugin::passListenSocket(int aFd)
+{
+    if (!(iOopPluginIface->connection().connectionCapabilities() & QDBusConnection::UnixFileDescriptorPassing)) {
+        qCWarning(lcButeoCore) << "Connection to the plugin process cannot pass file descriptors";
+        return false;
+    }
+
+    QDBusPendingReply<bool> reply = oopPluginCall(iOopPluginIface, QStringLiteral("setListenSocket"),
+                                                  QList<QVariant>() << QVariant::fromValue(QDBusUnixFileDescriptor(aFd)),
+                                                  NOTIFY_TIMEOUT);
+    reply.waitForFinished();
+    return reply.isValid() && reply.value();
+}
+
+bool OOPServerPlugin::waitForResult(const QString &aMethod, int aTimeout)
+{
+    QDBusPendingReply<bool> reply = oopPluginCall(iOopPluginIface, aMethod, QList<QVariant>(), aTimeout);
     reply.waitForFinished();
-    if (!reply.isValid())
-        qCWarning(lcButeoCore) << "Invalid reply for connectivityStateChanged from plugin";
+    if (!reply.isValid()) {
+        qCWarning(lcButeoCore) << "Invalid reply for" << aMethod << "from plugin:" << reply.error().message();
+        return false;
+    }
+
+    return reply.value();
 }
 
 void OOPServerPlugin::onProcessError(QProcess::ProcessError error)
 {
-    if (!iDone) {
+    // Emitted before finished(), so a crash is classified here
+    QProcess *process = qobject_cast<QProcess *>(sender());
+    if (!iDone && error == QProcess::Crashed && process
+            && OOPResourcePolicy::limitExceeded(*process)) {
+        onError(iProfile.name(),
+                "Plugin process exceeded its resource limits",
+                SyncResults::PLUGIN_RESOURCE_LIMIT);
+    } else if (!iDone) {
         onError(iProfile.name(),
                 "Plugin process error:" + QString::number(error),
                 SyncResults::PLUGIN_ERROR);
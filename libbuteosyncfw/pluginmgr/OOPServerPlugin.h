@@ -23,6 +23,7 @@
 #define OOPSERVERPLUGIN_H
 
 #include <ServerPlugin.h>
+#include <QDBusConnection>
 #include <QProcess>
 
 namespace Buteo {
@@ -46,6 +47,17 @@ public:
     virtual void resume();
     virtual bool cleanUp();
 
+    /*! \brief Talks to the plugin process over aConnection
+     *
+     * Used to move from the session bus to a private connection to the
+     * plugin process, once the process has attached to it. The D-Bus
+     * interface is replaced, so this must happen before the plugin is
+     * moved to its own thread; later calls are ignored.
+     *
+     * @param aConnection Peer connection to the plugin process
+     */
+    void setConnection(const QDBusConnection &aConnection);
+
 public slots:
     virtual void connectivityStateChanged(Sync::ConnectivityType aType, bool aState);
 
@@ -55,6 +67,14 @@ public slots:
     void onSuccess(QString aProfileName, QString aMessage);
 
 private:
+    void setupInterface(const QString &aService, const QDBusConnection &aConnection);
+
+    // Calls aMethod and waits at most aTimeout milliseconds for the result
+    bool waitForResult(const QString &aMethod, int aTimeout);
+
+    // Hands a listening socket to the plugin process, before init
+    bool passListenSocket(int aFd);
+
     bool iDone;
 };
 
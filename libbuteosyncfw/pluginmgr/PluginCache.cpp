@@ -0,0 +1,228 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "PluginCache.h"
+#include "LogMacros.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPluginLoader>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace Buteo;
+
+namespace {
+
+// Bumped whenever the cache layout changes
+const int CACHE_VERSION = 2;
+
+const QString OOPP_DIRECTORY = "oopp/";
+
+struct KindSuffix {
+    PluginCache::Kind iKind;
+    const char *iSuffix;
+    bool iOutOfProcess;
+};
+
+// Location filters of the plugins, in-process and out-of-process
+const KindSuffix KIND_SUFFIXES[] = {
+    { PluginCache::STORAGE_CHANGE_NOTIFIER, "-changenotifier.so", false },
+    { PluginCache::STORAGE, "-storage.so", false },
+    { PluginCache::CLIENT, "-client.so", false },
+    { PluginCache::SERVER, "-server.so", false },
+    { PluginCache::CLIENT, "-client.so", true },
+    { PluginCache::SERVER, "-server.so", true }
+};
+
+// Size and modification time of a plugin library. A library replaced in
+// place, without a change to its directory, is detected by these.
+QJsonObject fileStamp(const QString &aPath)
+{
+    const QFileInfo info(aPath);
+    if (!info.exists()) {
+        return QJsonObject();
+    }
+
+    QJsonObject stamp;
+    stamp.insert(QStringLiteral("size"), QString::number(info.size()));
+    stamp.insert(QStringLiteral("mtime"), QString::number(info.lastModified().toMSecsSinceEpoch()));
+    return stamp;
+}
+
+}
+
+PluginCache::PluginCache(const QString &aPluginPath, const QString &aCacheFile)
+    : iPluginPath(aPluginPath)
+    , iCacheFile(aCacheFile)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!iCacheFile.isEmpty() && load()) {
+        iFromCache = true;
+        return;
+    }
+
+    scan();
+    if (!iCacheFile.isEmpty()) {
+        save();
+    }
+}
+
+QList<PluginCache::Entry> PluginCache::entries() const
+{
+    return iEntries;
+}
+
+bool PluginCache::isFromCache() const
+{
+    return iFromCache;
+}
+
+QString PluginCache::defaultCacheFile(const QString &aPluginPath)
+{
+    // Tests and the daemon use different plugin directories
+    const QByteArray pathHash = QCryptographicHash::hash(aPluginPath.toUtf8(), QCryptographicHash::Md5).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+           + QStringLiteral("/buteo/plugins-") + QString::fromLatin1(pathHash) + QStringLiteral(".json");
+}
+
+bool PluginCache::load()
+{
+    QFile file(iCacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value(QStringLiteral("version")).toInt() != CACHE_VERSION
+            || root.value(QStringLiteral("path")).toString() != iPluginPath
+            || root.value(QStringLiteral("directories")).toObject() != directoryTimes()) {
+        qCDebug(lcButeoCore) << "Plugin cache" << iCacheFile << "is out of date";
+        return false;
+    }
+
+    const QJsonArray plugins = root.value(QStringLiteral("plugins")).toArray();
+    for (const QJsonValue &value : plugins) {
+        const QJsonObject plugin = value.toObject();
+        Entry entry;
+        entry.iKind = static_cast<Kind>(plugin.value(QStringLiteral("kind")).toInt());
+        entry.iOutOfProcess = plugin.value(QStringLiteral("oop")).toBool();
+        entry.iName = plugin.value(QStringLiteral("name")).toString();
+        entry.iPath = plugin.value(QStringLiteral("path")).toString();
+        entry.iMetaData = plugin.value(QStringLiteral("metaData")).toObject();
+        if (plugin.value(QStringLiteral("stamp")).toObject() != fileStamp(entry.iPath)) {
+            qCDebug(lcButeoCore) << "Plugin" << entry.iPath << "changed, plugin cache" << iCacheFile << "is out of date";
+            iEntries.clear();
+            return false;
+        }
+        iEntries.append(entry);
+    }
+    return true;
+}
+
+void PluginCache::scan()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iEntries.clear();
+    scanDirectory(iPluginPath, false);
+    scanDirectory(iPluginPath + OOPP_DIRECTORY, true);
+}
+
+void PluginCache::scanDirectory(const QString &aPath, bool aOutOfProcess)
+{
+    const QStringList files = QDir(aPath).entryList(QDir::Files);
+    for (const QString &file : files) {
+        for (const KindSuffix &kindSuffix : KIND_SUFFIXES) {
+            const QLatin1String suffix(kindSuffix.iSuffix);
+            if (kindSuffix.iOutOfProcess != aOutOfProcess || !file.endsWith(suffix)) {
+                continue;
+            }
+
+            Entry entry;
+            entry.iKind = kindSuffix.iKind;
+            entry.iOutOfProcess = aOutOfProcess;
+            // Remove "lib" and the filter
+            entry.iName = file.mid(3, file.length() - 3 - suffix.size());
+            entry.iPath = aPath + file;
+            // Only parses the metadata section of the file, the library
+            // is not loaded.
+            entry.iMetaData = QPluginLoader(entry.iPath).metaData();
+            iEntries.append(entry);
+            break;
+        }
+    }
+}
+
+void PluginCache::save() const
+{
+    QJsonArray plugins;
+    for (const Entry &entry : iEntries) {
+        QJsonObject plugin;
+        plugin.insert(QStringLiteral("kind"), entry.iKind);
+        plugin.insert(QStringLiteral("oop"), entry.iOutOfProcess);
+        plugin.insert(QStringLiteral("name"), entry.iName);
+        plugin.insert(QStringLiteral("path"), entry.iPath);
+        plugin.insert(QStringLiteral("metaData"), entry.iMetaData);
+        plugin.insert(QStringLiteral("stamp"), fileStamp(entry.iPath));
+        plugins.append(plugin);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("version"), CACHE_VERSION);
+    root.insert(QStringLiteral("path"), iPluginPath);
+    root.insert(QStringLiteral("directories"), directoryTimes());
+    root.insert(QStringLiteral("plugins"), plugins);
+
+    QDir().mkpath(QFileInfo(iCacheFile).absolutePath());
+
+    QSaveFile file(iCacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcButeoCore) << "Failed to open plugin cache" << iCacheFile;
+        return;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        qCWarning(lcButeoCore) << "Failed to write plugin cache" << iCacheFile;
+    }
+}
+
+QJsonObject PluginCache::directoryTimes() const
+{
+    // Installing, removing or renaming a plugin changes the modification
+    // time of its directory. A missing directory is recorded as -1.
+    QJsonObject times;
+    const QStringList directories = QStringList() << iPluginPath << iPluginPath + OOPP_DIRECTORY;
+    for (const QString &directory : directories) {
+        const QFileInfo info(directory);
+        times.insert(directory, info.isDir()
+                     ? QString::number(info.lastModified().toMSecsSinceEpoch())
+                     : QStringLiteral("-1"));
+    }
+    return times;
+}
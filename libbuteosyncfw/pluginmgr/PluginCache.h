@@ -0,0 +1,95 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef PLUGINCACHE_H
+#define PLUGINCACHE_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+namespace Buteo {
+
+/*!
+ * \brief Plugins found in a plugin directory and its oopp/ subdirectory.
+ *
+ * Both directories are listed once, and the kind of each plugin is taken
+ * from its file name suffix. The Qt plugin metadata is read from the
+ * library file without loading it. The result is kept in a cache file,
+ * which is used as long as the modification times of the directories,
+ * and the size and modification time of each plugin, match the ones
+ * recorded in it.
+ */
+class PluginCache
+{
+public:
+    enum Kind {
+        STORAGE,
+        CLIENT,
+        SERVER,
+        STORAGE_CHANGE_NOTIFIER
+    };
+
+    struct Entry {
+        Kind iKind = STORAGE;
+        bool iOutOfProcess = false;
+        QString iName;
+        QString iPath;
+        QJsonObject iMetaData;
+    };
+
+    /*!
+     * \brief Constructor, loads the cache or scans the directories.
+     *
+     * @param aPluginPath Plugin directory, ending with a slash
+     * @param aCacheFile Cache file, no cache is used if empty
+     */
+    PluginCache(const QString &aPluginPath, const QString &aCacheFile);
+
+    //! Plugins found
+    QList<Entry> entries() const;
+
+    //! Returns true if the entries were read from the cache file
+    bool isFromCache() const;
+
+    //! Default cache file for aPluginPath
+    static QString defaultCacheFile(const QString &aPluginPath);
+
+private:
+    bool load();
+
+    void scan();
+
+    void scanDirectory(const QString &aPath, bool aOutOfProcess);
+
+    void save() const;
+
+    QJsonObject directoryTimes() const;
+
+    QString iPluginPath;
+    QString iCacheFile;
+    QList<Entry> iEntries;
+    bool iFromCache = false;
+};
+
+}
+
+#endif // PLUGINCACHE_H
@@ -24,12 +24,16 @@
 
 #include "PluginManager.h"
 
+#include <QCoreApplication>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusServiceWatcher>
 #include <QDir>
+#include <QFileInfo>
 #include <QProcess>
 #include <QPluginLoader>
-
-#include <errno.h>
-#include <signal.h>
+#include <QTimer>
 
 #include "StoragePlugin.h"
 #include "ServerPlugin.h"
@@ -37,49 +41,60 @@
 #include "StorageChangeNotifierPlugin.h"
 #include "OOPClientPlugin.h"
 #include "OOPServerPlugin.h"
+#include "OOPPeerServer.h"
+#include "OOPProcessRegistry.h"
+#include "OOPResourcePolicy.h"
+#include "PluginCache.h"
 #include "SyncPluginLoader.h"
 #include "StoragePluginLoader.h"
 #include "StorageChangeNotifierPluginLoader.h"
 
 #include "LogMacros.h"
+#include "Metrics.h"
+#include "TraceRecorder.h"
 
 namespace {
-// Location filters of plugin maps
-const QString STORAGEMAP_LOCATION = "-storage.so";
-const QString CLIENTMAP_LOCATION = "-client.so";
-const QString SERVERMAP_LOCATION = "-server.so";
-const QString STORAGECHANGENOTIFIERMAP_LOCATION = "-changenotifier.so";
-
-bool killProcess(const QString &exePath, const QStringList &args)
-{
-    const QByteArray expectedCmdLine = (exePath + args.join(QString())).toUtf8();
-    const QString exeFullPath = QFileInfo(exePath).absolutePath();
-    const QDir proc("/proc");
-
-    QStringList entries = proc.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    for (const QString &entry : entries) {
-        int pid = entry.toInt();
-        if (pid) {
-            QString exe = QFile::symLinkTarget(proc.filePath(entry).append("/exe"));
-            if (exeFullPath == exe) {
-                QFile cmdlineFile(proc.filePath(entry).append("/cmdline"));
-                if (!cmdlineFile.open(QFile::ReadOnly)
-                        || cmdlineFile.readAll() != expectedCmdLine) {
-                    continue;
-                }
+const QString OOPP_RUNNER_PATH = "/usr/libexec/buteo-oopp-runner";
+const QString OOPP_POOL_SERVICE_PREFIX = "com.buteo.msyncd.plugin.pool-";
 
-                if (kill(pid, SIGTERM) == 0) {
-                    qCDebug(lcButeoCore) << "Process" << pid << "has been killed";
-                    return true;
-                } else {
-                    qCWarning(lcButeoCore) << "Failed to kill" << exePath << args <<
-                                "[" << pid << "]" << strerror(errno);
-                    return false;
-                }
-            }
+// Tells the runner where to find the private D-Bus server of msyncd
+const QString OOPP_PEER_ADDRESS_ENV = "BUTEO_PLUGIN_PEER_ADDRESS";
+
+// How long an out-of-process plugin may take to register on D-Bus
+static const int OOP_PLUGIN_START_TIMEOUT = 30000;
+
+// How often idle out-of-process plugins are checked for eviction
+static const int OOP_IDLE_CHECK_INTERVAL = 10000;
+
+// How long a stopped runner gets to exit before it is killed
+static const int OOP_STOP_TIMEOUT = 30000;
+
+// How long an evicted idle runner gets to exit before it is killed
+static const int OOP_IDLE_KILL_TIMEOUT = 5000;
+
+// Idle runners are stopped when less than this share of memory is available
+static const int LOW_MEMORY_PERCENT = 10;
+
+static bool isMemoryLow()
+{
+    QFile meminfo(QStringLiteral("/proc/meminfo"));
+    if (!meminfo.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 total = -1;
+    qint64 available = -1;
+    // /proc files report no size, so read everything at once
+    const QList<QByteArray> lines = meminfo.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("MemTotal:")) {
+            total = line.mid(9).simplified().split(' ').value(0).toLongLong();
+        } else if (line.startsWith("MemAvailable:")) {
+            available = line.mid(13).simplified().split(' ').value(0).toLongLong();
         }
     }
-    return false;
+
+    return total > 0 && available >= 0 && available * 100 < total * LOW_MEMORY_PERCENT;
 }
 
 }
@@ -96,26 +111,32 @@ PluginManager::PluginManager(const QString &aPluginPath)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    connect(&iOOPIdleTimer, &QTimer::timeout, this, &PluginManager::evictIdleOOPRunners);
+
     if (!iPluginPath.isEmpty() && !iPluginPath.endsWith('/')) {
         iPluginPath.append('/');
     }
 
-    loadPluginMaps(iPluginPath, STORAGECHANGENOTIFIERMAP_LOCATION, iStorageChangeNotifierMaps);
-    loadPluginMaps(iPluginPath, STORAGEMAP_LOCATION, iStorageMaps);
-    loadPluginMaps(iPluginPath, CLIENTMAP_LOCATION, iClientMaps);
-    loadPluginMaps(iPluginPath, SERVERMAP_LOCATION, iServerMaps);
-
-    const QString ooppPath = iPluginPath + "oopp/";
-    loadPluginMaps(ooppPath, CLIENTMAP_LOCATION, iOopClientMaps);
-    loadPluginMaps(ooppPath, SERVERMAP_LOCATION, iOoPServerMaps);
+    loadPluginMaps();
 }
 
 PluginManager::~PluginManager()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    for (int i = 0; i < iLoadedDlls.count(); ++i) {
-        iLoadedDlls[i].cleanUp();
+    for (const OOPPoolRunner &runner : iOOPPool) {
+        delete runner.iWatcher;
+        runner.iProcess->terminate();
+        runner.iProcess->waitForFinished(1000);
+        delete runner.iProcess;
+    }
+    iOOPPool.clear();
+
+    delete iProcessRegistry;
+    iProcessRegistry = nullptr;
+
+    for (auto it = iLoadedDlls.begin(); it != iLoadedDlls.end(); ++it) {
+        it->cleanUp();
     }
 }
 
@@ -135,13 +156,12 @@ StorageChangeNotifierPlugin *PluginManager::createStorageChangeNotifier(const QS
         return plugin;
     }
 
-    QPluginLoader *pluginLoader = new QPluginLoader(libraryName, this);
+    QPluginLoader *pluginLoader = takePluginLoader(libraryName);
     if (StorageChangeNotifierPluginLoader * notifierPluginLoader
             = qobject_cast<StorageChangeNotifierPluginLoader *>(pluginLoader->instance())) {
         StorageChangeNotifierPlugin *plugin = notifierPluginLoader->createPlugin(aStorageName);
         if (plugin) {
-            addLoadedPlugin(libraryName, pluginLoader, plugin);
-            return plugin;
+            return qobject_cast<StorageChangeNotifierPlugin *>(addLoadedPlugin(libraryName, pluginLoader, plugin));
         }
     }
 
@@ -183,13 +203,12 @@ StoragePlugin *PluginManager::createStorage(const QString &aPluginName)
         return plugin;
     }
 
-    QPluginLoader *pluginLoader = new QPluginLoader(libraryName, this);
+    QPluginLoader *pluginLoader = takePluginLoader(libraryName);
     if (StoragePluginLoader * storagePluginLoader
             = qobject_cast<StoragePluginLoader *>(pluginLoader->instance())) {
         StoragePlugin *plugin = storagePluginLoader->createPlugin(aPluginName);
         if (plugin) {
-            addLoadedPlugin(libraryName, pluginLoader, plugin);
-            return plugin;
+            return qobject_cast<StoragePlugin *>(addLoadedPlugin(libraryName, pluginLoader, plugin));
         }
     }
 
@@ -234,12 +253,11 @@ ClientPlugin *PluginManager::createClient(const QString &aPluginName,
             return plugin;
         }
 
-        QPluginLoader *pluginLoader = new QPluginLoader(libraryName, this);
+        QPluginLoader *pluginLoader = takePluginLoader(libraryName);
         if (SyncPluginLoader * syncPluginLoader = qobject_cast<SyncPluginLoader *>(pluginLoader->instance())) {
             ClientPlugin *plugin = syncPluginLoader->createClientPlugin(aPluginName, aProfile, aCbInterface);
             if (plugin) {
-                addLoadedPlugin(libraryName, pluginLoader, plugin);
-                return plugin;
+                return qobject_cast<ClientPlugin *>(addLoadedPlugin(libraryName, pluginLoader, plugin));
             }
         }
 
@@ -251,15 +269,22 @@ ClientPlugin *PluginManager::createClient(const QString &aPluginName,
     } else if (iOopClientMaps.contains(aPluginName)) {
         // Start the out of process plugin
         const QString libraryName = iOopClientMaps.value(aPluginName);
-        QProcess *process = startOOPPlugin(aPluginName, aProfile.name(), libraryName);
+        QProcess *process = takeIdleOOPRunner(aPluginName, aProfile.name());
+        if (process == nullptr) {
+            process = startOOPPlugin(aPluginName, aProfile.name(), libraryName,
+                                     oopResourcePolicy(aProfile));
+        }
 
         if (process == nullptr) {
             qCCritical(lcButeoCore) << "Could not start process";
             return nullptr;
         }
 
-        // Create the client plugin interface to talk to the process
-        return new OOPClientPlugin(aPluginName, aProfile, aCbInterface, *process);
+        // Create the client plugin interface to talk to the process. The
+        // plugin is usable once pluginStarted() has been emitted for it.
+        OOPClientPlugin *plugin = new OOPClientPlugin(aPluginName, aProfile, aCbInterface, *process);
+        watchOOPPlugin(process, plugin);
+        return plugin;
     }
 
     return nullptr;
@@ -283,10 +308,9 @@ void PluginManager::destroyClient(ClientPlugin *aPlugin)
         unloadPlugin(iClientMaps.value(pluginName));
 
     } else if (iOopClientMaps.contains(pluginName)) {
-        // Stop the OOP process
-        qCDebug(lcButeoCore) << "Stopping the OOP process for " << pluginName;
-        QString path = iOopClientMaps.value(pluginName);
-        stopOOPPlugin(path);
+        // Stop the OOP process, or keep it for the next session
+        qCDebug(lcButeoCore) << "Releasing the OOP process for " << pluginName;
+        releaseOOPPlugin(aPlugin);
         delete aPlugin;
     }
 }
@@ -310,13 +334,12 @@ ServerPlugin *PluginManager::createServer(const QString &aPluginName,
             return plugin;
         }
 
-        QPluginLoader *pluginLoader = new QPluginLoader(libraryName, this);
+        QPluginLoader *pluginLoader = takePluginLoader(libraryName);
         if (SyncPluginLoader * syncPluginLoader
                 = qobject_cast<SyncPluginLoader *>(pluginLoader->instance())) {
             ServerPlugin *plugin = syncPluginLoader->createServerPlugin(aPluginName, aProfile, aCbInterface);
             if (plugin) {
-                addLoadedPlugin(libraryName, pluginLoader, plugin);
-                return plugin;
+                return qobject_cast<ServerPlugin *>(addLoadedPlugin(libraryName, pluginLoader, plugin));
             }
         }
 
@@ -328,17 +351,23 @@ ServerPlugin *PluginManager::createServer(const QString &aPluginName,
     } else if (iOoPServerMaps.contains(aPluginName)) {
         // Start the Oop process plugin
         const QString libraryName = iOoPServerMaps.value(aPluginName);
-        QProcess *process = startOOPPlugin(aPluginName, aProfile.name(), libraryName);
+        QProcess *process = takeIdleOOPRunner(aPluginName, aProfile.name());
+        if (process == nullptr) {
+            process = startOOPPlugin(aPluginName, aProfile.name(), libraryName,
+                                     oopResourcePolicy(aProfile));
+        }
 
         if (process == nullptr) {
             qCCritical(lcButeoCore) << "Could not start server plugin process";
             return nullptr;
         }
 
-        return new OOPServerPlugin(aPluginName,
-                                   aProfile,
-                                   aCbInterface,
-                                   *process);
+        OOPServerPlugin *plugin = new OOPServerPlugin(aPluginName,
+                                                      aProfile,
+                                                      aCbInterface,
+                                                      *process);
+        watchOOPPlugin(process, plugin);
+        return plugin;
     }
 
     return nullptr;
@@ -363,140 +392,571 @@ void PluginManager::destroyServer(ServerPlugin *aPlugin)
         unloadPlugin(iServerMaps.value(pluginName));
 
     } else if (iOoPServerMaps.contains(pluginName)) {
-        // Stop the OOP server process
-        QString path = iOoPServerMaps.value(pluginName);
-        stopOOPPlugin(path);
+        // Stop the OOP server process, or keep it for the next session
+        releaseOOPPlugin(aPlugin);
         delete aPlugin;
     }
 }
 
-void PluginManager::loadPluginMaps(const QString &pluginDirPath, const QString &aFilter,
-                                   QMap<QString, QString> &aTargetMap)
+void PluginManager::loadPluginMaps()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QDir pluginDirectory(pluginDirPath);
-    QStringList entries = pluginDirectory.entryList(QDir::Files);
-    QStringList::const_iterator listIterator = entries.constBegin();
-
-    while (listIterator != entries.constEnd()) {
-        QString file = (*listIterator);
-
-        if (!file.endsWith(aFilter)) {
-            ++listIterator;
-            continue;
+    const PluginCache cache(iPluginPath, PluginCache::defaultCacheFile(iPluginPath));
+    const QList<PluginCache::Entry> entries = cache.entries();
+    for (const PluginCache::Entry &entry : entries) {
+        QMap<QString, QString> *targetMap = nullptr;
+        switch (entry.iKind) {
+        case PluginCache::STORAGE:
+            targetMap = &iStorageMaps;
+            break;
+        case PluginCache::STORAGE_CHANGE_NOTIFIER:
+            targetMap = &iStorageChangeNotifierMaps;
+            break;
+        case PluginCache::CLIENT:
+            targetMap = entry.iOutOfProcess ? &iOopClientMaps : &iClientMaps;
+            break;
+        case PluginCache::SERVER:
+            targetMap = entry.iOutOfProcess ? &iOoPServerMaps : &iServerMaps;
+            break;
         }
-        // Remove filter from end
-        file.chop(aFilter.length());
-
-        // Remove lib
-        file.remove(0, 3);
 
-        aTargetMap[file] = pluginDirPath + (*listIterator);
-        ++listIterator;
+        targetMap->insert(entry.iName, entry.iPath);
     }
 }
 
 QProcess *PluginManager::startOOPPlugin(const QString &aPluginName,
                                         const QString &aProfileName,
-                                        const QString &aPluginFilePath)
+                                        const QString &aPluginFilePath,
+                                        const OOPResourcePolicy &aPolicy)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    static const QString exePath = "/usr/libexec/buteo-oopp-runner";
+    TraceScope traceScope("startOOPPlugin", "plugin", aProfileName);
 
     bool started = false;
     QStringList args;
     args << aPluginName << aProfileName << aPluginFilePath;
 
-    if (killProcess(exePath, args)) {
-        qCInfo(lcButeoCore) << "Killed runaway plugin" << aProfileName;
-    }
-
     qCDebug(lcButeoCore) << "Starting out-of-process plugin " << aPluginFilePath <<
                " with plugin name " << aPluginName <<
                " and profile name " << aProfileName;
 
-    QProcess *process = new QProcess();
-    process->setProcessChannelMode(QProcess::ForwardedChannels);
-    process->start(exePath, args);
-
-    const QString clientPluginDBusServiceName(QString(QLatin1String("com.buteo.msyncd.plugin.profile-%1")).arg(
-                                                  aProfileName));
-    const QString serverPluginDBusServiceName(QString(QLatin1String("com.buteo.msyncd.plugin.%1")).arg(aProfileName));
-    bool pluginHasRegistered = false;
-    for (int i = 0; i < 30; i++) { // wait for up to thirty seconds for the process to register with dbus
-        QThread::sleep(1);         // sleep for a second to wait for the process to be scheduled, init and register with dbus
-        QDBusReply<bool> clientServiceRegistered = QDBusConnection::sessionBus().interface()->isServiceRegistered(
-                                                       clientPluginDBusServiceName);
-        if (clientServiceRegistered.isValid() && clientServiceRegistered.value()) {
-            pluginHasRegistered = true;
-            break;
-        }
-        QDBusReply<bool> serverServiceRegistered = QDBusConnection::sessionBus().interface()->isServiceRegistered(
-                                                       serverPluginDBusServiceName);
-        if (serverServiceRegistered.isValid() && serverServiceRegistered.value()) {
-            pluginHasRegistered = true;
-            break;
-        }
-    }
+    // Watch for the plugin service before spawning the process, so that the
+    // registration cannot be missed.
+    QDBusServiceWatcher *watcher = new QDBusServiceWatcher(this);
+    watcher->setConnection(QDBusConnection::sessionBus());
+    watcher->setWatchMode(QDBusServiceWatcher::WatchForRegistration);
+    watcher->addWatchedService(QString(QLatin1String("com.buteo.msyncd.plugin.profile-%1")).arg(aProfileName));
+    watcher->addWatchedService(QString(QLatin1String("com.buteo.msyncd.plugin.%1")).arg(aProfileName));
 
-    if (process->state() == QProcess::Starting) {
-        started = process->waitForStarted();
+    QProcess *process = takeOOPPoolRunner(aPluginName, aProfileName, aPluginFilePath);
+    if (process) {
+        started = true;
     } else {
-        started = process->state() == QProcess::Running;
+        process = new QProcess();
+        process->setProcessChannelMode(QProcess::ForwardedChannels);
+        setOOPPeerEnvironment(process);
+        process->start(OOPP_RUNNER_PATH, args);
+
+        // Only waits for the exec, not for the plugin to initialize.
+        if (process->state() == QProcess::Starting) {
+            started = process->waitForStarted();
+        } else {
+            started = process->state() == QProcess::Running;
+        }
+
+        if (started) {
+            trackOOPProcess(process);
+        }
     }
 
     if (started) {
-        DllInfo info;
-        info.iPath = aPluginFilePath;
-        info.iHandle = process;
-
-        iDllLock.lockForWrite();
-        iLoadedDlls.append(info);
-        iDllLock.unlock();
-
         qCDebug(lcButeoCore) << "Process " << process->program() << " started with pid " << process->pid();
-        if (!pluginHasRegistered) {
-            qCDebug(lcButeoCore) << "Process " << process->program() << " with pid " << process->pid()
-                                 << "was unable to register DBus service: " << clientPluginDBusServiceName
-                                 << "|" << serverPluginDBusServiceName;
-        }
+        limitOOPProcess(process, aPolicy);
         connect(process, SIGNAL(finished(int, QProcess::ExitStatus)),
                 this, SLOT(onProcessFinished(int, QProcess::ExitStatus)));
+
+        OOPLaunch launch;
+        launch.iWatcher = watcher;
+        launch.iProfileName = aProfileName;
+        launch.iTimer.start();
+        iOOPLaunches.insert(process, launch);
+        TraceRecorder::instance()->asyncBegin("pluginLaunch", "plugin", aProfileName);
+
+        connect(watcher, &QDBusServiceWatcher::serviceRegistered, this, [this, process] {
+            finishOOPPluginStart(process, true);
+        });
+        connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                watcher, [this, process] {
+            finishOOPPluginStart(process, false);
+        });
+        QTimer::singleShot(OOP_PLUGIN_START_TIMEOUT, watcher, [this, process] {
+            finishOOPPluginStart(process, false);
+        });
+
+        // The watcher only reports registrations made from now on, so also
+        // ask the bus whether the service is there already. This is the
+        // asynchronous form of QDBusConnectionInterface::isServiceRegistered().
+        foreach (const QString &service, watcher->watchedServices()) {
+            QDBusMessage call = QDBusMessage::createMethodCall(QStringLiteral("org.freedesktop.DBus"),
+                                                               QStringLiteral("/org/freedesktop/DBus"),
+                                                               QStringLiteral("org.freedesktop.DBus"),
+                                                               QStringLiteral("NameHasOwner"));
+            call << service;
+            QDBusPendingCallWatcher *ownerWatcher = new QDBusPendingCallWatcher(
+                        QDBusConnection::sessionBus().asyncCall(call), watcher);
+            connect(ownerWatcher, &QDBusPendingCallWatcher::finished,
+                    this, [this, process](QDBusPendingCallWatcher *aWatcher) {
+                QDBusPendingReply<bool> reply = *aWatcher;
+                aWatcher->deleteLater();
+                if (!reply.isError() && reply.value()) {
+                    finishOOPPluginStart(process, true);
+                }
+            });
+        }
         return process;
 
     } else {
         qCCritical(lcButeoCore) << "Unable to start process plugin " << aPluginFilePath
                                 << ". Error " << process->error();
+        Metrics::instance()->counter(QStringLiteral("msyncd_plugin_launch_failures_total"))->add();
+        delete watcher;
         delete process;
         return nullptr;
     }
 }
 
-void PluginManager::stopOOPPlugin(const QString &aPath)
+void PluginManager::setOOPResourceLimits(int aNice, qint64 aMemoryLimit, const QString &aCgroupParent)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    QProcess *process = nullptr;
-    iDllLock.lockForWrite();
+    iOOPNice = aNice;
+    iOOPMemoryLimit = qMax(Q_INT64_C(0), aMemoryLimit);
+    iOOPCgroupParent = aCgroupParent;
+}
+
+OOPResourcePolicy PluginManager::oopResourcePolicy(const Profile &aProfile) const
+{
+    OOPResourcePolicy defaults;
+    defaults.iNice = iOOPNice;
+    defaults.iMemoryLimit = iOOPMemoryLimit;
+    return OOPResourcePolicy::fromProfile(aProfile, defaults);
+}
+
+void PluginManager::limitOOPProcess(QProcess *aProcess, const OOPResourcePolicy &aPolicy)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (aPolicy.iCpuTimeLimit > 0) {
+        aProcess->setProperty(OOPResourcePolicy::CPU_TIME_LIMIT_PROPERTY, true);
+    }
 
-    for (int i = 0; i < iLoadedDlls.size(); ++i) {
-        if (iLoadedDlls[i].iPath == aPath) {
-            process = iLoadedDlls[i].iHandle;
+    const QString group = aPolicy.apply(aProcess->processId(), iOOPCgroupParent);
+    if (group.isEmpty()) {
+        return;
+    }
+
+    aProcess->setProperty(OOPResourcePolicy::CGROUP_PROPERTY, group);
+    // Queued, so that the plugin can still look at the group of a runner
+    // which was killed
+    connect(aProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [group] {
+        OOPResourcePolicy::removeGroup(group);
+    }, Qt::QueuedConnection);
+}
+
+void PluginManager::setOOPProcessRegistry(const QString &aPath)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    delete iProcessRegistry;
+    iProcessRegistry = new OOPProcessRegistry(aPath);
+
+    const int reaped = iProcessRegistry->reapStale();
+    if (reaped > 0) {
+        qCInfo(lcButeoCore) << "Terminated" << reaped << "plugin runners left from a previous instance";
+    }
+}
+
+void PluginManager::trackOOPProcess(QProcess *aProcess)
+{
+    if (!iProcessRegistry) {
+        return;
+    }
+
+    auto track = [this, aProcess] {
+        const qint64 pid = aProcess->processId();
+        iProcessRegistry->add(pid);
+        connect(aProcess, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                this, [this, pid] {
+            if (iProcessRegistry) {
+                iProcessRegistry->remove(pid);
+            }
+        });
+    };
+
+    if (aProcess->state() == QProcess::Running) {
+        track();
+    } else if (aProcess->state() == QProcess::Starting) {
+        connect(aProcess, &QProcess::started, this, track);
+    }
+}
+
+void PluginManager::setOOPPeerServer(const QString &aSocketDir)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    delete iPeerServer;
+    iPeerServer = new OOPPeerServer(aSocketDir, this);
+}
+
+void PluginManager::setOOPPeerEnvironment(QProcess *aProcess)
+{
+    if (!iPeerServer || !iPeerServer->isConnected()) {
+        return;
+    }
+
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(OOPP_PEER_ADDRESS_ENV, iPeerServer->address());
+    aProcess->setProcessEnvironment(environment);
+}
+
+void PluginManager::useOOPPeerConnection(SyncPluginBase *aPlugin, const QString &aProfileName)
+{
+    if (!iPeerServer) {
+        return;
+    }
+
+    // The runner attaches before registering its service name, so the
+    // connection is known by the time the plugin is reported started.
+    const QDBusConnection connection = iPeerServer->peerConnection(aProfileName);
+    if (!connection.isConnected()) {
+        return;
+    }
+
+    if (OOPClientPlugin *client = qobject_cast<OOPClientPlugin *>(aPlugin)) {
+        client->setConnection(connection);
+    } else if (OOPServerPlugin *server = qobject_cast<OOPServerPlugin *>(aPlugin)) {
+        server->setConnection(connection);
+    }
+}
+
+void PluginManager::setOOPPoolSize(int aSize)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iOOPPoolSize = qMax(0, aSize);
+
+    while (iOOPPool.count() > iOOPPoolSize) {
+        OOPPoolRunner runner = iOOPPool.takeLast();
+        delete runner.iWatcher;
+        runner.iProcess->terminate();
+        runner.iProcess->deleteLater();
+    }
+
+    fillOOPPool();
+}
+
+void PluginManager::fillOOPPool()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iOopClientMaps.isEmpty() && iOoPServerMaps.isEmpty()) {
+        return;
+    }
+
+    while (iOOPPool.count() < iOOPPoolSize) {
+        OOPPoolRunner runner;
+        const QString id = QString::number(QCoreApplication::applicationPid()) + QLatin1Char('-')
+                           + QString::number(++iOOPPoolSerial);
+        runner.iService = OOPP_POOL_SERVICE_PREFIX + id;
+        runner.iWatcher = new QDBusServiceWatcher(runner.iService, QDBusConnection::sessionBus(),
+                                                  QDBusServiceWatcher::WatchForRegistration, this);
+        runner.iProcess = new QProcess();
+        runner.iProcess->setProcessChannelMode(QProcess::ForwardedChannels);
+        setOOPPeerEnvironment(runner.iProcess);
+
+        QProcess *process = runner.iProcess;
+        connect(runner.iWatcher, &QDBusServiceWatcher::serviceRegistered, this, [this, process] {
+            for (OOPPoolRunner &pooled : iOOPPool) {
+                if (pooled.iProcess == process) {
+                    qCDebug(lcButeoCore) << "Idle plugin runner" << pooled.iService << "is ready";
+                    pooled.iReady = true;
+                }
+            }
+        });
+        // The watcher is the context, so these are dropped once the runner
+        // has been taken from the pool.
+        connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                runner.iWatcher, [this, process] {
+            qCWarning(lcButeoCore) << "Idle plugin runner exited";
+            removeOOPPoolRunner(process);
+        });
+        connect(process, &QProcess::errorOccurred, runner.iWatcher, [this, process](QProcess::ProcessError aError) {
+            if (aError == QProcess::FailedToStart) {
+                qCWarning(lcButeoCore) << "Unable to start idle plugin runner";
+                removeOOPPoolRunner(process);
+            }
+        });
+
+        iOOPPool.append(runner);
+        process->start(OOPP_RUNNER_PATH, QStringList() << QStringLiteral("--pool") << id);
+        trackOOPProcess(process);
+
+        // Failing runners are not restarted here, to avoid spinning.
+        if (process->state() == QProcess::NotRunning) {
             break;
         }
     }
+}
 
-    iDllLock.unlock();
+QProcess *PluginManager::takeOOPPoolRunner(const QString &aPluginName, const QString &aProfileName,
+                                           const QString &aPluginFilePath)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    // We must terminate the process outside of the locked section because
-    // onProcessFinished handler below will want to acquire the same lock.
-    // It will also schedule the deletion of the QProcess object.
-    if (process) {
-        process->terminate();
-        if (process->waitForFinished() == false)
-            process->kill();
+    for (int i = 0; i < iOOPPool.count(); ++i) {
+        if (!iOOPPool.at(i).iReady) {
+            continue;
+        }
+
+        OOPPoolRunner runner = iOOPPool.takeAt(i);
+        delete runner.iWatcher;
+
+        qCDebug(lcButeoCore) << "Assigning profile" << aProfileName << "to idle plugin runner" << runner.iService;
+
+        // The runner registers the profile's service name before it replies,
+        // so the reply finishes the launch either way.
+        QProcess *process = runner.iProcess;
+        QDBusMessage call = QDBusMessage::createMethodCall(runner.iService, QStringLiteral("/"),
+                                                           QStringLiteral("com.buteo.msyncd.baseplugin"),
+                                                           QStringLiteral("setPluginParams"));
+        call << aPluginName << aProfileName << aPluginFilePath;
+        QDBusPendingCallWatcher *callWatcher = new QDBusPendingCallWatcher(
+                    QDBusConnection::sessionBus().asyncCall(call), process);
+        connect(callWatcher, &QDBusPendingCallWatcher::finished,
+                this, [this, process](QDBusPendingCallWatcher *aWatcher) {
+            QDBusPendingReply<bool> reply = *aWatcher;
+            aWatcher->deleteLater();
+            if (reply.isError() || !reply.value()) {
+                qCWarning(lcButeoCore) << "Idle plugin runner refused plugin:" << reply.error().message();
+                finishOOPPluginStart(process, false);
+                process->terminate();
+            } else {
+                finishOOPPluginStart(process, true);
+            }
+        });
+
+        fillOOPPool();
+        return process;
+    }
+
+    // Nothing ready yet, make sure the pool keeps its size
+    fillOOPPool();
+    return nullptr;
+}
+
+void PluginManager::removeOOPPoolRunner(QProcess *aProcess)
+{
+    for (int i = 0; i < iOOPPool.count(); ++i) {
+        if (iOOPPool.at(i).iProcess == aProcess) {
+            OOPPoolRunner runner = iOOPPool.takeAt(i);
+            runner.iWatcher->deleteLater();
+            runner.iProcess->deleteLater();
+            break;
+        }
+    }
+}
+
+void PluginManager::watchOOPPlugin(QProcess *aProcess, SyncPluginBase *aPlugin)
+{
+    iOOPPluginProcesses.insert(aPlugin, aProcess);
+
+    if (iOOPLaunches.contains(aProcess)) {
+        iOOPLaunches[aProcess].iPlugin = aPlugin;
+    } else {
+        // Reused runner, which has attached already
+        useOOPPeerConnection(aPlugin, aPlugin->getProfileName());
+    }
+}
+
+void PluginManager::finishOOPPluginStart(QProcess *aProcess, bool aSuccess)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!iOOPLaunches.contains(aProcess)) {
+        return;
+    }
+
+    OOPLaunch launch = iOOPLaunches.take(aProcess);
+    launch.iWatcher->deleteLater();
+    TraceRecorder::instance()->asyncEnd("pluginLaunch", "plugin", launch.iProfileName);
+
+    if (aSuccess) {
+        qCDebug(lcButeoCore) << "Out-of-process plugin for profile" << launch.iProfileName
+                             << "registered after" << launch.iTimer.elapsed() << "ms";
+        static MetricsHistogram *launchHistogram = Metrics::instance()->histogram(
+                    QStringLiteral("msyncd_plugin_launch_ms"));
+        launchHistogram->record(launch.iTimer.elapsed());
+        if (launch.iPlugin) {
+            useOOPPeerConnection(launch.iPlugin, launch.iProfileName);
+        }
+    } else {
+        qCWarning(lcButeoCore) << "Out-of-process plugin for profile" << launch.iProfileName
+                               << "was unable to register its D-Bus service";
+        Metrics::instance()->counter(QStringLiteral("msyncd_plugin_launch_failures_total"))->add();
+    }
+
+    if (launch.iPlugin) {
+        emit pluginStarted(launch.iPlugin, aSuccess);
+    }
+}
+
+void PluginManager::cancelOOPPluginStart(SyncPluginBase *aPlugin)
+{
+    for (auto it = iOOPLaunches.begin(); it != iOOPLaunches.end(); ++it) {
+        if (it->iPlugin == aPlugin) {
+            it->iWatcher->deleteLater();
+            TraceRecorder::instance()->asyncEnd("pluginLaunch", "plugin", it->iProfileName);
+            iOOPLaunches.erase(it);
+            break;
+        }
+    }
+}
+
+bool PluginManager::isPluginStarting(SyncPluginBase *aPlugin) const
+{
+    for (auto it = iOOPLaunches.constBegin(); it != iOOPLaunches.constEnd(); ++it) {
+        if (it->iPlugin == aPlugin) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PluginManager::killOOPPlugin(SyncPluginBase *aPlugin)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QProcess *process = iOOPPluginProcesses.value(aPlugin);
+    if (!process || process->state() == QProcess::NotRunning) {
+        return false;
+    }
+
+    qCWarning(lcButeoCore) << "Killing plugin runner" << process->processId()
+                           << "of" << aPlugin->getProfileName();
+    // The plugin watches its process and reports the error.
+    process->kill();
+    return true;
+}
+
+void PluginManager::stopOOPPlugin(QProcess *aProcess)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    // onProcessFinished() below will schedule the deletion of the QProcess
+    // object, which also cancels the kill. Nothing needs the process gone
+    // synchronously, so the main loop is not blocked waiting for it.
+    aProcess->terminate();
+    QTimer::singleShot(OOP_STOP_TIMEOUT, aProcess, &QProcess::kill);
+}
+
+void PluginManager::releaseOOPPlugin(SyncPluginBase *aPlugin)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    const bool starting = isPluginStarting(aPlugin);
+    cancelOOPPluginStart(aPlugin);
+
+    QProcess *process = iOOPPluginProcesses.take(aPlugin);
+    if (!process) {
+        return;
+    }
+
+    // RLIMIT_CPU is not reset between sessions, so a reused runner would
+    // be killed once all of its sessions together exceeded the limit.
+    if (starting || iOOPKeepAlive <= 0 || iOOPMaxIdleRunners <= 0
+            || process->state() != QProcess::Running
+            || process->property(OOPResourcePolicy::CPU_TIME_LIMIT_PROPERTY).toBool()) {
+        stopOOPPlugin(process);
+        return;
+    }
+
+    // The plugin has been uninitialized by now, but the runner stays on
+    // the bus for the next session of the same profile.
+    qCDebug(lcButeoCore) << "Keeping the OOP process for" << aPlugin->getProfileName() << "alive";
+    OOPIdleRunner runner;
+    runner.iProcess = process;
+    runner.iPluginName = aPlugin->getPluginName();
+    runner.iProfileName = aPlugin->getProfileName();
+    runner.iIdleSince.start();
+    iOOPIdleRunners.append(runner);
+
+    evictIdleOOPRunners();
+    if (!iOOPIdleRunners.isEmpty() && !iOOPIdleTimer.isActive()) {
+        iOOPIdleTimer.start(qMin(iOOPKeepAlive, OOP_IDLE_CHECK_INTERVAL));
+    }
+}
+
+QProcess *PluginManager::takeIdleOOPRunner(const QString &aPluginName, const QString &aProfileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    for (int i = 0; i < iOOPIdleRunners.count(); ++i) {
+        const OOPIdleRunner &runner = iOOPIdleRunners.at(i);
+        if (runner.iPluginName == aPluginName && runner.iProfileName == aProfileName
+                && runner.iProcess->state() == QProcess::Running) {
+            QProcess *process = iOOPIdleRunners.takeAt(i).iProcess;
+            if (iOOPIdleRunners.isEmpty()) {
+                iOOPIdleTimer.stop();
+            }
+            qCDebug(lcButeoCore) << "Reusing the OOP process for" << aProfileName;
+            Metrics::instance()->counter(QStringLiteral("msyncd_plugin_runner_reused_total"))->add();
+            return process;
+        }
+    }
+    return nullptr;
+}
+
+void PluginManager::setOOPKeepAlive(int aIdleTimeout, int aMaxIdleRunners)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iOOPKeepAlive = qMax(0, aIdleTimeout);
+    iOOPMaxIdleRunners = qMax(0, aMaxIdleRunners);
+    evictIdleOOPRunners();
+}
+
+void PluginManager::evictIdleOOPRunners()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iOOPIdleRunners.isEmpty()) {
+        iOOPIdleTimer.stop();
+        return;
+    }
+
+    const bool lowMemory = isMemoryLow();
+    if (lowMemory) {
+        qCInfo(lcButeoCore) << "Memory is low, stopping idle OOP processes";
+    }
+
+    // Oldest runners are at the front
+    for (int i = iOOPIdleRunners.count() - 1; i >= 0; --i) {
+        const OOPIdleRunner &runner = iOOPIdleRunners.at(i);
+        if (lowMemory || runner.iIdleSince.elapsed() >= iOOPKeepAlive
+                || i < iOOPIdleRunners.count() - iOOPMaxIdleRunners) {
+            qCDebug(lcButeoCore) << "Stopping idle OOP process for" << runner.iProfileName;
+            QProcess *process = iOOPIdleRunners.takeAt(i).iProcess;
+            // Nothing waits for an idle runner, so it is not waited for either
+            process->terminate();
+            QTimer::singleShot(OOP_IDLE_KILL_TIMEOUT, process, &QProcess::kill);
+        }
+    }
+
+    if (iOOPIdleRunners.isEmpty()) {
+        iOOPIdleTimer.stop();
     }
 }
 
@@ -507,67 +967,154 @@ void PluginManager::onProcessFinished(int exitCode, QProcess::ExitStatus)
     QProcess *process = (QProcess *)sender();
     qCDebug(lcButeoCore) << "Process " << process->program() << " finished with exit code" << exitCode;
 
-    iDllLock.lockForWrite();
+    for (auto it = iOOPPluginProcesses.begin(); it != iOOPPluginProcesses.end();) {
+        if (it.value() == process) {
+            it = iOOPPluginProcesses.erase(it);
+        } else {
+            ++it;
+        }
+    }
 
-    for (int i = 0; i < iLoadedDlls.size(); ++i) {
-        if (iLoadedDlls[i].iHandle == process) {
-            iLoadedDlls.removeAt(i);
+    for (int i = 0; i < iOOPIdleRunners.count(); ++i) {
+        if (iOOPIdleRunners.at(i).iProcess == process) {
+            iOOPIdleRunners.removeAt(i);
             break;
         }
     }
 
-    iDllLock.unlock();
-
     process->deleteLater();
 }
 
-void PluginManager::addLoadedPlugin(const QString &libraryName,
-                                    QPluginLoader *pluginLoader,
-                                    QObject *plugin)
+QObject *PluginManager::addLoadedPlugin(const QString &libraryName,
+                                        QPluginLoader *pluginLoader,
+                                        QObject *plugin)
 {
     DllInfo info;
-    info.iPath = libraryName;
     info.iPluginLoader = pluginLoader;
     info.iLoadedPlugin = plugin;
-    info.iRefCount = 1;
+    info.iRefCount.store(1);
+    info.iSize = QFileInfo(libraryName).size();
+
+    QObject *loadedPlugin = plugin;
+    DllInfo resident;
 
     iDllLock.lockForWrite();
-    iLoadedDlls.append(info);
+    auto it = iLoadedDlls.find(libraryName);
+    if (it != iLoadedDlls.end() && it->iLoadedPlugin) {
+        // Another thread loaded the library meanwhile, share its plugin
+        it->iRefCount.ref();
+        loadedPlugin = it->iLoadedPlugin;
+    } else {
+        if (it != iLoadedDlls.end()) {
+            // The other thread's plugin was released meanwhile, the
+            // library is kept loaded by pluginLoader.
+            if (iResidentDlls.removeOne(libraryName)) {
+                iResidentSize -= it->iSize;
+            }
+            resident = it.value();
+        }
+        iLoadedDlls.insert(libraryName, info);
+    }
     iDllLock.unlock();
+
+    resident.cleanUp();
+    if (loadedPlugin != plugin) {
+        qCDebug(lcButeoCore) << "Plugin library" << libraryName << "was loaded concurrently";
+        delete plugin;
+        pluginLoader->unload();
+        delete pluginLoader;
+    }
+    return loadedPlugin;
 }
 
 QObject *PluginManager::acquireLoadedPlugin(const QString &libraryName)
 {
     QObject *plugin = nullptr;
 
+    // Plugins in use are only shared here, so readers do not block each
+    // other. Resident libraries have no plugin and are left to
+    // takePluginLoader().
+    iDllLock.lockForRead();
+    auto it = iLoadedDlls.constFind(libraryName);
+    if (it != iLoadedDlls.constEnd() && it->iLoadedPlugin) {
+        it->iRefCount.ref();
+        plugin = it->iLoadedPlugin;
+    }
+    iDllLock.unlock();
+
+    return plugin;
+}
+
+QPluginLoader *PluginManager::takePluginLoader(const QString &libraryName)
+{
+    QPluginLoader *pluginLoader = nullptr;
+
     iDllLock.lockForWrite();
-    for (int i = 0; i < iLoadedDlls.count(); ++i) {
-        if (iLoadedDlls[i].iPath == libraryName) {
-            iLoadedDlls[i].iRefCount++;
-            plugin = iLoadedDlls[i].iLoadedPlugin;
-            break;
+    auto it = iLoadedDlls.find(libraryName);
+    if (it != iLoadedDlls.end() && !it->iLoadedPlugin) {
+        qCDebug(lcButeoCore) << "Reusing resident plugin library" << libraryName;
+        pluginLoader = it->iPluginLoader;
+        if (iResidentDlls.removeOne(libraryName)) {
+            iResidentSize -= it->iSize;
         }
+        iLoadedDlls.erase(it);
     }
     iDllLock.unlock();
 
-    return plugin;
+    if (pluginLoader == nullptr) {
+        pluginLoader = new QPluginLoader(libraryName, this);
+    }
+    return pluginLoader;
 }
 
 void PluginManager::unloadPlugin(const QString &libraryName)
 {
+    // Read before locking, other threads should not wait for the file
+    const bool lowMemory = isMemoryLow();
+
     iDllLock.lockForWrite();
 
-    for (int i = 0; i < iLoadedDlls.count(); ++i) {
-        if (iLoadedDlls[i].iPath == libraryName && --iLoadedDlls[i].iRefCount == 0) {
-            DllInfo info = iLoadedDlls.takeAt(i);
-            info.cleanUp();
-            break;
+    auto it = iLoadedDlls.find(libraryName);
+    if (it != iLoadedDlls.end() && it->iLoadedPlugin && !it->iRefCount.deref()) {
+        if (iMaxResidentDlls > 0 && !lowMemory) {
+            // Only the plugin goes, the library stays loaded for the next one
+            delete it->iLoadedPlugin;
+            iResidentDlls.append(libraryName);
+            iResidentSize += it->iSize;
+            evictResidentPlugins();
+        } else {
+            it->cleanUp();
+            iLoadedDlls.erase(it);
         }
     }
 
     iDllLock.unlock();
 }
 
+void PluginManager::setPluginResidency(int aMaxIdleLibraries, qint64 aMaxIdleBytes)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iDllLock.lockForWrite();
+    iMaxResidentDlls = qMax(0, aMaxIdleLibraries);
+    iMaxResidentSize = qMax(Q_INT64_C(0), aMaxIdleBytes);
+    evictResidentPlugins();
+    iDllLock.unlock();
+}
+
+void PluginManager::evictResidentPlugins()
+{
+    // Called with iDllLock locked for writing
+    while (iResidentDlls.count() > iMaxResidentDlls
+            || (iMaxResidentSize > 0 && iResidentSize > iMaxResidentSize)) {
+        const QString libraryName = iResidentDlls.takeFirst();
+        qCDebug(lcButeoCore) << "Unloading resident plugin library" << libraryName;
+        DllInfo info = iLoadedDlls.take(libraryName);
+        iResidentSize -= info.iSize;
+        info.cleanUp();
+    }
+}
+
 void PluginManager::DllInfo::cleanUp()
 {
     delete iLoadedPlugin;
@@ -26,17 +26,26 @@
 
 #include <QString>
 #include <QMap>
+#include <QHash>
+#include <QAtomicInt>
 #include <QReadWriteLock>
 #include <QProcess>
 #include <QPointer>
+#include <QElapsedTimer>
+#include <QTimer>
 
 class QPluginLoader;
 class QProcess;
+class QDBusServiceWatcher;
 
 namespace Buteo {
 
 class StorageChangeNotifierPlugin;
 class StoragePlugin;
+class SyncPluginBase;
+class OOPProcessRegistry;
+class OOPPeerServer;
+class OOPResourcePolicy;
 class ClientPlugin;
 class ServerPlugin;
 class PluginCbInterface;
@@ -129,33 +138,178 @@ public:
      */
     void destroyServer(ServerPlugin *aPlugin);
 
+    /*! \brief Checks if an out-of-process plugin is still starting
+     *
+     * Out-of-process plugins are returned by createClient() and
+     * createServer() as soon as their process has been spawned. They can
+     * be used once the process has registered on D-Bus, which is
+     * reported with pluginStarted().
+     *
+     * @param aPlugin Plugin to check
+     * @return True if the plugin process has not registered yet
+     */
+    bool isPluginStarting(SyncPluginBase *aPlugin) const;
+
+    /*! \brief Kills the process of an out-of-process plugin
+     *
+     * Meant for plugins which no longer respond to abort requests. The
+     * plugin then reports an error once its process has exited.
+     *
+     * @param aPlugin Plugin whose process to kill
+     * @return True if the plugin runs out of process and was killed, false
+     *  for in-process plugins
+     */
+    bool killOOPPlugin(SyncPluginBase *aPlugin);
+
+    /*! \brief Sets the number of idle out-of-process plugin runners to keep
+     *
+     * Idle runners are started in advance and already connected to D-Bus.
+     * Starting an out-of-process plugin assigns it to an idle runner when
+     * one is available, and a replacement runner is started in the
+     * background. The pool is empty by default.
+     *
+     * @param aSize Number of idle runners, 0 disables the pool
+     */
+    void setOOPPoolSize(int aSize);
+
+    /*! \brief Records started plugin runners in a registry file
+     *
+     * Runners recorded in the file by a previous instance which are still
+     * alive are terminated first. Without a registry, runner processes are
+     * not tracked across restarts.
+     *
+     * @param aPath Registry file, preferably in the runtime directory
+     */
+    void setOOPProcessRegistry(const QString &aPath);
+
+    /*! \brief Talks to plugin runners over private D-Bus connections
+     *
+     * Starts a D-Bus server which the runners started from now on connect
+     * to. Calls and signals between msyncd and an attached runner then
+     * skip the session bus daemon. Runners which fail to attach keep using
+     * the session bus.
+     *
+     * @param aSocketDir Directory for the listening socket, preferably in
+     *  the runtime directory
+     */
+    void setOOPPeerServer(const QString &aSocketDir);
+
+    /*! \brief Keeps out-of-process plugins alive between sessions
+     *
+     * When a plugin is destroyed its runner process is kept on the bus
+     * for aIdleTimeout milliseconds, and the next plugin created for the
+     * same plugin and profile name reuses it. The least recently used
+     * runners are stopped when there are more than aMaxIdleRunners, and
+     * all idle runners are stopped when the system runs low on memory.
+     * Runners with a CPU time limit are never kept, as the limit covers
+     * all sessions of the process. Keep-alive is disabled by default.
+     *
+     * @param aIdleTimeout Idle time in milliseconds, 0 disables keep-alive
+     * @param aMaxIdleRunners Maximum number of idle runners
+     */
+    void setOOPKeepAlive(int aIdleTimeout, int aMaxIdleRunners);
+
+    /*! \brief Sets the default resource limits of out-of-process plugins
+     *
+     * Limits are applied to a runner when it is assigned to a plugin.
+     * The plugin_nice, plugin_io_priority, plugin_memory_limit,
+     * plugin_cpu_time_limit and plugin_cpu_quota keys of the profile
+     * override the defaults. A runner killed for exceeding its limits
+     * fails the session with SyncResults::PLUGIN_RESOURCE_LIMIT.
+     *
+     * @param aNice Nice value of the runners, 0 leaves it unchanged
+     * @param aMemoryLimit Memory limit in bytes, 0 for none
+     * @param aCgroupParent Delegated cgroup v2 directory under which each
+     *  runner gets its own group, empty to not use cgroups. Memory limits
+     *  only cap the resident set, and CPU quotas only work, with a group.
+     */
+    void setOOPResourceLimits(int aNice, qint64 aMemoryLimit, const QString &aCgroupParent);
+
+    /*! \brief Keeps in-process plugin libraries loaded when not in use
+     *
+     * When the last plugin created from a library is destroyed, the
+     * library stays loaded and the next plugin created from it skips
+     * loading and resolving the library again. The least recently used
+     * libraries are unloaded when there are more than aMaxIdleLibraries
+     * or their files take more than aMaxIdleBytes, and a library is
+     * unloaded right away when the system runs low on memory. Libraries
+     * are unloaded as soon as they are unused by default.
+     *
+     * @param aMaxIdleLibraries Maximum number of unused libraries to keep
+     *  loaded, 0 disables residency
+     * @param aMaxIdleBytes Maximum total file size of the unused libraries,
+     *  0 for no limit
+     */
+    void setPluginResidency(int aMaxIdleLibraries, qint64 aMaxIdleBytes);
+
+signals:
+    /*! \brief Emitted when an out-of-process plugin has finished starting
+     *
+     * @param aPlugin Plugin created by createClient() or createServer()
+     * @param aSuccess True if the plugin process registered on D-Bus, false
+     *  if it exited or did not register in time
+     */
+    void pluginStarted(Buteo::SyncPluginBase *aPlugin, bool aSuccess);
+
 protected slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
 
+    void evictIdleOOPRunners();
+
 private:
     class DllInfo
     {
     public:
         void cleanUp();
 
-        QString iPath;
-        QProcess *iHandle = nullptr;
         QPluginLoader *iPluginLoader = nullptr;
         QPointer<QObject> iLoadedPlugin;
-        int iRefCount = 0;
+        // Taken under the read lock, so updated atomically
+        mutable QAtomicInt iRefCount;
+        qint64 iSize = 0;
     };
 
-    void loadPluginMaps(const QString &pluginDirPath, const QString &aFilter, QMap<QString, QString> &aTargetMap);
+    void loadPluginMaps();
+
+    QProcess *startOOPPlugin(const QString &aPluginName, const QString &aProfileName, const QString &aPluginFilePath,
+                             const OOPResourcePolicy &aPolicy);
+
+    OOPResourcePolicy oopResourcePolicy(const Profile &aProfile) const;
+
+    void limitOOPProcess(QProcess *aProcess, const OOPResourcePolicy &aPolicy);
+
+    void stopOOPPlugin(QProcess *aProcess);
+
+    void releaseOOPPlugin(SyncPluginBase *aPlugin);
+
+    QProcess *takeIdleOOPRunner(const QString &aPluginName, const QString &aProfileName);
 
-    QProcess *startOOPPlugin(const QString &aPluginName, const QString &aProfileName, const QString &aPluginFilePath);
+    void watchOOPPlugin(QProcess *aProcess, SyncPluginBase *aPlugin);
 
-    void stopOOPPlugin(const QString &aPath);
+    void finishOOPPluginStart(QProcess *aProcess, bool aSuccess);
 
-    void addLoadedPlugin(const QString &libraryName,
-                         QPluginLoader *pluginLoader,
-                         QObject *plugin);
+    void cancelOOPPluginStart(SyncPluginBase *aPlugin);
+
+    void fillOOPPool();
+
+    QProcess *takeOOPPoolRunner(const QString &aPluginName, const QString &aProfileName,
+                                const QString &aPluginFilePath);
+
+    void removeOOPPoolRunner(QProcess *aProcess);
+
+    void trackOOPProcess(QProcess *aProcess);
+
+    void setOOPPeerEnvironment(QProcess *aProcess);
+
+    void useOOPPeerConnection(SyncPluginBase *aPlugin, const QString &aProfileName);
+
+    QObject *addLoadedPlugin(const QString &libraryName,
+                             QPluginLoader *pluginLoader,
+                             QObject *plugin);
     QObject *acquireLoadedPlugin(const QString &libraryName);
+    QPluginLoader *takePluginLoader(const QString &libraryName);
     void unloadPlugin(const QString &libraryName);
+    void evictResidentPlugins();
 
     QString iPluginPath;
 
@@ -167,7 +321,58 @@ private:
     QMap<QString, QString> iOopClientMaps;
     QMap<QString, QString> iOoPServerMaps;
 
-    QList<DllInfo> iLoadedDlls;
+    // library path -> loaded library, including the resident ones
+    QHash<QString, DllInfo> iLoadedDlls;
+
+    // Libraries kept loaded without a plugin instance, oldest first
+    QList<QString> iResidentDlls;
+    qint64 iResidentSize = 0;
+    int iMaxResidentDlls = 0;
+    qint64 iMaxResidentSize = 0;
+
+    // Out-of-process plugins waiting for their process to register on D-Bus
+    struct OOPLaunch {
+        QDBusServiceWatcher *iWatcher = nullptr;
+        SyncPluginBase *iPlugin = nullptr;
+        QString iProfileName;
+        QElapsedTimer iTimer;
+    };
+    QMap<QProcess *, OOPLaunch> iOOPLaunches;
+
+    // Idle out-of-process plugin runners
+    struct OOPPoolRunner {
+        QProcess *iProcess = nullptr;
+        QDBusServiceWatcher *iWatcher = nullptr;
+        QString iService;
+        bool iReady = false;
+    };
+    QList<OOPPoolRunner> iOOPPool;
+    int iOOPPoolSize = 0;
+    int iOOPPoolSerial = 0;
+
+    // Runner processes of the out-of-process plugins in use
+    QMap<SyncPluginBase *, QProcess *> iOOPPluginProcesses;
+
+    // Runners kept alive after their plugin was destroyed, oldest first
+    struct OOPIdleRunner {
+        QProcess *iProcess = nullptr;
+        QString iPluginName;
+        QString iProfileName;
+        QElapsedTimer iIdleSince;
+    };
+    QList<OOPIdleRunner> iOOPIdleRunners;
+    QTimer iOOPIdleTimer;
+    int iOOPKeepAlive = 0;
+    int iOOPMaxIdleRunners = 0;
+
+    OOPProcessRegistry *iProcessRegistry = nullptr;
+
+    OOPPeerServer *iPeerServer = nullptr;
+
+    // Default resource limits of plugin runners
+    int iOOPNice = 0;
+    qint64 iOOPMemoryLimit = 0;
+    QString iOOPCgroupParent;
 
     QReadWriteLock iDllLock;
 
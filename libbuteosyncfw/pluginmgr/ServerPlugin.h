@@ -56,6 +56,13 @@ public:
     /*! \brief Start listening for sync requests.
      *
      * Init must me called before this function.
+     *
+     * If the profile has a listen_endpoint key, msyncd opens the endpoint
+     * and only loads the plugin when a connection arrives. For a socket
+     * endpoint the listening socket is then in the listen_fd key of the
+     * profile, with the connection pending on it; the plugin accepts from
+     * it instead of opening the endpoint, and must not close it.
+     *
      * @return True on success, otherwise false
      */
     virtual bool startListen() = 0;
@@ -23,8 +23,35 @@
 
 #include "StorageItem.h"
 
+#include <QAbstractSocket>
+#include <QBuffer>
+#include <QLocalSocket>
+#include <QProcess>
+
 using namespace Buteo;
 
+// Amount of data passed to write() at a time by writeFrom()
+static const qint64 COPY_CHUNK_SIZE = 64 * 1024;
+
+// How long writeFrom() waits for more data from a sequential device
+static const int READ_TIMEOUT = 30000;
+
+// Checks if a sequential device will not deliver more data. Sockets
+// report atEnd() whenever nothing is buffered, so their state is used.
+static bool isEndOfStream(const QIODevice *aDevice)
+{
+    if (!aDevice->isOpen()) {
+        return true;
+    } else if (const QAbstractSocket *socket = qobject_cast<const QAbstractSocket *>(aDevice)) {
+        return socket->state() != QAbstractSocket::ConnectedState;
+    } else if (const QLocalSocket *socket = qobject_cast<const QLocalSocket *>(aDevice)) {
+        return socket->state() != QLocalSocket::ConnectedState;
+    } else if (const QProcess *process = qobject_cast<const QProcess *>(aDevice)) {
+        return process->state() == QProcess::NotRunning;
+    }
+    return aDevice->atEnd();
+}
+
 StorageItem::StorageItem()
 {
 }
@@ -72,3 +99,90 @@ const QString &StorageItem::getVersion() const
 {
     return iVersion;
 }
+
+QByteArray StorageItem::view(qint64 aOffset, qint64 aLength) const
+{
+    if (const StorageItemDataAccess *access = dynamic_cast<const StorageItemDataAccess *>(this)) {
+        return access->dataView(aOffset, aLength);
+    }
+
+    if (aLength < 0) {
+        aLength = getSize() - aOffset;
+    }
+
+    QByteArray data;
+    if (aOffset < 0 || aLength < 0 || !read(aOffset, aLength, data)) {
+        return QByteArray();
+    }
+    return data;
+}
+
+QIODevice *StorageItem::openReader() const
+{
+    if (const StorageItemDataAccess *access = dynamic_cast<const StorageItemDataAccess *>(this)) {
+        if (QIODevice *reader = access->openDataReader()) {
+            return reader;
+        }
+    }
+
+    const QByteArray data = view();
+    if (data.isNull() && getSize() > 0) {
+        return nullptr;
+    }
+
+    QBuffer *buffer = new QBuffer;
+    buffer->setData(data);
+    buffer->open(QIODevice::ReadOnly);
+    return buffer;
+}
+
+bool StorageItem::writeFrom(QIODevice *aDevice)
+{
+    if (!aDevice || !aDevice->isReadable() || !resize(0)) {
+        return false;
+    }
+
+    qint64 offset = 0;
+    forever {
+        // A buffer per chunk, as write() may keep a reference to it
+        QByteArray chunk(COPY_CHUNK_SIZE, Qt::Uninitialized);
+        const qint64 length = aDevice->read(chunk.data(), chunk.size());
+        if (length <= 0) {
+            if (!aDevice->isSequential()) {
+                if (length < 0) {
+                    return false;
+                }
+                break;
+            }
+
+            // A disconnected socket reports -1 once its buffer is empty
+            if (isEndOfStream(aDevice)) {
+                break;
+            } else if (length < 0) {
+                return false;
+            } else if (!aDevice->waitForReadyRead(READ_TIMEOUT) && !isEndOfStream(aDevice)) {
+                // Timed out before the end of the data
+                return false;
+            }
+            // Reads what arrived, or finds the end
+            continue;
+        }
+
+        chunk.resize(length);
+        if (!write(offset, chunk)) {
+            return false;
+        }
+        offset += length;
+    }
+
+    return true;
+}
+
+StorageItemDataAccess::~StorageItemDataAccess()
+{
+}
+
+QIODevice *StorageItemDataAccess::openDataReader() const
+{
+    return nullptr;
+}
@@ -27,6 +27,7 @@
 #include <QString>
 #include <QByteArray>
 
+class QIODevice;
 
 namespace Buteo {
 
@@ -124,6 +125,42 @@ public:
      */
     virtual qint64 getSize() const = 0;
 
+    /*! \brief Returns (part of) the item data without copying it
+     *
+     * Items implementing StorageItemDataAccess serve this from
+     * StorageItemDataAccess::dataView(), otherwise the data is copied with
+     * read(). The returned data is valid until the item is modified or
+     * destroyed.
+     *
+     * @param aOffset The offset in bytes from where the data is returned
+     * @param aLength The number of bytes to return, -1 for all after aOffset
+     * @return Item data, null on failure
+     */
+    QByteArray view(qint64 aOffset = 0, qint64 aLength = -1) const;
+
+    /*! \brief Opens the item data for reading as a stream
+     *
+     * Returns the device from StorageItemDataAccess::openDataReader() if
+     * the item has one, otherwise a buffer over view().
+     *
+     * @return Open device owned by the caller, NULL on failure
+     */
+    QIODevice *openReader() const;
+
+    /*! \brief Replaces the item data with the contents of a device
+     *
+     * The device is read until its end. A sequential device is waited on
+     * until it is closed, or for sockets and processes until they
+     * disconnect or exit. The data is passed to write() in chunks, so it is
+     * never held in memory at once. If reading or writing fails, the item
+     * is left with the data written so far.
+     *
+     * @param aDevice Device open for reading
+     * @return True on success, false if the data could not be read up to
+     *  its end or written
+     */
+    bool writeFrom(QIODevice *aDevice);
+
 private:
     QString iId;
     QString iParentId;
@@ -131,6 +168,41 @@ private:
     QString iVersion;
 };
 
+/*! \brief Interface for storage items with direct access to their data
+ *
+ * A storage item implements this next to StorageItem to serve
+ * StorageItem::view() and StorageItem::openReader() without copying.
+ * Items that keep their data in memory can return their implicitly
+ * shared buffer, and items backed by a file can return
+ * QByteArray::fromRawData() over a mapping of the file. It is not part of
+ * StorageItem itself to keep plugins built against earlier versions of
+ * the library working.
+ */
+class StorageItemDataAccess
+{
+public:
+    //! \brief Destructor
+    virtual ~StorageItemDataAccess();
+
+    /*! \brief Returns (part of) the item data for StorageItem::view()
+     *
+     * @param aOffset The offset in bytes from where the data is returned
+     * @param aLength The number of bytes to return, -1 for all after aOffset
+     * @return Item data, null on failure
+     */
+    virtual QByteArray dataView(qint64 aOffset, qint64 aLength) const = 0;
+
+    /*! \brief Opens the item data for StorageItem::openReader()
+     *
+     * Items backed by a file can return the file itself. The default
+     * implementation returns NULL.
+     *
+     * @return Open device owned by the caller, NULL to read from a buffer
+     *  over dataView()
+     */
+    virtual QIODevice *openDataReader() const;
+};
+
 }
 
 #endif
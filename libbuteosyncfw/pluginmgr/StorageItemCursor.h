@@ -0,0 +1,114 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef STORAGEITEMCURSOR_H
+#define STORAGEITEMCURSOR_H
+
+#include "StoragePlugin.h"
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+
+namespace Buteo {
+
+class StorageItem;
+
+/*! \brief Walks through the items of a storage in batches
+ *
+ * Cursors are opened with StoragePlugin::openCursor(). Unlike
+ * StoragePlugin::getAllItems() and friends, only one batch of items needs
+ * to be in memory at a time. Item ids and items can be fetched from the
+ * same cursor, both advance it.
+ */
+class StorageItemCursor
+{
+public:
+    //! \brief Destructor
+    virtual ~StorageItemCursor();
+
+    /*! \brief Returns the ids of the next items
+     *
+     * @param aBatchSize Maximum number of ids to return
+     * @param aItemIds Replaced with the ids, empty at the end
+     * @return True on success, otherwise false
+     */
+    virtual bool nextItemIds(int aBatchSize, QList<QString> &aItemIds) = 0;
+
+    /*! \brief Returns the next items
+     *
+     * Not supported by cursors over deleted items, which only have ids.
+     *
+     * @param aBatchSize Maximum number of items to return
+     * @param aItems Replaced with the items, empty at the end. The caller
+     *  owns the items.
+     * @return True on success, otherwise false
+     */
+    virtual bool nextItems(int aBatchSize, QList<StorageItem *> &aItems) = 0;
+
+    /*! \brief Checks if all items have been returned
+     *
+     * @return True if the next batch would be empty
+     */
+    virtual bool atEnd() const = 0;
+
+    /*! \brief Returns a token for continuing the enumeration later
+     *
+     * Passing the token to StoragePlugin::openCursor() opens a cursor that
+     * starts after the items returned so far, for example when a sync is
+     * resumed.
+     *
+     * @return Opaque token
+     */
+    virtual QString resumeToken() const = 0;
+};
+
+/*! \brief Interface for storage plugins with their own cursors
+ *
+ * A storage plugin implements this next to StoragePlugin, and declares it
+ * with Q_INTERFACES(Buteo::StorageCursorProvider), to serve
+ * StoragePlugin::openCursor() from its backend. It is not part of
+ * StoragePlugin itself to keep plugins built against earlier versions of
+ * the library working.
+ */
+class StorageCursorProvider
+{
+public:
+    //! \brief Destructor
+    virtual ~StorageCursorProvider();
+
+    /*! \brief Creates a cursor for StoragePlugin::openCursor()
+     *
+     * @param aSet Items to walk through
+     * @param aTime Time for the new, modified and deleted item sets
+     * @param aResumeToken Token from StorageItemCursor::resumeToken(), or
+     *  empty to start from the first item
+     * @return Cursor owned by the caller, NULL if the token is not valid
+     */
+    virtual StorageItemCursor *createCursor(StoragePlugin::ItemSet aSet, const QDateTime &aTime,
+                                            const QString &aResumeToken) = 0;
+};
+
+}
+
+Q_DECLARE_INTERFACE(Buteo::StorageCursorProvider, "com.buteo.msyncd.StorageCursorProvider/1.0")
+
+#endif // STORAGEITEMCURSOR_H
@@ -22,9 +22,102 @@
  */
 
 #include "StoragePlugin.h"
+#include "StorageItemCursor.h"
 
 using namespace Buteo;
 
+namespace {
+
+// Serves a cursor from the list based methods of a plugin
+class ListItemCursor : public StorageItemCursor
+{
+public:
+    ListItemCursor(StoragePlugin *aPlugin, StoragePlugin::ItemSet aSet,
+                   const QDateTime &aTime, int aPosition)
+        : iPlugin(aPlugin)
+        , iSet(aSet)
+        , iTime(aTime)
+        , iPosition(aPosition)
+        , iFetched(false)
+    {
+    }
+
+    bool nextItemIds(int aBatchSize, QList<QString> &aItemIds) override
+    {
+        aItemIds.clear();
+        if (!fetch()) {
+            return false;
+        }
+
+        aItemIds = iItemIds.mid(iPosition, qMax(0, aBatchSize));
+        iPosition += aItemIds.count();
+        return true;
+    }
+
+    bool nextItems(int aBatchSize, QList<StorageItem *> &aItems) override
+    {
+        aItems.clear();
+        if (iSet == StoragePlugin::DELETED_ITEMS) {
+            return false;
+        }
+
+        QList<QString> itemIds;
+        if (!nextItemIds(aBatchSize, itemIds)) {
+            return false;
+        }
+        if (!itemIds.isEmpty()) {
+            aItems = iPlugin->getItems(itemIds);
+        }
+        return true;
+    }
+
+    bool atEnd() const override
+    {
+        return iFetched && iPosition >= iItemIds.count();
+    }
+
+    QString resumeToken() const override
+    {
+        return QString::number(iPosition);
+    }
+
+private:
+    bool fetch()
+    {
+        if (iFetched) {
+            return true;
+        }
+
+        bool success = false;
+        switch (iSet) {
+        case StoragePlugin::ALL_ITEMS:
+            success = iPlugin->getAllItemIds(iItemIds);
+            break;
+        case StoragePlugin::NEW_ITEMS:
+            success = iPlugin->getNewItemIds(iItemIds, iTime);
+            break;
+        case StoragePlugin::MODIFIED_ITEMS:
+            success = iPlugin->getModifiedItemIds(iItemIds, iTime);
+            break;
+        case StoragePlugin::DELETED_ITEMS:
+            success = iPlugin->getDeletedItemIds(iItemIds, iTime);
+            break;
+        }
+
+        iFetched = success;
+        return success;
+    }
+
+    StoragePlugin *iPlugin;
+    StoragePlugin::ItemSet iSet;
+    QDateTime iTime;
+    QList<QString> iItemIds;
+    int iPosition;
+    bool iFetched;
+};
+
+}
+
 StoragePlugin::StoragePlugin(const QString &aPluginName)
     : iPluginName(aPluginName)
 {
@@ -53,3 +146,22 @@ void StoragePlugin::getProperties(QMap<QString, QString> &aProperties) const
 {
     aProperties = iProperties;
 }
+
+StorageItemCursor *StoragePlugin::openCursor(ItemSet aSet, const QDateTime &aTime,
+                                             const QString &aResumeToken)
+{
+    if (StorageCursorProvider *provider = qobject_cast<StorageCursorProvider *>(this)) {
+        return provider->createCursor(aSet, aTime, aResumeToken);
+    }
+
+    int position = 0;
+    if (!aResumeToken.isEmpty()) {
+        bool ok = false;
+        position = aResumeToken.toInt(&ok);
+        if (!ok || position < 0) {
+            return nullptr;
+        }
+    }
+
+    return new ListItemCursor(this, aSet, aTime, position);
+}
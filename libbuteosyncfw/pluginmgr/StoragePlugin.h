@@ -31,6 +31,7 @@
 namespace Buteo {
 
 class StorageItem;
+class StorageItemCursor;
 
 /*! \brief Base class for storage plugins
  *
@@ -53,6 +54,16 @@ public:
         STATUS_OK = 0                /*!< Operation was completed successfully*/
     };
 
+    /*! \brief Set of items walked through by a cursor
+     *
+     */
+    enum ItemSet {
+        ALL_ITEMS,      /*!< All known items, @see getAllItemIds */
+        NEW_ITEMS,      /*!< Items created after a time, @see getNewItemIds */
+        MODIFIED_ITEMS, /*!< Items modified after a time, @see getModifiedItemIds */
+        DELETED_ITEMS   /*!< Items deleted after a time, ids only, @see getDeletedItemIds */
+    };
+
     /*! \brief Constructor
      *
      * @param aPluginName Name of this storage plugin
@@ -228,6 +239,27 @@ public:
      */
     virtual QList<OperationStatus> deleteItems(const QList<QString> &aItemIds) = 0;
 
+    /*! \brief Opens a cursor for walking through items in batches
+     *
+     * Plugins which can query their backend in batches implement
+     * StorageCursorProvider, and the call is passed to it. Otherwise the
+     * cursor gets the item ids with getAllItemIds(), getNewItemIds(),
+     * getModifiedItemIds() or getDeletedItemIds() when the first batch is
+     * requested, and the items of each batch with getItems(). The whole id
+     * list is then held in memory for the lifetime of the cursor, only the
+     * items are created a batch at a time. Its resume tokens are positions
+     * in the id list, so they stay valid only while the set of items does
+     * not change.
+     *
+     * @param aSet Items to walk through
+     * @param aTime Time for the new, modified and deleted item sets
+     * @param aResumeToken Token from StorageItemCursor::resumeToken(), or
+     *  empty to start from the first item
+     * @return Cursor owned by the caller, NULL if the token is not valid
+     */
+    StorageItemCursor *openCursor(ItemSet aSet, const QDateTime &aTime = QDateTime(),
+                                  const QString &aResumeToken = QString());
+
 protected:
     //! Name of the plugin
     QString iPluginName;
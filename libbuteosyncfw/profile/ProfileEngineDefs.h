@@ -110,6 +110,16 @@ const QString KEY_HTTP_PROXY_HOST("http_proxy_host");
 const QString KEY_HTTP_PROXY_PORT("http_proxy_port");
 const QString KEY_PROFILE_ID("profile_id");
 const QString KEY_INTERNET_CONNECTION_TYPES("internet_connection_types");
+const QString KEY_PLUGIN_NICE("plugin_nice");
+const QString KEY_PLUGIN_IO_PRIORITY("plugin_io_priority");
+const QString KEY_PLUGIN_MEMORY_LIMIT("plugin_memory_limit"); // MiB
+const QString KEY_PLUGIN_CPU_TIME_LIMIT("plugin_cpu_time_limit"); // seconds
+const QString KEY_PLUGIN_CPU_QUOTA("plugin_cpu_quota"); // percent of one CPU
+const QString KEY_PROGRESS_TIMEOUT("progress_timeout"); // seconds
+const QString KEY_LISTEN_ENDPOINT("listen_endpoint");
+const QString KEY_LISTEN_IDLE_TIMEOUT("listen_idle_timeout"); // seconds
+const QString KEY_LISTEN_FD("listen_fd"); // set by msyncd, see ServerPlugin::startListen()
+const QString KEY_LISTEN_SERVICE_UUID("listen_service_uuid");
 
 const QString BOOLEAN_TRUE("true");
 const QString BOOLEAN_FALSE("false");
@@ -27,12 +27,16 @@
 #include <QFile>
 #include <QTextStream>
 #include <QDomDocument>
+#include <QSettings>
+#include <QCoreApplication>
 
 #include "ProfileFactory.h"
 #include "ProfileEngineDefs.h"
 #include "SyncCommonDefs.h"
 
 #include "LogMacros.h"
+#include "Metrics.h"
+#include "TraceRecorder.h"
 #include "BtHelper.h"
 
 // implement here in lack of better place. not sure should this even be included in the api
@@ -54,6 +58,12 @@ static const QString FORMAT_EXT = ".xml";
 static const QString BACKUP_EXT = ".bak";
 static const QString LOG_EXT = ".log";
 static const QString LOG_DIRECTORY = "logs";
+static const QString RETRIES_FILE = "retries.ini";
+static const QString RETRIES_ATTEMPT_KEY = "attempt";
+
+// Bounds for the randomized retry delay, in seconds.
+static const qint64 MIN_RETRY_DELAY = 60;
+static const qint64 MAX_RETRY_DELAY = 6 * 60 * 60;
 static const QString BT_PROFILE_TEMPLATE("bt_template");
 
 static const QString DEFAULT_PRIMARY_PROFILE_PATH = Sync::syncConfigDir();
@@ -96,9 +106,21 @@ public:
     bool remove(const QString &aName, const QString &aType);
     bool profileExists(const QString &aProfileId, const QString &aType);
 
+    /*! \brief Loads the retry attempt counts saved by an earlier instance.
+     */
+    void loadRetries();
+
+    /*! \brief Saves the retry attempt counts.
+     */
+    void saveRetries();
+
     QString iConfigPath;
     QString iSystemConfigPath;
-    QHash<QString, QList<quint32> > iSyncRetriesInfo;
+
+    // Number of failed retry attempts per profile, for profiles having
+    // retries in progress.
+    QHash<QString, int> iSyncRetriesInfo;
+    bool iSyncRetriesLoaded;
 };
 
 }
@@ -108,11 +130,15 @@ using namespace Buteo;
 ProfileManagerPrivate::ProfileManagerPrivate()
     : iConfigPath(DEFAULT_PRIMARY_PROFILE_PATH)
     , iSystemConfigPath(DEFAULT_SECONDARY_PROFILE_PATH)
+    , iSyncRetriesLoaded(false)
 {
 }
 
 Profile *ProfileManagerPrivate::load(const QString &aName, const QString &aType)
 {
+    TraceScope traceScope("ProfileManager::load", "profile", aName);
+    MetricsTimer loadTimer(Metrics::instance()->histogram(QStringLiteral("msyncd_profile_load_ms")));
+
     QString profilePath = findProfileFile(aName, aType);
     QString backupProfilePath = profilePath + BACKUP_EXT;
 
@@ -611,6 +637,9 @@ bool ProfileManagerPrivate::save(const Profile &aProfile)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    TraceScope traceScope("ProfileManager::save", "profile", aProfile.name());
+    MetricsTimer saveTimer(Metrics::instance()->histogram(QStringLiteral("msyncd_profile_save_ms")));
+
     QDomDocument doc = constructProfileDocument(aProfile);
     if (doc.isNull()) {
         qCWarning(lcButeoCore) << "No profile data to write";
@@ -801,6 +830,10 @@ bool ProfileManager::removeProfile(const QString &aProfileId)
     if (profile) {
         success = d_ptr->remove(aProfileId, profile->type());
         if (success) {
+            d_ptr->loadRetries();
+            if (d_ptr->iSyncRetriesInfo.remove(aProfileId)) {
+                d_ptr->saveRetries();
+            }
             emit signalProfileChanged(aProfileId, ProfileManager::PROFILE_REMOVED, QString(""));
         }
         delete profile;
@@ -1115,36 +1148,120 @@ bool ProfileManagerPrivate::profileExists(const QString &aProfileId, const QStri
     return QFile::exists(profileFile);
 }
 
+void ProfileManagerPrivate::loadRetries()
+{
+    if (iSyncRetriesLoaded) {
+        return;
+    }
+    iSyncRetriesLoaded = true;
+
+    QSettings settings(iConfigPath + QDir::separator() + Profile::TYPE_SYNC
+                       + QDir::separator() + RETRIES_FILE, QSettings::IniFormat);
+    foreach (const QString &profileName, settings.childGroups()) {
+        settings.beginGroup(profileName);
+        iSyncRetriesInfo.insert(profileName, settings.value(RETRIES_ATTEMPT_KEY, 0).toInt());
+        settings.endGroup();
+    }
+}
+
+void ProfileManagerPrivate::saveRetries()
+{
+    QSettings settings(iConfigPath + QDir::separator() + Profile::TYPE_SYNC
+                       + QDir::separator() + RETRIES_FILE, QSettings::IniFormat);
+    settings.clear();
+    QHash<QString, int>::const_iterator i;
+    for (i = iSyncRetriesInfo.constBegin(); i != iSyncRetriesInfo.constEnd(); ++i) {
+        settings.beginGroup(i.key());
+        settings.setValue(RETRIES_ATTEMPT_KEY, i.value());
+        settings.endGroup();
+    }
+    settings.sync();
+    if (settings.status() != QSettings::NoError) {
+        qCWarning(lcButeoCore) << "syncretries : failed to save retry state";
+    }
+}
+
 void ProfileManager::addRetriesInfo(const SyncProfile *profile)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+    d_ptr->loadRetries();
     if (profile) {
         if (profile->hasRetries() && !d_ptr->iSyncRetriesInfo.contains(profile->name())) {
             qCDebug(lcButeoCore) << "syncretries : retries info present for profile" << profile->name();
-            d_ptr->iSyncRetriesInfo[profile->name()] = profile->retryIntervals();
+            // Not saved until an attempt fails, as most syncs succeed.
+            d_ptr->iSyncRetriesInfo[profile->name()] = 0;
         }
     }
 }
 
 QDateTime ProfileManager::getNextRetryInterval(const SyncProfile *aProfile)
+{
+    return getNextRetryInterval(aProfile, SyncResults::NO_ERROR);
+}
+
+QDateTime ProfileManager::getNextRetryInterval(const SyncProfile *aProfile,
+                                               SyncResults::MinorCode aErrorCode)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+    d_ptr->loadRetries();
     QDateTime nextRetryInterval;
-    if (aProfile && d_ptr->iSyncRetriesInfo.contains(aProfile->name())
-        && !d_ptr->iSyncRetriesInfo[aProfile->name()].isEmpty()) {
-        quint32 mins = d_ptr->iSyncRetriesInfo[aProfile->name()].takeFirst();
-        nextRetryInterval = QDateTime::currentDateTime().addSecs(mins * 60);
-        qCDebug(lcButeoCore) << "syncretries : retry for profile" << aProfile->name() << "in" << mins << "minutes";
-        qCDebug(lcButeoCore) << "syncretries :" << d_ptr->iSyncRetriesInfo[aProfile->name()].count() << "attempts remain";
+    if (!aProfile || !d_ptr->iSyncRetriesInfo.contains(aProfile->name())) {
+        return nextRetryInterval;
+    }
+
+    const QList<quint32> intervals = aProfile->retryIntervals();
+    int attempt = d_ptr->iSyncRetriesInfo.value(aProfile->name());
+    int factor = 1;
+
+    switch (aErrorCode) {
+    case SyncResults::AUTHENTICATION_FAILURE:
+    case SyncResults::UNSUPPORTED_SYNC_TYPE:
+    case SyncResults::UNSUPPORTED_STORAGE_TYPE:
+        // Retrying does not help, user or configuration action is needed.
+        qCDebug(lcButeoCore) << "syncretries : no retry for profile" << aProfile->name()
+                             << "after error" << aErrorCode;
+        return nextRetryInterval;
+    case SyncResults::CONNECTION_ERROR:
+        // Likely an overloaded server or a flaky network, give it more room.
+        factor = 2;
+        break;
+    default:
+        break;
     }
+
+    if (attempt >= intervals.count()) {
+        return nextRetryInterval;
+    }
+
+    // Exponential bound, full jitter below it.
+    qint64 bound = qMax<qint64>(intervals.at(attempt), qint64(intervals.first()) << attempt) * 60 * factor;
+    bound = qBound(MIN_RETRY_DELAY, bound, MAX_RETRY_DELAY);
+
+    // qrand() keeps its state per thread
+    static thread_local bool seeded = false;
+    if (!seeded) {
+        qsrand(uint(QDateTime::currentMSecsSinceEpoch()) ^ uint(QCoreApplication::applicationPid()));
+        seeded = true;
+    }
+    qint64 delay = MIN_RETRY_DELAY + qint64((bound - MIN_RETRY_DELAY) * (qrand() / double(RAND_MAX)));
+
+    d_ptr->iSyncRetriesInfo[aProfile->name()] = attempt + 1;
+    d_ptr->saveRetries();
+
+    nextRetryInterval = QDateTime::currentDateTime().addSecs(delay);
+    qCDebug(lcButeoCore) << "syncretries : retry for profile" << aProfile->name() << "in" << delay << "seconds";
+    qCDebug(lcButeoCore) << "syncretries :" << intervals.count() - attempt - 1 << "attempts remain";
     return nextRetryInterval;
 }
 
 void ProfileManager::retriesDone(const QString &aProfileName)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+    d_ptr->loadRetries();
     if (d_ptr->iSyncRetriesInfo.contains(aProfileName)) {
-        d_ptr->iSyncRetriesInfo.remove(aProfileName);
+        if (d_ptr->iSyncRetriesInfo.take(aProfileName) > 0) {
+            d_ptr->saveRetries();
+        }
         qCDebug(lcButeoCore) << "syncretries : retry success for" << aProfileName;
     }
 }
@@ -25,6 +25,7 @@
 #define PROFILEMANAGER_H
 
 #include "SyncProfile.h"
+#include "SyncResults.h"
 #include "Profile.h"
 
 #include <QObject>
@@ -321,6 +322,25 @@ public:
      */
     QDateTime getNextRetryInterval(const SyncProfile *aProfile);
 
+    /*! \brief gets the next retry after time for a sync profile which failed
+     * with the given error
+     *
+     * The delay is picked randomly between one minute and an upper bound, so
+     * that devices do not retry in lock-step when a service goes down. The
+     * bound starts from the first retry interval of the profile and doubles
+     * with every failed attempt. The profile interval of the attempt is a
+     * floor for the bound, and the bound is capped at six hours. Connection
+     * errors double the bound, as they are often caused by an overloaded
+     * server. Errors which a retry cannot fix, like authentication failures,
+     * are not retried at all. Attempt counts are saved, so the backoff
+     * continues where it left if msyncd is restarted.
+     *
+     * @param aProfile sync profile
+     * @param aErrorCode reason of the failure
+     * @return next retry time, invalid if no retry should be done
+     */
+    QDateTime getNextRetryInterval(const SyncProfile *aProfile, SyncResults::MinorCode aErrorCode);
+
     /*! \brief call this to indicate that retries have to stop for a certain
      * sync for a profile - either the no. of retry attempts exhausted or one of the retries succeeded
      *
@@ -24,6 +24,8 @@
 #include "LogMacros.h"
 #include "ProfileEngineDefs.h"
 
+#include <QDBusArgument>
+#include <QDBusMetaType>
 #include <QDomDocument>
 
 namespace Buteo {
@@ -76,6 +78,9 @@ SyncResultsPrivate::SyncResultsPrivate(const SyncResultsPrivate &aSource)
 
 using namespace Buteo;
 
+//! Marshalled in place of an invalid sync time
+static const qint64 INVALID_TIME = -1;
+
 SyncResults::SyncResults()
     : d_ptr(new SyncResultsPrivate())
 {
@@ -220,3 +225,44 @@ bool SyncResults::isScheduled() const
 {
     return d_ptr->iScheduled;
 }
+
+void SyncResults::registerDBusTypes()
+{
+    TargetResults::registerDBusTypes();
+    qDBusRegisterMetaType<SyncResults>();
+}
+
+QDBusArgument &Buteo::operator<<(QDBusArgument &aArgument, const SyncResults &aResults)
+{
+    const SyncResultsPrivate *d = aResults.d_ptr.data();
+
+    aArgument.beginStructure();
+    // Milliseconds since the epoch, the ISO 8601 form would drop them
+    aArgument << (d->iTime.isValid() ? d->iTime.toMSecsSinceEpoch() : INVALID_TIME)
+              << static_cast<int>(d->iMajorCode)
+              << static_cast<int>(d->iMinorCode)
+              << d->iTargetId
+              << d->iScheduled
+              << d->iTargetResults;
+    aArgument.endStructure();
+    return aArgument;
+}
+
+const QDBusArgument &Buteo::operator>>(const QDBusArgument &aArgument, SyncResults &aResults)
+{
+    // Results are shared on assignment, so unmarshal into a fresh copy
+    QSharedPointer<SyncResultsPrivate> d(new SyncResultsPrivate());
+    qint64 time = INVALID_TIME;
+    int majorCode = SyncResults::SYNC_RESULT_INVALID;
+    int minorCode = SyncResults::NO_ERROR;
+
+    aArgument.beginStructure();
+    aArgument >> time >> majorCode >> minorCode >> d->iTargetId >> d->iScheduled >> d->iTargetResults;
+    aArgument.endStructure();
+
+    d->iTime = time != INVALID_TIME ? QDateTime::fromMSecsSinceEpoch(time) : QDateTime();
+    d->iMajorCode = static_cast<SyncResults::MajorCode>(majorCode);
+    d->iMinorCode = static_cast<SyncResults::MinorCode>(minorCode);
+    aResults.d_ptr = d;
+    return aArgument;
+}
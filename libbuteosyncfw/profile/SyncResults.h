@@ -30,6 +30,7 @@
 #include <QVariantList>
 #include "TargetResults.h"
 
+class QDBusArgument;
 class QDomDocument;
 class QDomElement;
 
@@ -103,6 +104,8 @@ public:
         DATABASE_FAILURE,
         PLUGIN_ERROR,
         PLUGIN_TIMEOUT,
+        PLUGIN_RESOURCE_LIMIT,
+        PLUGIN_STALLED,
 
         // Server/Network errors 5xx
         ABORTED = 501,
@@ -243,15 +246,37 @@ public:
      */
     bool isScheduled() const;
 
+    /*! \brief Registers SyncResults and TargetResults for use in D-Bus calls.
+     *
+     * Must be called in both processes before the types are sent or
+     * received over D-Bus.
+     */
+    static void registerDBusTypes();
+
 private:
     QVariantList variantTargetResults() const;
     QSharedPointer<SyncResultsPrivate> d_ptr;
 
+    friend QDBusArgument &operator<<(QDBusArgument &aArgument, const SyncResults &aResults);
+    friend const QDBusArgument &operator>>(const QDBusArgument &aArgument, SyncResults &aResults);
+
 #ifdef SYNCFW_UNIT_TESTS
     friend class ClientThreadTest;
 #endif
 };
 
+/*! \brief Marshals sync results to D-Bus.
+ *
+ * The D-Bus signature is (xiisba(...)): the sync time in milliseconds
+ * since the epoch (-1 when invalid), the major and minor codes, the target
+ * id, the scheduled flag and the target results. Unlike the XML form, no document has to be built or
+ * parsed.
+ */
+QDBusArgument &operator<<(QDBusArgument &aArgument, const SyncResults &aResults);
+
+//! \brief Unmarshals sync results from D-Bus.
+const QDBusArgument &operator>>(const QDBusArgument &aArgument, SyncResults &aResults);
+
 }
 
 Q_DECLARE_METATYPE(Buteo::SyncResults)
@@ -25,6 +25,8 @@
 #include "ProfileEngineDefs.h"
 #include "LogMacros.h"
 
+#include <QDBusArgument>
+#include <QDBusMetaType>
 #include <QDomDocument>
 
 namespace Buteo {
@@ -100,6 +102,30 @@ struct ItemDetails
     }
 };
 
+QDBusArgument &operator<<(QDBusArgument &aArgument, const ItemDetails &aDetails)
+{
+    aArgument.beginStructure();
+    aArgument << aDetails.uid << static_cast<int>(aDetails.status) << aDetails.message;
+    aArgument.endStructure();
+    return aArgument;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &aArgument, ItemDetails &aDetails)
+{
+    int status = TargetResults::ITEM_OPERATION_SUCCEEDED;
+    aArgument.beginStructure();
+    aArgument >> aDetails.uid >> status >> aDetails.message;
+    aArgument.endStructure();
+    aDetails.status = static_cast<TargetResults::ItemOperationStatus>(status);
+    return aArgument;
+}
+
+}
+
+Q_DECLARE_METATYPE(Buteo::ItemDetails)
+
+namespace Buteo {
+
 // Private implementation class for TargetResults
 class TargetResultsPrivate
 {
@@ -367,3 +393,59 @@ QString TargetResults::remoteMessage(const QString &aUid) const
     }
     return QString();
 }
+
+void TargetResults::registerDBusTypes()
+{
+    qDBusRegisterMetaType<ItemDetails>();
+    qDBusRegisterMetaType<TargetResults>();
+}
+
+static void marshallItems(QDBusArgument &aArgument, const ItemCounts &aCounts,
+                          const QList<ItemDetails> &aAdditions,
+                          const QList<ItemDetails> &aDeletions,
+                          const QList<ItemDetails> &aModifications)
+{
+    aArgument.beginStructure();
+    aArgument << aCounts.added << aCounts.deleted << aCounts.modified;
+    aArgument.endStructure();
+    aArgument << aAdditions << aDeletions << aModifications;
+}
+
+static void unmarshallItems(const QDBusArgument &aArgument, ItemCounts &aCounts,
+                            QList<ItemDetails> &aAdditions,
+                            QList<ItemDetails> &aDeletions,
+                            QList<ItemDetails> &aModifications)
+{
+    aArgument.beginStructure();
+    aArgument >> aCounts.added >> aCounts.deleted >> aCounts.modified;
+    aArgument.endStructure();
+    aArgument >> aAdditions >> aDeletions >> aModifications;
+}
+
+QDBusArgument &Buteo::operator<<(QDBusArgument &aArgument, const TargetResults &aResults)
+{
+    const TargetResultsPrivate *d = aResults.d_ptr;
+
+    aArgument.beginStructure();
+    aArgument << d->iTargetName;
+    marshallItems(aArgument, d->iLocalItems, d->iLocalAdditions,
+                  d->iLocalDeletions, d->iLocalModifications);
+    marshallItems(aArgument, d->iRemoteItems, d->iRemoteAdditions,
+                  d->iRemoteDeletions, d->iRemoteModifications);
+    aArgument.endStructure();
+    return aArgument;
+}
+
+const QDBusArgument &Buteo::operator>>(const QDBusArgument &aArgument, TargetResults &aResults)
+{
+    TargetResultsPrivate *d = aResults.d_ptr;
+
+    aArgument.beginStructure();
+    aArgument >> d->iTargetName;
+    unmarshallItems(aArgument, d->iLocalItems, d->iLocalAdditions,
+                    d->iLocalDeletions, d->iLocalModifications);
+    unmarshallItems(aArgument, d->iRemoteItems, d->iRemoteAdditions,
+                    d->iRemoteDeletions, d->iRemoteModifications);
+    aArgument.endStructure();
+    return aArgument;
+}
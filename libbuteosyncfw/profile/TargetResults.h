@@ -27,6 +27,7 @@
 #include <QList>
 #include <QObject>
 
+class QDBusArgument;
 class QDomDocument;
 class QDomElement;
 
@@ -227,6 +228,13 @@ public:
      */
     Q_INVOKABLE QString remoteMessage(const QString &aUid) const;
 
+    /*! \brief Registers TargetResults for use in D-Bus calls.
+     *
+     * Must be called in both processes before the type is sent or
+     * received over D-Bus.
+     */
+    static void registerDBusTypes();
+
 private:
     QStringList localAdditions() const { return localDetails(ITEM_ADDED, ITEM_OPERATION_SUCCEEDED); }
     QStringList localDeletions() const { return localDetails(ITEM_DELETED, ITEM_OPERATION_SUCCEEDED); }
@@ -248,8 +256,22 @@ private:
     }
 
     TargetResultsPrivate *d_ptr;
+
+    friend QDBusArgument &operator<<(QDBusArgument &aArgument, const TargetResults &aResults);
+    friend const QDBusArgument &operator>>(const QDBusArgument &aArgument, TargetResults &aResults);
 };
 
+/*! \brief Marshals target results, including the item details, to D-Bus.
+ *
+ * The D-Bus signature is (s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis)):
+ * the target name, then the local and the remote item counts each followed
+ * by the added, deleted and modified item details.
+ */
+QDBusArgument &operator<<(QDBusArgument &aArgument, const TargetResults &aResults);
+
+//! \brief Unmarshals target results from D-Bus.
+const QDBusArgument &operator>>(const QDBusArgument &aArgument, TargetResults &aResults);
+
 }
 
 Q_DECLARE_METATYPE(Buteo::ItemCounts)
@@ -0,0 +1,208 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "AccountSyncIndex.h"
+#include "SyncProfile.h"
+#include "SyncResults.h"
+#include "ProfileEngineDefs.h"
+#include "LogMacros.h"
+
+using namespace Buteo;
+
+void AccountSyncIndex::updateProfile(const SyncProfile &aProfile)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QString name = aProfile.name();
+    bool ok = false;
+    unsigned int accountId = aProfile.key(KEY_ACCOUNT_ID).toUInt(&ok);
+    if (!ok) {
+        removeProfile(name);
+        return;
+    }
+
+    ProfileEntry entry;
+    if (iProfiles.contains(name)) {
+        entry = iProfiles.value(name);
+        if (entry.iAccountId != accountId) {
+            // Account changed, move the profile including its state.
+            removeProfile(name);
+            entry.iAccountId = accountId;
+            iAccounts[accountId].iProfiles.append(name);
+            if (entry.iState != STATE_IDLE) {
+                iAccounts[accountId].iActiveCount++;
+            }
+        }
+    } else {
+        entry.iAccountId = accountId;
+        iAccounts[accountId].iProfiles.append(name);
+    }
+
+    const SyncResults *lastResults = aProfile.lastResults();
+    entry.iLastFailed = (lastResults && lastResults->majorCode() == SyncResults::SYNC_RESULT_FAILED);
+    entry.iLastMinorCode = lastResults ? lastResults->minorCode() : 0;
+    entry.iLastSyncTime = aProfile.lastSyncTime();
+    entry.iScheduled = (aProfile.syncType() == SyncProfile::SYNC_SCHEDULED);
+    entry.iSchedule = aProfile.syncSchedule();
+
+    iProfiles.insert(name, entry);
+}
+
+void AccountSyncIndex::rebuild(const QList<SyncProfile *> &aProfiles)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QHash<QString, SyncState> states;
+    QHash<QString, ProfileEntry>::const_iterator i;
+    for (i = iProfiles.constBegin(); i != iProfiles.constEnd(); ++i) {
+        if (i->iState != STATE_IDLE) {
+            states.insert(i.key(), i->iState);
+        }
+    }
+
+    iProfiles.clear();
+    iAccounts.clear();
+    foreach (const SyncProfile *profile, aProfiles) {
+        updateProfile(*profile);
+    }
+
+    QHash<QString, SyncState>::const_iterator s;
+    for (s = states.constBegin(); s != states.constEnd(); ++s) {
+        setSyncState(s.key(), s.value());
+    }
+}
+
+void AccountSyncIndex::removeProfile(const QString &aProfileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!iProfiles.contains(aProfileName)) {
+        return;
+    }
+
+    ProfileEntry entry = iProfiles.take(aProfileName);
+    AccountEntry &account = iAccounts[entry.iAccountId];
+    account.iProfiles.removeAll(aProfileName);
+    if (entry.iState != STATE_IDLE) {
+        account.iActiveCount--;
+    }
+    if (account.iProfiles.isEmpty()) {
+        iAccounts.remove(entry.iAccountId);
+    }
+}
+
+void AccountSyncIndex::setSyncState(const QString &aProfileName, SyncState aState)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QHash<QString, ProfileEntry>::iterator i = iProfiles.find(aProfileName);
+    if (i == iProfiles.end() || i->iState == aState) {
+        return;
+    }
+
+    AccountEntry &account = iAccounts[i->iAccountId];
+    if (i->iState == STATE_IDLE) {
+        account.iActiveCount++;
+    } else if (aState == STATE_IDLE) {
+        account.iActiveCount--;
+    }
+    i->iState = aState;
+}
+
+QString AccountSyncIndex::accountId(const QString &aProfileName) const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QString id;
+    if (iProfiles.contains(aProfileName)) {
+        id = QString::number(iProfiles.value(aProfileName).iAccountId);
+    }
+
+    return id;
+}
+
+QStringList AccountSyncIndex::profiles(unsigned int aAccountId) const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    return iAccounts.value(aAccountId).iProfiles;
+}
+
+int AccountSyncIndex::status(unsigned int aAccountId, int &aFailedReason,
+                             qlonglong &aPrevSyncTime, qlonglong &aNextSyncTime) const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    int status = 1; // Initialize to Done
+    QDateTime prevSyncTime; // Initialize to invalid
+    QDateTime nextSyncTime;
+    const AccountEntry account = iAccounts.value(aAccountId);
+
+    if (account.iActiveCount > 0) {
+        qCDebug(lcButeoMsyncd) << "Sync running for" << aAccountId;
+        status = 0;
+    } else {
+        // Check if the last sync resulted in an error for any of the
+        // profiles
+        foreach (const QString &name, account.iProfiles) {
+            const ProfileEntry entry = iProfiles.value(name);
+            if (entry.iLastFailed) {
+                status = 2;
+                aFailedReason = entry.iLastMinorCode;
+                break;
+            }
+        }
+
+        // Need to return the next and last sync times
+        foreach (const QString &name, account.iProfiles) {
+            QDateTime lastSyncTime = iProfiles.value(name).iLastSyncTime;
+            if (!prevSyncTime.isValid() || lastSyncTime > prevSyncTime) {
+                prevSyncTime = lastSyncTime;
+            }
+        }
+        if (prevSyncTime.isValid()) {
+            // Doesn't really matter which profile we do this for, as all of
+            // them have the same schedule
+            const ProfileEntry entry = iProfiles.value(account.iProfiles.first());
+            if (entry.iScheduled) {
+                nextSyncTime = entry.iSchedule.nextSyncTime(prevSyncTime);
+            }
+        }
+    }
+
+    aPrevSyncTime = prevSyncTime.toMSecsSinceEpoch();
+    aNextSyncTime = nextSyncTime.toMSecsSinceEpoch();
+    return status;
+}
+
+QList<unsigned int> AccountSyncIndex::syncingAccounts() const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QList<unsigned int> accounts;
+    QHash<unsigned int, AccountEntry>::const_iterator i;
+    for (i = iAccounts.constBegin(); i != iAccounts.constEnd(); ++i) {
+        if (i->iActiveCount > 0) {
+            accounts.append(i.key());
+        }
+    }
+
+    return accounts;
+}
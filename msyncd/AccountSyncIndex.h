@@ -0,0 +1,149 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#ifndef ACCOUNTSYNCINDEX_H
+#define ACCOUNTSYNCINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QDateTime>
+
+#include "SyncSchedule.h"
+
+namespace Buteo {
+
+class SyncProfile;
+
+/*! \brief In-memory index of sync profiles and their state per account.
+ *
+ * Keeps track of the profiles of each account, whether they are queued or
+ * running, and the data of their last sync, so that account status queries
+ * can be answered without loading profiles from disk. The index is fed
+ * from profile change events and from the session state transitions of
+ * Synchronizer, and rebuilt when the profiles are changed behind its back.
+ */
+class AccountSyncIndex
+{
+public:
+    //! Sync state of a profile.
+    enum SyncState {
+        //! No sync queued or running.
+        STATE_IDLE,
+
+        //! Sync is waiting in the sync queue.
+        STATE_QUEUED,
+
+        //! Sync is running.
+        STATE_RUNNING
+    };
+
+    /*! \brief Adds or updates the given profile in the index.
+     *
+     * Profiles without an account ID are removed from the index. The sync
+     * state of an already indexed profile is preserved.
+     * \param aProfile Profile to index.
+     */
+    void updateProfile(const SyncProfile &aProfile);
+
+    /*! \brief Replaces the indexed profiles with the given ones.
+     *
+     * The sync state of profiles which are still present is preserved.
+     * \param aProfiles Profiles to index.
+     */
+    void rebuild(const QList<SyncProfile *> &aProfiles);
+
+    /*! \brief Removes the profile with the given name from the index.
+     *
+     * \param aProfileName Name of the profile.
+     */
+    void removeProfile(const QString &aProfileName);
+
+    /*! \brief Sets the sync state of the given profile.
+     *
+     * Profiles that are not in the index are ignored.
+     * \param aProfileName Name of the profile.
+     * \param aState New sync state.
+     */
+    void setSyncState(const QString &aProfileName, SyncState aState);
+
+    /*! \brief Returns the account ID of the given profile.
+     *
+     * \param aProfileName Name of the profile.
+     * \return Account ID. Empty if the profile is not indexed.
+     */
+    QString accountId(const QString &aProfileName) const;
+
+    /*! \brief Returns the names of the profiles of the given account.
+     *
+     * \param aAccountId Account ID.
+     * \return Profile names.
+     */
+    QStringList profiles(unsigned int aAccountId) const;
+
+    /*! \brief Returns the sync status of the given account.
+     *
+     * \see Synchronizer::status
+     */
+    int status(unsigned int aAccountId, int &aFailedReason,
+               qlonglong &aPrevSyncTime, qlonglong &aNextSyncTime) const;
+
+    /*! \brief Returns the accounts which have queued or running syncs.
+     *
+     * \return Account IDs.
+     */
+    QList<unsigned int> syncingAccounts() const;
+
+private:
+    struct ProfileEntry {
+        unsigned int iAccountId;
+        SyncState iState;
+        bool iLastFailed;
+        int iLastMinorCode;
+        QDateTime iLastSyncTime;
+        bool iScheduled;
+        SyncSchedule iSchedule;
+
+        ProfileEntry()
+            : iAccountId(0)
+            , iState(STATE_IDLE)
+            , iLastFailed(false)
+            , iLastMinorCode(0)
+            , iScheduled(false)
+        {}
+    };
+
+    struct AccountEntry {
+        QStringList iProfiles;
+        int iActiveCount;
+
+        AccountEntry()
+            : iActiveCount(0)
+        {}
+    };
+
+    QHash<QString, ProfileEntry> iProfiles;
+
+    QHash<unsigned int, AccountEntry> iAccounts;
+};
+
+}
+
+#endif // ACCOUNTSYNCINDEX_H
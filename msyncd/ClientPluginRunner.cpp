@@ -25,6 +25,7 @@
 #include "ClientThread.h"
 #include "ClientPlugin.h"
 #include "LogMacros.h"
+#include "TraceRecorder.h"
 #include "PluginManager.h"
 
 using namespace Buteo;
@@ -39,6 +40,7 @@ ClientPluginRunner::ClientPluginRunner(const QString &aPluginName,
     , iProfile(aProfile)
     , iPlugin(nullptr)
     , iThread(nullptr)
+    , iStartPending(false)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 }
@@ -47,9 +49,30 @@ ClientPluginRunner::~ClientPluginRunner()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    stop();
     disconnect();
 
+    if (iThread) {
+        iThread->stopThread();
+    }
+
+    if (iThread && !iThread->wait(0)) {
+        // The plug-in has not returned yet, for example because it stalled.
+        // Waiting for it would block msyncd, so the plug-in is destroyed
+        // along with the thread object once it returns.
+        qCDebug(lcButeoMsyncd) << "Plug-in" << iPluginName << "is still running, destroying it later";
+        ClientPlugin *plugin = iPlugin;
+        PluginManager *pluginMgr = iPluginMgr;
+        if (plugin && pluginMgr) {
+            connect(iThread, &QObject::destroyed, pluginMgr, [pluginMgr, plugin]() {
+                pluginMgr->destroyClient(plugin);
+            });
+        }
+        iThread->deleteWhenFinished();
+        iThread = nullptr;
+        iPlugin = nullptr;
+        return;
+    }
+
     if (iPlugin && iPluginMgr) {
         iPluginMgr->destroyClient(iPlugin);
         iPlugin = nullptr;
@@ -104,6 +127,8 @@ bool ClientPluginRunner::init()
 
     connect(iThread, SIGNAL(finished()), this, SLOT(onThreadExit()));
 
+    watchPluginStart();
+
     iInitialized = true;
 
     return true;
@@ -113,10 +138,19 @@ bool ClientPluginRunner::start()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    TraceScope traceScope("ClientPluginRunner::start", "plugin", iPlugin ? iPlugin->getProfileName() : QString());
+
     bool rv = false;
     if (iInitialized && iThread) {
         // Set a timer after which the sync session should stop
         QTimer::singleShot(MAX_PLUGIN_SYNC_TIME, this, SLOT(pluginTimeout()));
+        if (!isReady()) {
+            // The thread is started from onPluginReady()
+            qCDebug(lcButeoMsyncd) << "Plugin process for" << iPlugin->getProfileName()
+                                   << "is still starting, deferring sync";
+            iStartPending = true;
+            return true;
+        }
         rv = iThread->startThread(iPlugin);
         qCDebug(lcButeoMsyncd) << "ClientPluginRunner started thread for plugin:" << iPlugin->getProfileName()
                                << ", returning:" << rv;
@@ -129,9 +163,10 @@ void ClientPluginRunner::stop()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    // Not waited for, the worker thread may still be busy in the plug-in.
+    // The session has ended when done() is emitted.
     if (iThread) {
         iThread->stopThread();
-        iThread->wait();
     }
 }
 
@@ -139,7 +174,11 @@ void ClientPluginRunner::abort(Sync::SyncStatus aStatus)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    if (iPlugin) {
+    if (iStartPending) {
+        // Nothing is running yet, so there is nothing to wait for
+        iStartPending = false;
+        onError(iProfile->name(), "Sync aborted", SyncResults::ABORTED);
+    } else if (iPlugin) {
         iPlugin->abortSync(aStatus);
     }
 }
@@ -167,12 +206,35 @@ bool ClientPluginRunner::cleanUp()
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     bool retval = false;
+    if (!isReady()) {
+        qCWarning(lcButeoMsyncd) << "Plugin process has not started, cannot clean up";
+        return retval;
+    }
+
     if (iPlugin) {
         retval = iPlugin->cleanUp();
     }
     return retval;
 }
 
+void ClientPluginRunner::onPluginReady(bool aSuccess)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!iStartPending) {
+        return;
+    }
+    iStartPending = false;
+
+    if (!aSuccess) {
+        onError(iProfile->name(), "Plugin process failed to start", SyncResults::PLUGIN_ERROR);
+    } else if (!iThread->startThread(iPlugin)) {
+        onError(iProfile->name(), "Failed to start plugin thread", SyncResults::INTERNAL_ERROR);
+    } else {
+        qCDebug(lcButeoMsyncd) << "ClientPluginRunner started thread for plugin:" << iPlugin->getProfileName();
+    }
+}
+
 void ClientPluginRunner::onTransferProgress(const QString &aProfileName,
                                             Sync::TransferDatabase aDatabase, Sync::TransferType aType,
                                             const QString &aMimeType, int aCommittedItems)
@@ -225,6 +287,7 @@ void ClientPluginRunner::pluginTimeout()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    iStartPending = false;
     emit error(iProfile->name(), "Plugin timeout occurred", SyncResults::PLUGIN_TIMEOUT);
     stop();
 }
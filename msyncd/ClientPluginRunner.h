@@ -78,6 +78,10 @@ public:
     //! @see PluginRunner::plugin
     virtual bool cleanUp();
 
+protected:
+    //! @see PluginRunner::onPluginReady
+    virtual void onPluginReady(bool aSuccess);
+
 private slots:
     // Slots for catching plug-in signals.
     void onTransferProgress(const QString &aProfileName,
@@ -99,8 +103,12 @@ private:
     ClientPlugin *iPlugin;
     ClientThread *iThread;
 
+    // start() was called before the plug-in process was ready
+    bool iStartPending;
+
 #ifdef SYNCFW_UNIT_TESTS
     friend class ClientPluginRunnerTest;
+    friend class SyncSessionTest;
 #endif
 
 };
@@ -22,8 +22,12 @@
  */
 #include "ClientThread.h"
 #include "ClientPlugin.h"
+#include "PluginThreadPool.h"
 #include "LogMacros.h"
+#include "TraceRecorder.h"
 #include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
 
 using namespace Buteo;
 
@@ -33,13 +37,23 @@ ClientThread::ClientThread()
     , iService(nullptr)
     , iSession(nullptr)
     , iRunning(false)
+    , iThread(nullptr)
+    , iContext(nullptr)
+    , iActive(false)
+    , iStopping(false)
+    , iDeleteWhenFinished(false)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iWaitTimer.setSingleShot(true);
+    connect(&iWaitTimer, &QTimer::timeout, this, &ClientThread::waitTimedOut);
 }
 
 ClientThread::~ClientThread()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+    stopThread();
+    wait();
     if (iSession) {
         iIdentity->destroySession(iSession);
     }
@@ -104,9 +118,7 @@ bool ClientThread::startThread(ClientPlugin *aClientPlugin)
                 this, SLOT(identities(const QList<SignOn::IdentityInfo> &)));
         iService->queryIdentities();
     } else {
-        // Move to client thread
-        iClientPlugin->moveToThread(this);
-        start();
+        startSession();
     }
 
     return true;
@@ -115,38 +127,163 @@ bool ClientThread::startThread(ClientPlugin *aClientPlugin)
 void ClientThread::stopThread()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
-    exit();
+
+    QMutexLocker locker(&iMutex);
+    if (iActive) {
+        if (iContext && !iStopping) {
+            iStopping = true;
+            QTimer::singleShot(0, iContext, [this]() {
+                finishSession(true);
+            });
+        }
+    } else if (iRunning) {
+        // Still waiting for credentials or for a worker thread. Queued, as
+        // the caller may be about to wait for or delete this object.
+        PluginThreadPool::instance()->cancel(this);
+        iWaitTimer.stop();
+        iRunning = false;
+        QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+    }
 }
 
-void ClientThread::run()
+bool ClientThread::wait(unsigned long aTime)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    QMutexLocker locker(&iMutex);
+    while (iActive) {
+        if (!iFinished.wait(&iMutex, aTime)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ClientThread::deleteWhenFinished()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QMutexLocker locker(&iMutex);
+    if (iActive) {
+        iDeleteWhenFinished = true;
+    } else {
+        deleteLater();
+    }
+}
+
+void ClientThread::startSession()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QMutexLocker locker(&iMutex);
+    if (!iRunning || iActive) {
+        // Stopped while waiting for a thread
+        return;
+    }
+
+    QThread *thread = PluginThreadPool::instance()->acquire(this, "startSession");
+    if (thread == nullptr) {
+        qCDebug(lcButeoMsyncd) << "Waiting for a worker thread for" << getProfileName();
+        // Retries do not extend the wait
+        if (!iWaitTimer.isActive()) {
+            iWaitTimer.start(PluginThreadPool::instance()->waitTimeout());
+        }
+        return;
+    }
+
+    iWaitTimer.stop();
+    iThread = thread;
+    iActive = true;
+    iStopping = false;
+
+    iContext = new QObject;
+    iContext->moveToThread(iThread);
+
+    // Move to the worker thread
+    iClientPlugin->moveToThread(iThread);
+    QTimer::singleShot(0, iContext, [this]() {
+        runSession();
+    });
+}
+
+void ClientThread::runSession()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    TraceScope traceScope("ClientThread::runSession", "plugin", getProfileName());
+
     if (!iClientPlugin->init()) {
         qCWarning(lcButeoMsyncd) << "Could not initialize client plugin:" << iClientPlugin->getPluginName();
         emit initError(getProfileName(), "", SyncResults::PLUGIN_ERROR);
+        finishSession(false);
         return;
     }
 
     if (!iClientPlugin->startSync()) {
         qCWarning(lcButeoMsyncd) << "Could not start client plugin:" << iClientPlugin->getPluginName();
         emit initError(getProfileName(), "", SyncResults::PLUGIN_ERROR);
+        finishSession(false);
         return;
     }
 
-    exec();
+    // The sync now runs in the event loop of the worker thread, until
+    // stopThread() queues finishSession()
+}
 
-    iSyncResults = iClientPlugin->getSyncResults();
+void ClientThread::finishSession(bool aSyncStarted)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    iClientPlugin->uninit();
+    if (aSyncStarted) {
+        iSyncResults = iClientPlugin->getSyncResults();
+
+        iClientPlugin->uninit();
+    }
 
     // Move back to application thread
     iClientPlugin->moveToThread(QCoreApplication::instance()->thread());
 
+    QThread *thread = nullptr;
+    {
+        // Calls still queued through the context are dropped with it
+        QMutexLocker locker(&iMutex);
+        delete iContext;
+        iContext = nullptr;
+        thread = iThread;
+        iThread = nullptr;
+    }
+
+    PluginThreadPool::instance()->release(thread);
+
+    emit finished();
+
+    QMutexLocker locker(&iMutex);
+    iRunning = false;
+    iActive = false;
+    iFinished.wakeAll();
+    if (iDeleteWhenFinished) {
+        deleteLater();
+    }
+}
+
+void ClientThread::waitTimedOut()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
     {
         QMutexLocker locker(&iMutex);
+        if (!iRunning || iActive) {
+            return;
+        }
+
+        PluginThreadPool::instance()->cancel(this);
         iRunning = false;
     }
+
+    qCWarning(lcButeoMsyncd) << "No worker thread became available for" << getProfileName();
+    // Queued first, the receiver of initError() may delete this object
+    QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection);
+    emit initError(getProfileName(), "no worker thread available", SyncResults::PLUGIN_ERROR);
 }
 
 SyncResults ClientThread::getSyncResults()
@@ -191,8 +328,7 @@ void ClientThread::identityResponse(const SignOn::SessionData &sessionData)
     profile.setKey("Password", sessionData.Secret());
 
     // delayed starting of thread
-    iClientPlugin->moveToThread(this);
-    start();
+    startSession();
 }
 
 void ClientThread::identityError(SignOn::Error err)
@@ -23,21 +23,31 @@
 #ifndef CLIENTTHREAD_H
 #define CLIENTTHREAD_H
 
-#include <QThread>
+#include <QObject>
 #include <QMutex>
+#include <QTimer>
+#include <QWaitCondition>
 #include <SyncResults.h>
 
+#include <climits>
+
 #include "SignOn/AuthService"
 #include "SignOn/Identity"
 
+class QThread;
+
 namespace Buteo {
 
 class ClientPlugin;
 
-/*! \brief Thread for client plugins
+/*! \brief Runs a client plugin session on a worker thread
  *
+ * The thread is checked out from PluginThreadPool when the session starts
+ * and returned to it when the session ends. If no thread is released
+ * within PluginThreadPool::waitTimeout(), the session fails with
+ * initError() and finished().
  */
-class ClientThread : public QThread
+class ClientThread : public QObject
 {
     Q_OBJECT
 
@@ -77,6 +87,23 @@ public:
      */
     void stopThread();
 
+    /*! \brief Waits until the session has ended
+     *
+     * Returns right away if the session is not running on a worker thread.
+     *
+     * @param aTime Timeout in milliseconds
+     * @return True if the session ended, false on timeout
+     */
+    bool wait(unsigned long aTime = ULONG_MAX);
+
+    /*! \brief Deletes this object once the session has ended
+     *
+     * For owners which cannot wait for the plug-in to return, such as a
+     * runner giving up on a stalled plug-in. Deleted right away if no
+     * session is running on a worker thread.
+     */
+    void deleteWhenFinished();
+
     /*! \brief Returns the results for this particular thread
      *
      */
@@ -93,12 +120,15 @@ signals:
     void initError(const QString &aProfileName, const QString &aMessage,
                    SyncResults::MinorCode aErrorCode);
 
-protected:
-    /*! \brief overriding method for QThread::run
+    /*! \brief Emitted from the worker thread when the session has ended
      */
-    virtual void run();
+    void finished();
 
 private:
+    void runSession();
+
+    void finishSession(bool aSyncStarted);
+
     ClientPlugin *iClientPlugin;
 
     SyncResults iSyncResults;
@@ -110,7 +140,19 @@ private:
 
     bool iRunning;
 
+    // Set while the session is on a worker thread
+    QThread *iThread;
+    // Lives in iThread during the session, queued calls are made through it
+    QObject *iContext;
+    bool iActive;
+    bool iStopping;
+    bool iDeleteWhenFinished;
+
+    // Runs while waiting for a worker thread
+    QTimer iWaitTimer;
+
     mutable QMutex iMutex;
+    QWaitCondition iFinished;
 
 #ifdef SYNCFW_UNIT_TESTS
     friend class ClientThreadTest;
@@ -132,6 +174,8 @@ private:
     bool startSync();
 
 private slots:
+    void startSession();
+    void waitTimedOut();
     void identities(const QList<SignOn::IdentityInfo> &identityList);
     void identityResponse(const SignOn::SessionData &session);
     void identityError(SignOn::Error error);
@@ -0,0 +1,79 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "MetricsExporter.h"
+#include "Metrics.h"
+#include "LogMacros.h"
+
+#include <QDBusConnection>
+
+using namespace Buteo;
+
+static const char *DBUS_METRICS_OBJECT = "/metrics";
+static const char *METRICS_FILE_ENV = "MSYNCD_METRICS_FILE";
+static const char *METRICS_INTERVAL_ENV = "MSYNCD_METRICS_INTERVAL";
+static const int DEFAULT_METRICS_INTERVAL = 60; // seconds
+
+MetricsExporter::MetricsExporter(QObject *aParent)
+    : QObject(aParent)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QDBusConnection dbus = QDBusConnection::sessionBus();
+    if (dbus.registerObject(DBUS_METRICS_OBJECT, this, QDBusConnection::ExportScriptableSlots)) {
+        qCDebug(lcButeoMsyncd) << "Registered metrics to D-Bus";
+    } else {
+        qCWarning(lcButeoMsyncd) << "Failed to register metrics to D-Bus";
+    }
+
+    iFilePath = QString::fromLocal8Bit(qgetenv(METRICS_FILE_ENV));
+    if (!iFilePath.isEmpty()) {
+        bool ok = false;
+        int interval = qgetenv(METRICS_INTERVAL_ENV).toInt(&ok);
+        if (!ok || interval <= 0) {
+            interval = DEFAULT_METRICS_INTERVAL;
+        }
+        qCDebug(lcButeoMsyncd) << "Writing metrics to" << iFilePath << "every" << interval << "s";
+        connect(&iFileTimer, SIGNAL(timeout()), this, SLOT(writeFile()));
+        iFileTimer.start(interval * 1000);
+    }
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QDBusConnection::sessionBus().unregisterObject(DBUS_METRICS_OBJECT);
+
+    if (!iFilePath.isEmpty()) {
+        writeFile();
+    }
+}
+
+QString MetricsExporter::metrics() const
+{
+    return Metrics::instance()->toText();
+}
+
+void MetricsExporter::writeFile()
+{
+    Metrics::instance()->writeToFile(iFilePath);
+}
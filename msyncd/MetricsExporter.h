@@ -0,0 +1,69 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+namespace Buteo {
+
+/*! \brief Exposes the daemon metrics on D-Bus and optionally in a file.
+ *
+ * The metrics are available from the "/metrics" object on the msyncd
+ * service. If MSYNCD_METRICS_FILE is set in the environment, the metrics
+ * are also written to that file every MSYNCD_METRICS_INTERVAL seconds
+ * (60 by default).
+ */
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.meego.msyncd.metrics")
+
+public:
+    /*! \brief Constructor, registers the object on the session bus.
+     *
+     * @param aParent Parent object
+     */
+    explicit MetricsExporter(QObject *aParent = nullptr);
+
+    /*! \brief Destructor, unregisters the object and writes the file
+     *         one last time.
+     */
+    virtual ~MetricsExporter();
+
+public slots:
+    /*! \brief Returns all metrics in the Prometheus text format.
+     */
+    Q_SCRIPTABLE QString metrics() const;
+
+private slots:
+    void writeFile();
+
+private:
+    QString iFilePath;
+    QTimer iFileTimer;
+};
+
+}
+
+#endif // METRICSEXPORTER_H
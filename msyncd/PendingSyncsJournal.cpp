@@ -0,0 +1,125 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "PendingSyncsJournal.h"
+#include "LogMacros.h"
+
+#include <QSettings>
+
+using namespace Buteo;
+
+static const QString QUEUE_GROUP = "queue";
+static const QString ONLINE_GROUP = "waitingonline";
+static const QString CHANGES_GROUP = "profilechanges";
+static const QString PROFILE_KEY = "profile";
+static const QString SCHEDULED_KEY = "scheduled";
+static const QString TIME_KEY = "enqueued";
+static const QString CHANGE_KEY = "change";
+
+bool PendingSyncsJournal::save(const QString &aPath) const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QSettings journal(aPath, QSettings::IniFormat);
+    journal.clear();
+
+    journal.beginWriteArray(QUEUE_GROUP, iQueue.size());
+    for (int i = 0; i < iQueue.size(); ++i) {
+        journal.setArrayIndex(i);
+        journal.setValue(PROFILE_KEY, iQueue.at(i).iProfileName);
+        journal.setValue(SCHEDULED_KEY, iQueue.at(i).iScheduled);
+        journal.setValue(TIME_KEY, iQueue.at(i).iEnqueueTime);
+    }
+    journal.endArray();
+
+    journal.beginWriteArray(ONLINE_GROUP, iWaitingOnline.size());
+    for (int i = 0; i < iWaitingOnline.size(); ++i) {
+        journal.setArrayIndex(i);
+        journal.setValue(PROFILE_KEY, iWaitingOnline.at(i));
+    }
+    journal.endArray();
+
+    journal.beginWriteArray(CHANGES_GROUP, iProfileChanges.size());
+    for (int i = 0; i < iProfileChanges.size(); ++i) {
+        journal.setArrayIndex(i);
+        journal.setValue(PROFILE_KEY, iProfileChanges.at(i).first);
+        journal.setValue(CHANGE_KEY, int(iProfileChanges.at(i).second));
+    }
+    journal.endArray();
+
+    journal.sync();
+    if (journal.status() != QSettings::NoError) {
+        qCWarning(lcButeoMsyncd) << "Failed to write pending syncs journal" << aPath;
+        return false;
+    }
+    return true;
+}
+
+void PendingSyncsJournal::load(const QString &aPath)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iQueue.clear();
+    iWaitingOnline.clear();
+    iProfileChanges.clear();
+
+    QSettings journal(aPath, QSettings::IniFormat);
+
+    int count = journal.beginReadArray(QUEUE_GROUP);
+    for (int i = 0; i < count; ++i) {
+        journal.setArrayIndex(i);
+        QString profileName = journal.value(PROFILE_KEY).toString();
+        bool timeOk = false;
+        qint64 enqueueTime = journal.value(TIME_KEY).toLongLong(&timeOk);
+        if (profileName.isEmpty()) {
+            qCWarning(lcButeoMsyncd) << "Skipping malformed queued sync in journal";
+            continue;
+        }
+        iQueue.append(QueuedSync(profileName, journal.value(SCHEDULED_KEY).toBool(),
+                                 timeOk ? enqueueTime : 0));
+    }
+    journal.endArray();
+
+    count = journal.beginReadArray(ONLINE_GROUP);
+    for (int i = 0; i < count; ++i) {
+        journal.setArrayIndex(i);
+        QString profileName = journal.value(PROFILE_KEY).toString();
+        if (!profileName.isEmpty() && !iWaitingOnline.contains(profileName)) {
+            iWaitingOnline.append(profileName);
+        }
+    }
+    journal.endArray();
+
+    count = journal.beginReadArray(CHANGES_GROUP);
+    for (int i = 0; i < count; ++i) {
+        journal.setArrayIndex(i);
+        QString profileName = journal.value(PROFILE_KEY).toString();
+        bool changeOk = false;
+        int change = journal.value(CHANGE_KEY).toInt(&changeOk);
+        // Only additions and modifications trigger a sync
+        if (profileName.isEmpty() || !changeOk
+                || (change != ProfileManager::PROFILE_ADDED && change != ProfileManager::PROFILE_MODIFIED)) {
+            qCWarning(lcButeoMsyncd) << "Skipping malformed profile change in journal";
+            continue;
+        }
+        iProfileChanges.append(qMakePair(profileName, ProfileManager::ProfileChangeType(change)));
+    }
+    journal.endArray();
+}
@@ -0,0 +1,86 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#ifndef PENDINGSYNCSJOURNAL_H
+#define PENDINGSYNCSJOURNAL_H
+
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
+#include "ProfileManager.h"
+
+namespace Buteo {
+
+/*! \brief Sync requests which have not been served yet.
+ *
+ * Synchronizer saves the requests to a journal file whenever they change,
+ * and replays them on the next start, so that a restart of msyncd does not
+ * lose them.
+ */
+class PendingSyncsJournal
+{
+public:
+    //! A request waiting in the sync queue.
+    struct QueuedSync {
+        //! Name of the profile to sync.
+        QString iProfileName;
+
+        //! True if the request came from the scheduler.
+        bool iScheduled;
+
+        //! Time the request was queued, in ms since epoch. 0 if not known.
+        qint64 iEnqueueTime;
+
+        QueuedSync(const QString &aProfileName = QString(), bool aScheduled = false,
+                   qint64 aEnqueueTime = 0)
+            : iProfileName(aProfileName)
+            , iScheduled(aScheduled)
+            , iEnqueueTime(aEnqueueTime)
+        {}
+    };
+
+    //! Requests in the sync queue, in queue order.
+    QList<QueuedSync> iQueue;
+
+    //! Scheduled syncs waiting for a suitable connection.
+    QStringList iWaitingOnline;
+
+    //! Syncs triggered by profile changes, waiting to be started.
+    QList<QPair<QString, ProfileManager::ProfileChangeType> > iProfileChanges;
+
+    /*! \brief Writes the requests to a journal file.
+     *
+     * \param aPath Path of the journal file.
+     * \return True on success.
+     */
+    bool save(const QString &aPath) const;
+
+    /*! \brief Reads the requests from a journal file.
+     *
+     * Malformed entries are skipped.
+     * \param aPath Path of the journal file.
+     */
+    void load(const QString &aPath);
+};
+
+}
+
+#endif // PENDINGSYNCSJOURNAL_H
@@ -23,6 +23,7 @@
 
 #include "PluginRunner.h"
 #include "LogMacros.h"
+#include "PluginManager.h"
 #include "SyncResults.h"
 
 using namespace Buteo;
@@ -31,6 +32,8 @@ PluginRunner::PluginRunner(PluginType aPluginType, const QString &aPluginName,
                            PluginManager *aPluginMgr, PluginCbInterface *aPluginCbIf, QObject *aParent)
     : QObject(aParent)
     , iInitialized(false)
+    , iPluginStarting(false)
+    , iCleanUpPending(false)
     , iPluginMgr(aPluginMgr)
     , iPluginCbIf(aPluginCbIf)
     , iType(aPluginType)
@@ -61,3 +64,66 @@ QString PluginRunner::pluginName() const
 
     return iPluginName;
 }
+
+bool PluginRunner::isReady() const
+{
+    return !iPluginStarting;
+}
+
+bool PluginRunner::killPlugin()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    return iPluginMgr && plugin() && iPluginMgr->killOOPPlugin(plugin());
+}
+
+void PluginRunner::watchPluginStart()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iPluginMgr && iPluginMgr->isPluginStarting(plugin())) {
+        iPluginStarting = true;
+        connect(iPluginMgr, &PluginManager::pluginStarted,
+                this, &PluginRunner::onPluginStarted);
+    }
+}
+
+void PluginRunner::startCleanUp()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (isReady()) {
+        emit cleanUpDone(cleanUp());
+    } else {
+        iCleanUpPending = true;
+    }
+}
+
+void PluginRunner::onPluginReady(bool aSuccess)
+{
+    Q_UNUSED(aSuccess);
+}
+
+void PluginRunner::onPluginStarted(SyncPluginBase *aPlugin, bool aSuccess)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (aPlugin != plugin()) {
+        return;
+    }
+
+    disconnect(iPluginMgr, &PluginManager::pluginStarted,
+               this, &PluginRunner::onPluginStarted);
+    iPluginStarting = false;
+
+    qCDebug(lcButeoMsyncd) << "Plug-in" << iPluginName << "started, success:" << aSuccess;
+    onPluginReady(aSuccess);
+
+    if (iCleanUpPending) {
+        iCleanUpPending = false;
+        if (!aSuccess) {
+            qCWarning(lcButeoMsyncd) << "Plugin process did not start, cannot clean up";
+        }
+        emit cleanUpDone(aSuccess && cleanUp());
+    }
+}
@@ -81,7 +81,9 @@ public:
 
     /*! \brief Stops running the plug-in
      *
-     * Returns when the plug-in is stopped.
+     * The plug-in has stopped when done() is emitted. Client plug-in
+     * runners return right away, server plug-in runners return when the
+     * plug-in has stopped.
      */
     virtual void stop() = 0;
 
@@ -103,10 +105,18 @@ public:
 
     /*! \brief Calls the cleanup for the plugin
      *
-     * The plug-in is requested to clean up.
+     * The plug-in is requested to clean up. Fails if the plug-in is not
+     * ready, use startCleanUp() for plug-ins which may still be starting.
      */
     virtual bool cleanUp() = 0;
 
+    /*! \brief Requests the plug-in to clean up once it is ready
+     *
+     * Cleans up right away if the plug-in is ready, otherwise when its
+     * process has started. The result is reported with cleanUpDone().
+     */
+    void startCleanUp();
+
     /*! \brief Gets the plug-in type
      *
      * @return Plug-in type
@@ -125,6 +135,26 @@ public:
      */
     virtual SyncPluginBase *plugin() = 0;
 
+    /*! \brief Checks if the plug-in can be used
+     *
+     * Out-of-process plug-ins are created before their process has
+     * registered on D-Bus. Until then the runner is not ready and start()
+     * only records that the plug-in should be started.
+     *
+     * @return True if the plug-in is ready
+     */
+    bool isReady() const;
+
+    /*! \brief Kills the plug-in process
+     *
+     * Last resort for an out-of-process plug-in which does not react to
+     * abort(). The plug-in reports an error once the process is gone.
+     *
+     * @return True if the process was killed, false if the plug-in runs
+     *  in process and cannot be killed
+     */
+    bool killPlugin();
+
 signals:
     //! @see SyncPluginBase::transferProgress
     void transferProgress(const QString &aProfileName,
@@ -155,10 +185,37 @@ signals:
     //! @see SyncPluginBase::connectivityStateChanged
     void connectivityStateChanged(Sync::ConnectivityType aType, bool aState);
 
+    /*! \brief Signal sent when a cleanup requested with startCleanUp() has
+     *         finished
+     *
+     * @param aSuccess Result of cleanUp(), false if the plug-in process
+     *  failed to start
+     */
+    void cleanUpDone(bool aSuccess);
+
 protected:
+    /*! \brief Starts tracking the start of the plug-in process
+     *
+     * Should be called by init() after the plug-in has been created.
+     * onPluginReady() is called once the plug-in has started.
+     */
+    void watchPluginStart();
+
+    /*! \brief Called when an out-of-process plug-in has finished starting
+     *
+     * @param aSuccess True if the plug-in is ready to be used
+     */
+    virtual void onPluginReady(bool aSuccess);
+
     //! Initialization status of the plugin
     bool iInitialized;
 
+    //! True while the out-of-process plug-in is starting
+    bool iPluginStarting;
+
+    //! True if the plug-in should clean up once it has started
+    bool iCleanUpPending;
+
     //! pointer to an instance of plugin manager
     PluginManager *iPluginMgr;
 
@@ -171,6 +228,9 @@ protected:
     //! name of the plugin
     QString iPluginName;
 
+private slots:
+    void onPluginStarted(Buteo::SyncPluginBase *aPlugin, bool aSuccess);
+
 private:
 #ifdef SYNCFW_UNIT_TESTS
     friend class PluginRunnerTest;
@@ -0,0 +1,235 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+
+#include "PluginThreadPool.h"
+#include "LogMacros.h"
+#include "Metrics.h"
+
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QThread>
+
+using namespace Buteo;
+
+static const int DEFAULT_MAX_THREADS = 4;
+static const int DEFAULT_WAIT_TIMEOUT = 120000; // ms
+// How long a stopped thread may take to exit its event loop
+static const unsigned long THREAD_EXIT_TIMEOUT = 5000; // ms
+
+PluginThreadPool *PluginThreadPool::instance()
+{
+    static PluginThreadPool pool;
+    return &pool;
+}
+
+PluginThreadPool::PluginThreadPool()
+    : iMaxThreads(DEFAULT_MAX_THREADS)
+    , iWaitTimeout(DEFAULT_WAIT_TIMEOUT)
+    , iSerial(0)
+{
+}
+
+PluginThreadPool::~PluginThreadPool()
+{
+    shutdown();
+}
+
+void PluginThreadPool::setMaxThreads(int aMaxThreads)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QList<QThread *> stopped;
+    {
+        QMutexLocker locker(&iMutex);
+        iMaxThreads = qMax(1, aMaxThreads);
+        while (!iIdleThreads.isEmpty()
+                && iIdleThreads.count() + iBusyThreads.count() > iMaxThreads) {
+            stopped.append(iIdleThreads.takeFirst());
+        }
+    }
+
+    for (QThread *thread : stopped) {
+        stopThread(thread);
+    }
+}
+
+int PluginThreadPool::maxThreads() const
+{
+    QMutexLocker locker(&iMutex);
+    return iMaxThreads;
+}
+
+void PluginThreadPool::setWaitTimeout(int aTimeout)
+{
+    QMutexLocker locker(&iMutex);
+    iWaitTimeout = qMax(0, aTimeout);
+}
+
+int PluginThreadPool::waitTimeout() const
+{
+    QMutexLocker locker(&iMutex);
+    return iWaitTimeout;
+}
+
+QThread *PluginThreadPool::acquire(QObject *aWaiter, const char *aMember)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QMutexLocker locker(&iMutex);
+
+    QThread *thread = nullptr;
+    if (!iIdleThreads.isEmpty()) {
+        // Most recently used first, its stack is most likely still cached
+        thread = iIdleThreads.takeLast();
+    } else if (iBusyThreads.count() < iMaxThreads) {
+        thread = startThread();
+    } else {
+        qCDebug(lcButeoMsyncd) << "All" << iMaxThreads << "plugin threads are busy";
+        if (aWaiter && aMember) {
+            Waiter waiter;
+            waiter.iObject = aWaiter;
+            waiter.iMember = aMember;
+            iWaiters.append(waiter);
+        }
+        return nullptr;
+    }
+
+    iBusyThreads.append(thread);
+    return thread;
+}
+
+QThread *PluginThreadPool::acquireUnbounded()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QMutexLocker locker(&iMutex);
+
+    QThread *thread = iIdleThreads.isEmpty() ? startThread() : iIdleThreads.takeLast();
+    iUnboundedThreads.append(thread);
+    return thread;
+}
+
+void PluginThreadPool::release(QThread *aThread)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    bool stop = false;
+    Waiter waiter;
+    {
+        QMutexLocker locker(&iMutex);
+        if (!iBusyThreads.removeOne(aThread) && !iUnboundedThreads.removeOne(aThread)) {
+            qCWarning(lcButeoMsyncd) << "Released thread does not belong to the pool";
+            return;
+        }
+
+        if (iIdleThreads.count() + iBusyThreads.count() >= iMaxThreads) {
+            stop = true;
+        } else {
+            iIdleThreads.append(aThread);
+        }
+
+        while (!iWaiters.isEmpty() && !waiter.iObject) {
+            waiter = iWaiters.takeFirst();
+        }
+        iReleased.wakeAll();
+    }
+
+    if (stop) {
+        stopThread(aThread);
+    }
+
+    if (waiter.iObject) {
+        QMetaObject::invokeMethod(waiter.iObject, waiter.iMember.constData(), Qt::QueuedConnection);
+    }
+}
+
+void PluginThreadPool::cancel(QObject *aWaiter)
+{
+    QMutexLocker locker(&iMutex);
+    for (int i = iWaiters.count() - 1; i >= 0; --i) {
+        if (iWaiters.at(i).iObject == aWaiter || !iWaiters.at(i).iObject) {
+            iWaiters.removeAt(i);
+        }
+    }
+}
+
+int PluginThreadPool::threadCount() const
+{
+    QMutexLocker locker(&iMutex);
+    return iIdleThreads.count() + iBusyThreads.count() + iUnboundedThreads.count();
+}
+
+void PluginThreadPool::shutdown(int aTimeout)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QList<QThread *> threads;
+    {
+        QMutexLocker locker(&iMutex);
+        QElapsedTimer timer;
+        timer.start();
+        while (!iBusyThreads.isEmpty() || !iUnboundedThreads.isEmpty()) {
+            const qint64 remaining = aTimeout - timer.elapsed();
+            if (remaining <= 0 || !iReleased.wait(&iMutex, remaining)) {
+                break;
+            }
+        }
+
+        threads = iIdleThreads + iBusyThreads + iUnboundedThreads;
+        iIdleThreads.clear();
+        iBusyThreads.clear();
+        iUnboundedThreads.clear();
+        iWaiters.clear();
+    }
+
+    for (QThread *thread : threads) {
+        stopThread(thread);
+    }
+}
+
+QThread *PluginThreadPool::startThread()
+{
+    // Called with iMutex locked
+    QThread *thread = new QThread;
+    thread->setObjectName(QStringLiteral("buteo-plugin-%1").arg(++iSerial));
+    QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+    Metrics::instance()->counter(QStringLiteral("msyncd_plugin_threads_started_total"))->add();
+    return thread;
+}
+
+void PluginThreadPool::stopThread(QThread *aThread)
+{
+    aThread->quit();
+    if (QThread::currentThread() == aThread) {
+        // Deleted through finished() once its event loop has returned
+        return;
+    }
+
+    if (!aThread->wait(THREAD_EXIT_TIMEOUT)) {
+        // Still inside a plugin which does not return, so it cannot be
+        // deleted. Deleted through finished() if it ever exits.
+        qCWarning(lcButeoMsyncd) << "Plugin thread" << aThread->objectName() << "did not exit";
+        return;
+    }
+    delete aThread;
+}
@@ -0,0 +1,158 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+
+#ifndef PLUGINTHREADPOOL_H
+#define PLUGINTHREADPOOL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QPointer>
+#include <QWaitCondition>
+
+class QThread;
+
+namespace Buteo {
+
+/*!
+ * \brief Long-lived worker threads for in-process plugins.
+ *
+ * ClientThread and ServerThread check a thread out for the duration of a
+ * session and hand it back when the session ends, so no thread is created
+ * or destroyed per session. The threads run a plain event loop, plugins
+ * are moved to them. The number of threads is bounded; a session asking
+ * for a thread when all are in use waits for one to be released, for at
+ * most waitTimeout(). Listening server plugins hold their thread for an
+ * unbounded time, so they get threads outside the bound.
+ */
+class PluginThreadPool
+{
+public:
+    //! Returns the pool instance
+    static PluginThreadPool *instance();
+
+    /*!
+     * \brief Sets the maximum number of threads.
+     *
+     * Idle threads above the limit are stopped right away, busy ones when
+     * they are released.
+     *
+     * @param aMaxThreads Maximum number of threads, at least 1
+     */
+    void setMaxThreads(int aMaxThreads);
+
+    //! Maximum number of threads
+    int maxThreads() const;
+
+    /*!
+     * \brief Sets how long a session may wait for a thread.
+     *
+     * A session still waiting after this long fails. Only read by the
+     * sessions when they start waiting.
+     *
+     * @param aTimeout Timeout in milliseconds
+     */
+    void setWaitTimeout(int aTimeout);
+
+    //! How long a session may wait for a thread, in milliseconds
+    int waitTimeout() const;
+
+    /*!
+     * \brief Checks out a thread.
+     *
+     * Reuses an idle thread, or starts a new one if the limit allows. If
+     * all threads are in use and aWaiter is given, aMember of aWaiter is
+     * invoked through a queued call once a thread has been released, and
+     * it should try again.
+     *
+     * @param aWaiter Object to notify when no thread is available now
+     * @param aMember Slot of aWaiter without arguments
+     * @return Running thread owned by the pool, or null
+     */
+    QThread *acquire(QObject *aWaiter = nullptr, const char *aMember = nullptr);
+
+    /*!
+     * \brief Checks out a thread which does not count against the limit.
+     *
+     * For sessions which keep their thread for as long as they run, such
+     * as listening server plugins, so they cannot starve the others.
+     * Reuses an idle thread or starts a new one.
+     *
+     * @return Running thread owned by the pool
+     */
+    QThread *acquireUnbounded();
+
+    /*!
+     * \brief Returns a thread checked out with acquire() or acquireUnbounded().
+     *
+     * May be called from any thread, including aThread itself. Objects
+     * moved to aThread must have been moved away before.
+     */
+    void release(QThread *aThread);
+
+    //! Forgets aWaiter if it is still waiting for a thread
+    void cancel(QObject *aWaiter);
+
+    //! Number of threads started and not stopped, busy, unbounded or idle
+    int threadCount() const;
+
+    /*!
+     * \brief Stops all threads and waits for them to exit.
+     *
+     * Sessions which have been stopped finish on their threads, so busy
+     * threads are given up to aTimeout to be released first. A thread that
+     * does not exit because its plugin does not return is left running.
+     * Must not be called from a pool thread.
+     *
+     * @param aTimeout Time to wait for busy threads, in milliseconds
+     */
+    void shutdown(int aTimeout = 0);
+
+private:
+    PluginThreadPool();
+    ~PluginThreadPool();
+
+    QThread *startThread();
+
+    static void stopThread(QThread *aThread);
+
+    struct Waiter {
+        QPointer<QObject> iObject;
+        QByteArray iMember;
+    };
+
+    mutable QMutex iMutex;
+    QList<QThread *> iIdleThreads;
+    QList<QThread *> iBusyThreads;
+    QList<QThread *> iUnboundedThreads;
+    QList<Waiter> iWaiters;
+    QWaitCondition iReleased;
+    int iMaxThreads;
+    int iWaitTimeout;
+    int iSerial;
+
+    Q_DISABLE_COPY(PluginThreadPool)
+};
+
+}
+
+#endif // PLUGINTHREADPOOL_H
@@ -0,0 +1,133 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "RfcommServiceRecord.h"
+#include "LogMacros.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QRegularExpression>
+
+using namespace Buteo;
+
+const QString RfcommServiceRecord::DEFAULT_SERVICE_UUID = QStringLiteral("00000002-0000-1000-8000-0002ee000002");
+
+static const QString BLUEZ_SERVICE = QStringLiteral("org.bluez");
+static const QString BLUEZ_PATH = QStringLiteral("/org/bluez");
+static const QString BLUEZ_PROFILE_MANAGER = QStringLiteral("org.bluez.ProfileManager1");
+static const QString RECORD_PATH_PREFIX = QStringLiteral("/com/meego/msyncd/rfcomm/");
+
+RfcommServiceRecord::RfcommServiceRecord(const QString &aServerName, int aChannel,
+                                         const QString &aServiceUuid, QObject *aParent)
+    : QObject(aParent)
+    , iRegistered(false)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    const QString uuid = aServiceUuid.isEmpty() ? DEFAULT_SERVICE_UUID : aServiceUuid;
+    iPath = RECORD_PATH_PREFIX + QString(aServerName).replace(QRegularExpression("[^A-Za-z0-9_]"), "_");
+
+    QDBusConnection dbus = QDBusConnection::systemBus();
+    if (!dbus.registerObject(iPath, this, QDBusConnection::ExportAllSlots)) {
+        qCWarning(lcButeoMsyncd) << "Failed to register SDP record object for" << aServerName;
+        return;
+    }
+    iRegistered = true;
+
+    QVariantMap options;
+    options.insert(QStringLiteral("Name"), aServerName);
+    options.insert(QStringLiteral("Role"), QStringLiteral("server"));
+    options.insert(QStringLiteral("ServiceRecord"), serviceRecordXml(aServerName, aChannel, uuid));
+
+    QDBusMessage message = QDBusMessage::createMethodCall(BLUEZ_SERVICE, BLUEZ_PATH,
+                                                          BLUEZ_PROFILE_MANAGER, QStringLiteral("RegisterProfile"));
+    message << QVariant::fromValue(QDBusObjectPath(iPath)) << uuid << options;
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(dbus.asyncCall(message), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [aServerName, aChannel](QDBusPendingCallWatcher *aWatcher) {
+        QDBusPendingReply<> reply = *aWatcher;
+        if (reply.isError()) {
+            qCWarning(lcButeoMsyncd) << "Failed to register SDP record for RFCOMM channel" << aChannel
+                                     << ":" << reply.error().message();
+        } else {
+            qCDebug(lcButeoMsyncd) << "Registered SDP record of" << aServerName << "for RFCOMM channel" << aChannel;
+        }
+        aWatcher->deleteLater();
+    });
+}
+
+RfcommServiceRecord::~RfcommServiceRecord()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iRegistered) {
+        QDBusConnection dbus = QDBusConnection::systemBus();
+        QDBusMessage message = QDBusMessage::createMethodCall(BLUEZ_SERVICE, BLUEZ_PATH,
+                                                              BLUEZ_PROFILE_MANAGER, QStringLiteral("UnregisterProfile"));
+        message << QVariant::fromValue(QDBusObjectPath(iPath));
+        dbus.send(message);
+        dbus.unregisterObject(iPath);
+    }
+}
+
+QString RfcommServiceRecord::serviceRecordXml(const QString &aName, int aChannel, const QString &aServiceUuid)
+{
+    // Service class, L2CAP/RFCOMM/OBEX protocol stack, public browse group
+    // and service name
+    return QStringLiteral(
+               "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"
+               "<record>"
+               "<attribute id=\"0x0001\"><sequence><uuid value=\"%1\"/></sequence></attribute>"
+               "<attribute id=\"0x0004\"><sequence>"
+               "<sequence><uuid value=\"0x0100\"/></sequence>"
+               "<sequence><uuid value=\"0x0003\"/><uint8 value=\"0x%2\"/></sequence>"
+               "<sequence><uuid value=\"0x0008\"/></sequence>"
+               "</sequence></attribute>"
+               "<attribute id=\"0x0005\"><sequence><uuid value=\"0x1002\"/></sequence></attribute>"
+               "<attribute id=\"0x0100\"><text value=\"%3\"/></attribute>"
+               "</record>")
+           .arg(aServiceUuid)
+           .arg(aChannel, 2, 16, QLatin1Char('0'))
+           .arg(aName.toHtmlEscaped());
+}
+
+void RfcommServiceRecord::Release()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    qCDebug(lcButeoMsyncd) << "BlueZ released SDP record" << iPath;
+}
+
+void RfcommServiceRecord::NewConnection(const QDBusObjectPath &aDevice, const QDBusUnixFileDescriptor &aFd,
+                                        const QVariantMap &aProperties)
+{
+    Q_UNUSED(aFd);
+    Q_UNUSED(aProperties);
+
+    qCWarning(lcButeoMsyncd) << "Ignoring connection passed by BlueZ from" << aDevice.path();
+}
+
+void RfcommServiceRecord::RequestDisconnection(const QDBusObjectPath &aDevice)
+{
+    Q_UNUSED(aDevice);
+}
@@ -0,0 +1,87 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#ifndef RFCOMMSERVICERECORD_H
+#define RFCOMMSERVICERECORD_H
+
+#include <QDBusObjectPath>
+#include <QDBusUnixFileDescriptor>
+#include <QObject>
+#include <QString>
+#include <QVariantMap>
+
+namespace Buteo {
+
+/*! \brief Advertises an RFCOMM channel msyncd listens on in SDP.
+ *
+ * Remote devices look up the channel of a server from its SDP record, so
+ * a record is registered for as long as ServerListener keeps the channel
+ * open. The record is registered to BlueZ as an external profile without
+ * a channel option, which keeps bluetoothd from binding the channel
+ * itself. Registration is best effort: without BlueZ the channel can
+ * still be reached by devices that know it.
+ */
+class RfcommServiceRecord : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.bluez.Profile1")
+
+public:
+    //! SyncML server service class, used when the profile sets no UUID
+    static const QString DEFAULT_SERVICE_UUID;
+
+    /*! \brief Constructor, registers the record on the system bus
+     *
+     * @param aServerName Server profile name, used as the service name
+     * @param aChannel RFCOMM channel
+     * @param aServiceUuid Service class UUID, DEFAULT_SERVICE_UUID if empty
+     * @param aParent Parent object
+     */
+    RfcommServiceRecord(const QString &aServerName, int aChannel, const QString &aServiceUuid,
+                        QObject *aParent = nullptr);
+
+    //! \brief Destructor, unregisters the record
+    virtual ~RfcommServiceRecord();
+
+    /*! \brief Builds the SDP record in the BlueZ XML format
+     *
+     * @param aName Service name
+     * @param aChannel RFCOMM channel
+     * @param aServiceUuid Service class UUID
+     * @return SDP record
+     */
+    static QString serviceRecordXml(const QString &aName, int aChannel, const QString &aServiceUuid);
+
+public slots:
+    // org.bluez.Profile1, bluetoothd does not listen for this profile so
+    // connections are never passed here.
+    void Release();
+    void NewConnection(const QDBusObjectPath &aDevice, const QDBusUnixFileDescriptor &aFd,
+                       const QVariantMap &aProperties);
+    void RequestDisconnection(const QDBusObjectPath &aDevice);
+
+private:
+    QString iPath;
+    bool iRegistered;
+};
+
+}
+
+#endif // RFCOMMSERVICERECORD_H
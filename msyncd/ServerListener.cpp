@@ -0,0 +1,226 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "ServerListener.h"
+#include "PluginRunner.h"
+#include "RfcommServiceRecord.h"
+#include "LogMacros.h"
+
+#include <QFile>
+#include <QSocketNotifier>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace Buteo;
+
+static const QString RFCOMM_PREFIX = QStringLiteral("rfcomm:");
+static const QString USB_PREFIX = QStringLiteral("usb:");
+static const int MAX_RFCOMM_CHANNEL = 30;
+static const int LISTEN_BACKLOG = 1;
+
+// From <bluetooth/rfcomm.h>, BlueZ headers are not a build dependency.
+static const int RFCOMM_PROTOCOL = 3;
+struct RfcommAddress {
+    sa_family_t iFamily;
+    quint8 iAddress[6];
+    quint8 iChannel;
+};
+
+ServerListener::ServerListener(const QString &aServerName, const QString &aEndpoint, QObject *aParent)
+    : QObject(aParent)
+    , iServerName(aServerName)
+    , iEndpoint(aEndpoint)
+    , iFd(-1)
+    , iSocket(false)
+    , iNotifier(nullptr)
+    , iServiceRecord(nullptr)
+    , iIdleTimeout(0)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iIdleTimer.setSingleShot(true);
+    connect(&iIdleTimer, &QTimer::timeout, this, [this] {
+        emit idle(iServerName);
+    });
+}
+
+ServerListener::~ServerListener()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    close();
+}
+
+QString ServerListener::serverName() const
+{
+    return iServerName;
+}
+
+QString ServerListener::endpoint() const
+{
+    return iEndpoint;
+}
+
+void ServerListener::setIdleTimeout(int aTimeout)
+{
+    iIdleTimeout = qMax(0, aTimeout);
+}
+
+void ServerListener::setServiceUuid(const QString &aUuid)
+{
+    iServiceUuid = aUuid;
+}
+
+bool ServerListener::listen()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iIdleTimer.stop();
+
+    if (iFd < 0) {
+        if (iEndpoint.startsWith(RFCOMM_PREFIX)) {
+            bool ok = false;
+            const int channel = iEndpoint.mid(RFCOMM_PREFIX.length()).toInt(&ok);
+            if (!ok || channel < 1 || channel > MAX_RFCOMM_CHANNEL) {
+                qCWarning(lcButeoMsyncd) << "Invalid RFCOMM channel in endpoint" << iEndpoint;
+                return false;
+            }
+            iFd = openRfcomm(channel);
+            iSocket = true;
+            if (iFd >= 0) {
+                iServiceRecord = new RfcommServiceRecord(iServerName, channel, iServiceUuid, this);
+            }
+        } else if (iEndpoint.startsWith(USB_PREFIX)) {
+            iFd = openDevice(iEndpoint.mid(USB_PREFIX.length()));
+            iSocket = false;
+        } else {
+            qCWarning(lcButeoMsyncd) << "Unsupported server endpoint" << iEndpoint;
+            return false;
+        }
+
+        if (iFd < 0) {
+            return false;
+        }
+
+        iNotifier = new QSocketNotifier(iFd, QSocketNotifier::Read, this);
+        connect(iNotifier, &QSocketNotifier::activated, this, &ServerListener::onActivity);
+    }
+
+    iNotifier->setEnabled(true);
+    return true;
+}
+
+bool ServerListener::isListening() const
+{
+    return iNotifier && iNotifier->isEnabled();
+}
+
+void ServerListener::close()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    delete iNotifier;
+    iNotifier = nullptr;
+    delete iServiceRecord;
+    iServiceRecord = nullptr;
+
+    if (iFd >= 0) {
+        ::close(iFd);
+        iFd = -1;
+    }
+}
+
+int ServerListener::socketDescriptor() const
+{
+    return iSocket ? iFd : -1;
+}
+
+void ServerListener::watch(PluginRunner *aRunner)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    connect(aRunner, &PluginRunner::newSession, this, &ServerListener::onSessionStarted);
+    connect(aRunner, &PluginRunner::success, this, &ServerListener::onSessionFinished);
+    connect(aRunner, &PluginRunner::error, this, &ServerListener::onSessionFinished);
+}
+
+void ServerListener::onActivity()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    // Nothing is read or accepted here, the connection is the plug-in's.
+    iNotifier->setEnabled(false);
+
+    qCDebug(lcButeoMsyncd) << "Connection on" << iEndpoint << "activates server" << iServerName;
+
+    // Unloaded again if the connection does not turn into a session
+    if (iIdleTimeout > 0) {
+        iIdleTimer.start(iIdleTimeout);
+    }
+    emit activated(iServerName);
+}
+
+void ServerListener::onSessionStarted()
+{
+    iIdleTimer.stop();
+}
+
+void ServerListener::onSessionFinished()
+{
+    if (iIdleTimeout > 0) {
+        iIdleTimer.start(iIdleTimeout);
+    }
+}
+
+int ServerListener::openRfcomm(int aChannel) const
+{
+    const int fd = ::socket(AF_BLUETOOTH, SOCK_STREAM | SOCK_CLOEXEC, RFCOMM_PROTOCOL);
+    if (fd < 0) {
+        qCWarning(lcButeoMsyncd) << "Failed to create RFCOMM socket:" << strerror(errno);
+        return -1;
+    }
+
+    RfcommAddress address;
+    memset(&address, 0, sizeof(address));
+    address.iFamily = AF_BLUETOOTH;
+    address.iChannel = static_cast<quint8>(aChannel);
+
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+            || ::listen(fd, LISTEN_BACKLOG) != 0) {
+        qCWarning(lcButeoMsyncd) << "Failed to listen on RFCOMM channel" << aChannel << ":" << strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int ServerListener::openDevice(const QString &aPath) const
+{
+    const int fd = ::open(QFile::encodeName(aPath).constData(), O_RDONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0) {
+        qCWarning(lcButeoMsyncd) << "Failed to open" << aPath << ":" << strerror(errno);
+    }
+    return fd;
+}
@@ -0,0 +1,175 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef SERVERLISTENER_H
+#define SERVERLISTENER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class QSocketNotifier;
+
+namespace Buteo {
+
+class PluginRunner;
+class RfcommServiceRecord;
+
+/*!
+ * \brief Waits for connections on behalf of an unloaded server plug-in.
+ *
+ * Server profiles may declare the endpoint their plug-in listens on with
+ * the listen_endpoint key. Instead of loading the plug-in when its
+ * transport becomes available, msyncd opens the endpoint itself and only
+ * loads the plug-in once a connection arrives. The plug-in is unloaded
+ * again when it has not had a session for the idle timeout.
+ *
+ * Supported endpoints:
+ * - rfcomm:<channel> listens on a Bluetooth RFCOMM channel and advertises
+ *   it in an SDP record with the listen_service_uuid key as service class.
+ *   The listening socket is handed to the plug-in, in process or out of
+ *   process, which accepts the pending connection.
+ * - usb:<device> watches a USB function device node, for example
+ *   usb:/dev/ttyGS0. The listener never reads from it, so the data which
+ *   woke it up is left for the plug-in.
+ */
+class ServerListener : public QObject
+{
+    Q_OBJECT
+
+public:
+    /*!
+     * \brief Constructor
+     *
+     * @param aServerName Server profile name
+     * @param aEndpoint Endpoint from the listen_endpoint key
+     * @param aParent Parent object
+     */
+    ServerListener(const QString &aServerName, const QString &aEndpoint, QObject *aParent = nullptr);
+
+    //! \brief Destructor, closes the endpoint
+    virtual ~ServerListener();
+
+    //! Server profile name
+    QString serverName() const;
+
+    //! Endpoint the listener was created for
+    QString endpoint() const;
+
+    /*!
+     * \brief Sets how long an activated plug-in may go without a session
+     *
+     * @param aTimeout Timeout in milliseconds, 0 keeps the plug-in loaded
+     */
+    void setIdleTimeout(int aTimeout);
+
+    /*!
+     * \brief Sets the service class advertised for an RFCOMM endpoint
+     *
+     * Takes effect when the endpoint is opened next.
+     *
+     * @param aUuid Service class UUID, empty for the SyncML server class
+     */
+    void setServiceUuid(const QString &aUuid);
+
+    /*!
+     * \brief Starts waiting for a connection
+     *
+     * Opens the endpoint unless it is still open from an earlier call.
+     *
+     * @return False if the endpoint is not supported or cannot be opened
+     */
+    bool listen();
+
+    //! Returns true while waiting for a connection
+    bool isListening() const;
+
+    /*!
+     * \brief Closes the endpoint and removes its SDP record
+     *
+     * Done when the server is stopped or could not be activated.
+     */
+    void close();
+
+    /*!
+     * \brief Listening socket to hand to the plug-in
+     *
+     * The descriptor stays owned by the listener and is kept open between
+     * activations, so plug-ins must not close it. Out-of-process plug-ins
+     * get a duplicate of it.
+     *
+     * @return Socket descriptor, or -1 if the endpoint is not open or is
+     *  one the plug-in opens itself
+     */
+    int socketDescriptor() const;
+
+    /*!
+     * \brief Follows the sessions of the activated plug-in
+     *
+     * The idle timeout is stopped while a session is running and
+     * restarted when it finishes.
+     *
+     * @param aRunner Runner of the activated server plug-in
+     */
+    void watch(PluginRunner *aRunner);
+
+signals:
+    /*!
+     * \brief Emitted when a connection arrives
+     *
+     * The listener stops watching the endpoint until listen() is called
+     * again, normally after the plug-in has been unloaded.
+     *
+     * @param aServerName Server profile name
+     */
+    void activated(const QString &aServerName);
+
+    /*!
+     * \brief Emitted when the activated plug-in has been idle for the idle
+     *  timeout and should be unloaded
+     *
+     * @param aServerName Server profile name
+     */
+    void idle(const QString &aServerName);
+
+private slots:
+    void onActivity();
+    void onSessionStarted();
+    void onSessionFinished();
+
+private:
+    int openRfcomm(int aChannel) const;
+    int openDevice(const QString &aPath) const;
+
+    QString iServerName;
+    QString iEndpoint;
+    int iFd;
+    bool iSocket;
+    QSocketNotifier *iNotifier;
+    QString iServiceUuid;
+    RfcommServiceRecord *iServiceRecord;
+    QTimer iIdleTimer;
+    int iIdleTimeout;
+};
+
+}
+
+#endif // SERVERLISTENER_H
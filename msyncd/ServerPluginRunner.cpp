@@ -26,6 +26,7 @@
 #include "ServerActivator.h"
 #include "ServerPlugin.h"
 #include "LogMacros.h"
+#include "TraceRecorder.h"
 #include "PluginManager.h"
 
 using namespace Buteo;
@@ -38,6 +39,7 @@ ServerPluginRunner::ServerPluginRunner(const QString &aPluginName,
     , iPlugin(nullptr)
     , iThread(nullptr)
     , iServerActivator(aServerActivator)
+    , iStartPending(false)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 }
@@ -112,6 +114,8 @@ bool ServerPluginRunner::init()
 
     connect(iThread, SIGNAL(finished()), this, SLOT(onThreadExit()));
 
+    watchPluginStart();
+
     iInitialized = true;
 
     return true;
@@ -121,8 +125,17 @@ bool ServerPluginRunner::start()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    TraceScope traceScope("ServerPluginRunner::start", "plugin", iPlugin ? iPlugin->getProfileName() : QString());
+
     bool rv = false;
     if (iInitialized && iThread) {
+        if (!isReady()) {
+            // The thread is started from onPluginReady()
+            qCDebug(lcButeoMsyncd) << "Plugin process for" << iPlugin->getProfileName()
+                                   << "is still starting, deferring start";
+            iStartPending = true;
+            return true;
+        }
         rv = iThread->startThread(iPlugin);
         qCDebug(lcButeoMsyncd) << "ServerPluginRunner started thread for plugin:" << iPlugin->getProfileName()
                                << ", returning:" << rv;
@@ -138,6 +151,13 @@ void ServerPluginRunner::stop()
     // Disconnect all signals from this object to the plug-in.
     disconnect(this, 0, iPlugin, 0);
 
+    if (iStartPending) {
+        // No thread will finish, so report being done once control
+        // returns to the event loop.
+        iStartPending = false;
+        QMetaObject::invokeMethod(this, "onThreadExit", Qt::QueuedConnection);
+    }
+
     if (iThread) {
         iThread->stopThread();
         iThread->wait();
@@ -194,12 +214,37 @@ bool ServerPluginRunner::cleanUp()
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     bool retval = false;
+    if (!isReady()) {
+        qCWarning(lcButeoMsyncd) << "Plugin process has not started, cannot clean up";
+        return retval;
+    }
+
     if (iPlugin) {
         retval = iPlugin->cleanUp();
     }
     return retval;
 }
 
+void ServerPluginRunner::onPluginReady(bool aSuccess)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!iStartPending) {
+        return;
+    }
+    iStartPending = false;
+
+    if (!aSuccess) {
+        emit error(iProfile->name(), "Plugin process failed to start", SyncResults::PLUGIN_ERROR);
+        emit done();
+    } else if (!iThread->startThread(iPlugin)) {
+        emit error(iProfile->name(), "Failed to start plugin thread", SyncResults::INTERNAL_ERROR);
+        emit done();
+    } else {
+        qCDebug(lcButeoMsyncd) << "ServerPluginRunner started thread for plugin:" << iPlugin->getProfileName();
+    }
+}
+
 void ServerPluginRunner::onNewSession(const QString &aDestination)
 {
     // Add reference to the server plug-in, so that the plug-in
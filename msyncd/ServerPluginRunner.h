@@ -85,6 +85,10 @@ public:
     // Resume a suspended server plug-in
     void resume();
 
+protected:
+    //! @see PluginRunner::onPluginReady
+    virtual void onPluginReady(bool aSuccess);
+
 private slots:
     // Slots for catching plug-in signals.
     void onNewSession(const QString &aDestination);
@@ -106,6 +110,9 @@ private:
     ServerThread *iThread;
     ServerActivator *iServerActivator;
 
+    // start() was called before the plug-in process was ready
+    bool iStartPending;
+
 #ifdef SYNCFW_UNIT_TESTS
     friend class ServerPluginRunnerTest;
 #endif
@@ -22,9 +22,12 @@
  */
 #include "ServerThread.h"
 #include "ServerPlugin.h"
+#include "PluginThreadPool.h"
 #include "LogMacros.h"
 #include <QMutexLocker>
 #include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
 
 using namespace Buteo;
 
@@ -32,6 +35,10 @@ using namespace Buteo;
 ServerThread::ServerThread()
     : iServerPlugin(nullptr)
     , iRunning(false)
+    , iThread(nullptr)
+    , iContext(nullptr)
+    , iActive(false)
+    , iStopping(false)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 }
@@ -39,6 +46,8 @@ ServerThread::ServerThread()
 ServerThread::~ServerThread()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+    stopThread();
+    wait();
 }
 
 QString ServerThread::getProfileName() const
@@ -79,10 +88,7 @@ bool ServerThread::startThread(ServerPlugin *aServerPlugin)
 
     iServerPlugin = aServerPlugin;
 
-    // Move to server thread
-    iServerPlugin->moveToThread(this);
-
-    start();
+    startSession();
 
     return true;
 }
@@ -90,41 +96,104 @@ bool ServerThread::startThread(ServerPlugin *aServerPlugin)
 void ServerThread::stopThread()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
-    exit();
+
+    QMutexLocker locker(&iMutex);
+    if (iActive) {
+        if (iContext && !iStopping) {
+            iStopping = true;
+            QTimer::singleShot(0, iContext, [this]() {
+                finishSession(true);
+            });
+        }
+    }
 }
 
-void ServerThread::run()
+bool ServerThread::wait(unsigned long aTime)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    if (iServerPlugin == 0) {
-        qCCritical(lcButeoMsyncd) << "Server plug-in is NULL";
-        return;
+    QMutexLocker locker(&iMutex);
+    while (iActive) {
+        if (!iFinished.wait(&iMutex, aTime)) {
+            return false;
+        }
     }
+    return true;
+}
+
+void ServerThread::startSession()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QMutexLocker locker(&iMutex);
+
+    // A listening plugin keeps its thread until it is stopped, so it does
+    // not take one of the threads bounded for client sessions.
+    iThread = PluginThreadPool::instance()->acquireUnbounded();
+    iActive = true;
+    iStopping = false;
+
+    iContext = new QObject;
+    iContext->moveToThread(iThread);
+
+    // Move to the worker thread
+    iServerPlugin->moveToThread(iThread);
+    QTimer::singleShot(0, iContext, [this]() {
+        runSession();
+    });
+}
+
+void ServerThread::runSession()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
 
     if (!iServerPlugin->init()) {
         qCWarning(lcButeoMsyncd) << "Could not initialize server plugin:" << iServerPlugin->getPluginName();
         emit initError(iServerPlugin->getProfileName(), "", SyncResults::PLUGIN_ERROR);
+        finishSession(false);
         return;
     }
 
     if (!iServerPlugin->startListen()) {
         qCWarning(lcButeoMsyncd) << "Could not start server plugin:" << iServerPlugin->getPluginName();
         emit initError(iServerPlugin->getProfileName(), "", SyncResults::PLUGIN_ERROR);
+        finishSession(false);
         return;
     }
 
-    exec();
+    // The plugin now runs in the event loop of the worker thread, until
+    // stopThread() queues finishSession()
+}
+
+void ServerThread::finishSession(bool aListening)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
 
-    iServerPlugin->stopListen();
+    if (aListening) {
+        iServerPlugin->stopListen();
 
-    iServerPlugin->uninit();
+        iServerPlugin->uninit();
+    }
 
     // Move back to application thread
     iServerPlugin->moveToThread(QCoreApplication::instance()->thread());
 
+    QThread *thread = nullptr;
     {
+        // Calls still queued through the context are dropped with it
         QMutexLocker locker(&iMutex);
-        iRunning = false;
+        delete iContext;
+        iContext = nullptr;
+        thread = iThread;
+        iThread = nullptr;
     }
+
+    PluginThreadPool::instance()->release(thread);
+
+    emit finished();
+
+    QMutexLocker locker(&iMutex);
+    iRunning = false;
+    iActive = false;
+    iFinished.wakeAll();
 }
@@ -23,19 +23,27 @@
 #ifndef SERVERTHREAD_H
 #define SERVERTHREAD_H
 
-#include <QThread>
+#include <QObject>
 #include <QMutex>
+#include <QWaitCondition>
 
 #include <SyncResults.h>
 
+#include <climits>
+
+class QThread;
+
 namespace Buteo {
 
 class ServerPlugin;
 
-/*! \brief Thread for server plugin
+/*! \brief Runs a server plugin on a worker thread
  *
+ * The thread is checked out from PluginThreadPool when the plugin starts
+ * listening and returned to it when the plugin stops. It does not count
+ * against the pool's limit, so the plugin never waits for it.
  */
-class ServerThread : public QThread
+class ServerThread : public QObject
 {
     Q_OBJECT
 
@@ -75,6 +83,15 @@ public:
      */
     void stopThread();
 
+    /*! \brief Waits until the plugin has stopped
+     *
+     * Returns right away if the plugin is not running on a worker thread.
+     *
+     * @param aTime Timeout in milliseconds
+     * @return True if the plugin stopped, false on timeout
+     */
+    bool wait(unsigned long aTime = ULONG_MAX);
+
 signals:
     /*! \brief Emitted when synchronization cannot be started due to an
      *         error in plugin initialization
@@ -86,14 +103,29 @@ signals:
     void initError(const QString &aProfileName, const QString &aMessage,
                    SyncResults::MinorCode aErrorCode);
 
-protected:
-    //! overriding method of QThread::run
-    virtual void run();
+    /*! \brief Emitted from the worker thread when the plugin has stopped
+     */
+    void finished();
 
 private:
+    void startSession();
+
+    void runSession();
+
+    void finishSession(bool aListening);
+
     ServerPlugin *iServerPlugin;
     bool iRunning;
+
+    // Set while the plugin is on a worker thread
+    QThread *iThread;
+    // Lives in iThread while the plugin runs, queued calls are made through it
+    QObject *iContext;
+    bool iActive;
+    bool iStopping;
+
     mutable QMutex iMutex;
+    QWaitCondition iFinished;
 
 #ifdef SYNCFW_UNIT_TESTS
     friend class ServerThreadTest;
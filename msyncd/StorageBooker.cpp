@@ -38,7 +38,8 @@ StorageBooker::~StorageBooker()
 }
 
 bool StorageBooker::reserveStorage(const QString &aStorageName,
-                                   const QString &aClientId)
+                                   const QString &aClientId,
+                                   AccessMode aAccess)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
@@ -48,11 +49,17 @@ bool StorageBooker::reserveStorage(const QString &aStorageName,
 
     if (iStorageMap.contains(aStorageName)) {
         StorageMapItem item = iStorageMap[aStorageName];
-        if (aClientId.isEmpty() || aClientId != item.iClientId) {
-            // Already reserved for different client.
+        if (!isItemAvailable(item, aClientId, aAccess)) {
+            // Already reserved for different client, or a writer is
+            // waiting for the readers to finish.
+            if (aAccess == ACCESS_EXCLUSIVE && item.iAccess == ACCESS_SHARED) {
+                item.iWriterWaiting = true;
+                iStorageMap[aStorageName] = item;
+            }
             success = false;
         } else {
-            // Already reserved for the same client. Increase ref count.
+            // Already reserved for the same client, or shared with other
+            // readers. Increase ref count.
             item.iRefCount++;
             iStorageMap[aStorageName] = item;
             success = true;
@@ -60,7 +67,7 @@ bool StorageBooker::reserveStorage(const QString &aStorageName,
     } else {
         // No reservations for the storage. Add a new entry to the storage
         // reservation map.
-        iStorageMap.insert(aStorageName, aClientId);
+        iStorageMap.insert(aStorageName, StorageMapItem(aClientId, aAccess));
         success = true;
     }
 
@@ -68,19 +75,30 @@ bool StorageBooker::reserveStorage(const QString &aStorageName,
 }
 
 bool StorageBooker::reserveStorages(const QStringList &aStorageNames,
-                                    const QString &aClientId)
+                                    const QString &aClientId,
+                                    AccessMode aAccess)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     QMutexLocker locker(&iMutex);
 
     bool success = false;
-    if (storagesAvailable(aStorageNames, aClientId)) {
+    if (storagesAvailable(aStorageNames, aClientId, aAccess)) {
         foreach (QString storage, aStorageNames) {
-            reserveStorage(storage, aClientId);
+            reserveStorage(storage, aClientId, aAccess);
         }
         success = true;
     } else {
+        if (aAccess == ACCESS_EXCLUSIVE) {
+            // Let the readers of the busy storages know that a writer is
+            // waiting, so that they are drained instead of renewed.
+            foreach (QString storage, aStorageNames) {
+                if (iStorageMap.contains(storage)
+                        && iStorageMap[storage].iAccess == ACCESS_SHARED) {
+                    iStorageMap[storage].iWriterWaiting = true;
+                }
+            }
+        }
         success = false;
     }
 
@@ -122,28 +140,45 @@ void StorageBooker::releaseStorages(const QStringList &aStorageNames)
 }
 
 bool StorageBooker::isStorageAvailable(const QString &aStorageName,
-                                       const QString &aClientId) const
+                                       const QString &aClientId,
+                                       AccessMode aAccess) const
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     QMutexLocker locker(&iMutex);
 
     return (!iStorageMap.contains(aStorageName)
-            || (!aClientId.isEmpty() && (aClientId == iStorageMap[aStorageName].iClientId)));
+            || isItemAvailable(iStorageMap[aStorageName], aClientId, aAccess));
 
 }
 
 bool StorageBooker::storagesAvailable(const QStringList &aStorageNames,
-                                      const QString &aClientId) const
+                                      const QString &aClientId,
+                                      AccessMode aAccess) const
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     QMutexLocker locker(&iMutex);
 
     foreach (QString storage, aStorageNames) {
-        if (!isStorageAvailable(storage, aClientId))
+        if (!isStorageAvailable(storage, aClientId, aAccess))
             return false;
     }
 
     return true;
 }
+
+bool StorageBooker::isItemAvailable(const StorageMapItem &aItem,
+                                    const QString &aClientId,
+                                    AccessMode aAccess) const
+{
+    if (aItem.iAccess == ACCESS_EXCLUSIVE) {
+        // Only the owner of an exclusive reservation may reserve again,
+        // with either access mode.
+        return (!aClientId.isEmpty() && aClientId == aItem.iClientId);
+    }
+
+    // Storage has only readers. Writers always need to wait, readers may
+    // join unless a writer is already waiting.
+    return (aAccess == ACCESS_SHARED && !aItem.iWriterWaiting);
+}
@@ -36,6 +36,15 @@ namespace Buteo {
 class StorageBooker
 {
 public:
+    //! Type of access a client needs to a storage.
+    enum AccessMode {
+        //! Client modifies the storage, no other client may use it meanwhile.
+        ACCESS_EXCLUSIVE,
+
+        //! Client only reads the storage, other readers may use it meanwhile.
+        ACCESS_SHARED
+    };
+
     //! \brief Constructor
     StorageBooker();
 
@@ -50,12 +59,19 @@ public:
      * counter is increased in that case. For each reserve there must be a
      * release call later. Other clients calling reserve for the same storage
      * will fail, while the storage is reserved to some other client.
+     * Shared reservations can be held by any number of clients at the same
+     * time, but they exclude exclusive reservations. Once an exclusive
+     * reservation has failed because of readers, new shared reservations
+     * from other clients are refused until the readers have released the
+     * storage, so that writers do not starve.
      * \param aStorageName Name of the requested storage.
      * \param aClientId ID of the requesting client.
+     * \param aAccess Type of access needed.
      * \return Success indicator.
      */
     bool reserveStorage(const QString &aStorageName,
-                        const QString &aClientId = "");
+                        const QString &aClientId = "",
+                        AccessMode aAccess = ACCESS_EXCLUSIVE);
 
     /*! \brief Tries to reserve multiple storages for the given client.
      *
@@ -65,10 +81,12 @@ public:
      * If the reserve fails, no storages are reserved.
      * \param aStorageNames Names of the storages to reserve.
      * \param aClientId ID of the requesting client.
+     * \param aAccess Type of access needed.
      * \return Success indicator.
      */
     bool reserveStorages(const QStringList &aStorageNames,
-                         const QString &aClientId = "");
+                         const QString &aClientId = "",
+                         AccessMode aAccess = ACCESS_EXCLUSIVE);
 
     /*! \brief Releases the given storage.
      *
@@ -86,40 +104,55 @@ public:
 
     /*! \brief Checks if the given storage is available for the given client.
      *
-     * The storage is available if there are no reservations for it or if the
-     * storage is already reserved for the same client. If the storage is
-     * available, it can be reserved for the client by calling reserve.
+     * The storage is available if there are no reservations for it, if the
+     * storage is already exclusively reserved for the same client, or if
+     * shared access is requested and the storage only has shared
+     * reservations. If the storage is available, it can be reserved for the
+     * client by calling reserve.
      * \param aStorageName Name of the requested storage.
      * \param aClientId ID of the requesting client.
+     * \param aAccess Type of access needed.
      * \return Is the storage available.
      */
     bool isStorageAvailable(const QString &aStorageName,
-                            const QString &aClientId = "") const;
+                            const QString &aClientId = "",
+                            AccessMode aAccess = ACCESS_EXCLUSIVE) const;
 
     /*! \brief Checks if the given storages are available for the given client.
      *
      * \param aStorageNames Names of the requested storages.
      * \param aClientId ID of the requesting client.
+     * \param aAccess Type of access needed.
      * \return Are the storages available.
      */
     bool storagesAvailable(const QStringList &aStorageNames,
-                           const QString &aClientId = "") const;
+                           const QString &aClientId = "",
+                           AccessMode aAccess = ACCESS_EXCLUSIVE) const;
 
 private:
     struct StorageMapItem {
         QString iClientId;
         unsigned iRefCount;
+        AccessMode iAccess;
+        bool iWriterWaiting;
 
         StorageMapItem()
             : iRefCount(0)
+            , iAccess(ACCESS_EXCLUSIVE)
+            , iWriterWaiting(false)
         {}
 
-        StorageMapItem(const QString &aClientId)
+        StorageMapItem(const QString &aClientId, AccessMode aAccess)
             : iClientId(aClientId)
             , iRefCount(1)
+            , iAccess(aAccess)
+            , iWriterWaiting(false)
         {}
     };
 
+    bool isItemAvailable(const StorageMapItem &aItem, const QString &aClientId,
+                         AccessMode aAccess) const;
+
     QMap<QString, StorageMapItem> iStorageMap;
     mutable QMutex iMutex;
 };
@@ -88,6 +88,15 @@ bool SyncDBusAdaptor::isConnectivityAvailable(int connectivityType)
     return out0;
 }
 
+Buteo::SyncResults SyncDBusAdaptor::lastSyncResults(const QString &aProfileId)
+{
+    // handle method call com.meego.msyncd.lastSyncResults
+    Buteo::SyncResults out0;
+    QMetaObject::invokeMethod(parent(), "lastSyncResults", Q_RETURN_ARG(Buteo::SyncResults, out0),
+                              Q_ARG(QString, aProfileId));
+    return out0;
+}
+
 void SyncDBusAdaptor::releaseStorages(const QStringList &aStorageNames)
 {
     // handle method call com.meego.msyncd.releaseStorages
@@ -136,6 +145,15 @@ bool SyncDBusAdaptor::setSyncSchedule(const QString &aProfileId, const QString &
     return out0;
 }
 
+bool SyncDBusAdaptor::storeSyncResults(const QString &aProfileId, const Buteo::SyncResults &aSyncResults)
+{
+    // handle method call com.meego.msyncd.storeSyncResults
+    bool out0;
+    QMetaObject::invokeMethod(parent(), "storeSyncResults", Q_RETURN_ARG(bool, out0), Q_ARG(QString, aProfileId),
+                              Q_ARG(Buteo::SyncResults, aSyncResults));
+    return out0;
+}
+
 void SyncDBusAdaptor::start(uint aAccountId)
 {
     // handle method call com.meego.msyncd.start
@@ -27,6 +27,7 @@
 
 #include <QtCore/QObject>
 #include <QtDBus/QtDBus>
+#include <SyncResults.h>
 class QByteArray;
 template<class T> class QList;
 template<class Key, class Value> class QMap;
@@ -69,6 +70,11 @@ class SyncDBusAdaptor: public QDBusAbstractAdaptor
                 "      <arg direction=\"out\" type=\"s\" name=\"aProfileName\"/>\n"
                 "      <arg direction=\"out\" type=\"s\" name=\"aResultsAsXml\"/>\n"
                 "    </signal>\n"
+                "    <signal name=\"syncResultsAvailable\">\n"
+                "      <arg direction=\"out\" type=\"s\" name=\"aProfileName\"/>\n"
+                "      <arg direction=\"out\" type=\"(xiisba(s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis)))\" name=\"aResults\"/>\n"
+                "      <annotation value=\"Buteo::SyncResults\" name=\"org.qtproject.QtDBus.QtTypeName.Out1\"/>\n"
+                "    </signal>\n"
                 "    <signal name=\"statusChanged\">\n"
                 "      <arg direction=\"out\" type=\"u\" name=\"aAccountId\"/>\n"
                 "      <arg direction=\"out\" type=\"i\" name=\"aNewStatus\"/>\n"
@@ -129,6 +135,17 @@ class SyncDBusAdaptor: public QDBusAbstractAdaptor
                 "      <arg direction=\"out\" type=\"s\"/>\n"
                 "      <arg direction=\"in\" type=\"s\" name=\"aProfileId\"/>\n"
                 "    </method>\n"
+                "    <method name=\"storeSyncResults\">\n"
+                "      <arg direction=\"out\" type=\"b\"/>\n"
+                "      <arg direction=\"in\" type=\"s\" name=\"aProfileId\"/>\n"
+                "      <arg direction=\"in\" type=\"(xiisba(s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis)))\" name=\"aSyncResults\"/>\n"
+                "      <annotation value=\"Buteo::SyncResults\" name=\"org.qtproject.QtDBus.QtTypeName.In1\"/>\n"
+                "    </method>\n"
+                "    <method name=\"lastSyncResults\">\n"
+                "      <arg direction=\"out\" type=\"(xiisba(s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis)))\"/>\n"
+                "      <annotation value=\"Buteo::SyncResults\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+                "      <arg direction=\"in\" type=\"s\" name=\"aProfileId\"/>\n"
+                "    </method>\n"
                 "    <method name=\"allVisibleSyncProfiles\">\n"
                 "      <arg direction=\"out\" type=\"as\"/>\n"
                 "    </method>\n"
@@ -190,12 +207,14 @@ public Q_SLOTS: // METHODS
     bool getBackUpRestoreState();
     QString getLastSyncResult(const QString &aProfileId);
     bool isConnectivityAvailable(int connectivityType);
+    Buteo::SyncResults lastSyncResults(const QString &aProfileId);
     Q_NOREPLY void releaseStorages(const QStringList &aStorageNames);
     bool removeProfile(const QString &aProfileId);
     bool requestStorages(const QStringList &aStorageNames);
     QStringList runningSyncs();
     bool saveSyncResults(const QString &aProfileId, const QString &aSyncResults);
     bool setSyncSchedule(const QString &aProfileId, const QString &aScheduleAsXml);
+    bool storeSyncResults(const QString &aProfileId, const Buteo::SyncResults &aSyncResults);
     Q_NOREPLY void start(uint aAccountId);
     bool startSync(const QString &aProfileId);
     int status(uint aAccountId, int &aFailedReason, qlonglong &aPrevSyncTime, qlonglong &aNextSyncTime);
@@ -215,6 +234,7 @@ Q_SIGNALS: // SIGNALS
     void restoreInProgress();
     void resultsAvailable(const QString &aProfileName, const QString &aResultsAsXml);
     void signalProfileChanged(const QString &aProfileName, int aChangeType, const QString &aProfileAsXml);
+    void syncResultsAvailable(const QString &aProfileName, const Buteo::SyncResults &aResults);
     void statusChanged(uint aAccountId, int aNewStatus, int aFailedReason, qlonglong aPrevSyncTime,
                        qlonglong aNextSyncTime);
     void syncStatus(const QString &aProfileName, int aStatus, const QString &aMessage, int aMoreDetails);
@@ -29,6 +29,8 @@
 #include <QString>
 #include <QList>
 
+#include "SyncResults.h"
+
 namespace Buteo {
 
 /*!
@@ -141,6 +143,14 @@ signals:
      */
     void resultsAvailable(QString aProfileName, QString aResultsAsXml);
 
+    /*! \brief Same as resultsAvailable(), with the results as a D-Bus
+     * structure instead of xml.
+     *
+     * \param aProfileName Name of the profile for which results are available
+     * \param aResults Results of the sync
+     */
+    void syncResultsAvailable(QString aProfileName, Buteo::SyncResults aResults);
+
     /*! \brief Notifies sync status change for a set of account Ids
      *
      * This signal is sent when the status of a sync for a particular
@@ -292,6 +302,22 @@ public slots:
      */
     virtual QString getLastSyncResult(const QString &aProfileId) = 0;
 
+    /*!
+     * \brief Same as saveSyncResults(), with the results as a D-Bus
+     * structure instead of xml.
+     * \param aProfileId to save result in corresponding file.
+     * \param aSyncResults to save in the \code <profileId>.log.xml. \endcode
+     * \return status of the storeSyncResults
+     */
+    virtual bool storeSyncResults(QString aProfileId, Buteo::SyncResults aSyncResults) = 0;
+
+    /*! \brief Same as getLastSyncResult(), with the results as a D-Bus
+     *  structure instead of xml.
+     *  \param aProfileId
+     *  \return Last results, with an invalid sync time if there are none.
+     */
+    virtual Buteo::SyncResults lastSyncResults(const QString &aProfileId) = 0;
+
     /*! \brief Gets all visible sync profiles.
      *
      * Returns all sync profiles that should be visible in sync ui. A profile
@@ -23,16 +23,40 @@
 #include "SyncQueue.h"
 #include "SyncSession.h"
 #include "SyncProfile.h"
+#include "ProfileEngineDefs.h"
 #include "LogMacros.h"
+#include "Metrics.h"
+#include <QDateTime>
 
 using namespace Buteo;
 
+static void updateQueueLengthGauge(int aLength)
+{
+    static MetricsGauge *gauge = Metrics::instance()->gauge(QStringLiteral("msyncd_queue_length"));
+    gauge->set(aLength);
+}
+
+static const int DEFAULT_MAX_RUNNING_PER_ACCOUNT = 2;
+
+SyncQueue::SyncQueue()
+    : iMaxRunningPerAccount(DEFAULT_MAX_RUNNING_PER_ACCOUNT)
+{
+}
+
 void SyncQueue::enqueue(SyncSession *aSession)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    QString account = accountOf(aSession);
+    if (!iAccountOrder.contains(account)) {
+        iAccountOrder.append(account);
+    }
+    iEnqueueTimes.insert(aSession, QDateTime::currentMSecsSinceEpoch());
+
     iItems.enqueue(aSession);
     sort();
+
+    updateQueueLengthGauge(iItems.size());
 }
 
 SyncSession *SyncQueue::dequeue()
@@ -41,8 +65,25 @@ SyncSession *SyncQueue::dequeue()
 
     SyncSession *p = nullptr;
 
-    if (!iItems.isEmpty()) {
-        p = iItems.dequeue();
+    int index = indexOfHead();
+    if (index >= 0) {
+        p = iItems.takeAt(index);
+
+        // Served account goes to the back of the rotation.
+        QString account = accountOf(p);
+        iAccountOrder.removeOne(account);
+        if (hasQueuedSessions(account)) {
+            iAccountOrder.append(account);
+        }
+
+        qint64 waitMs = QDateTime::currentMSecsSinceEpoch() - iEnqueueTimes.take(p);
+        static MetricsHistogram *waitHistogram = Metrics::instance()->histogram(
+                    QStringLiteral("msyncd_queue_wait_ms"));
+        waitHistogram->record(waitMs);
+        updateQueueLengthGauge(iItems.size());
+
+        qCDebug(lcButeoMsyncd) << "Dispatching queued session for account" << account
+                               << "after" << waitMs << "ms";
     }
 
     return p;
@@ -57,6 +98,13 @@ SyncSession *SyncQueue::dequeue(const QString &aProfileName)
         if ((*i)->profileName() == aProfileName) {
             ret = *i;
             iItems.erase(i);
+            iEnqueueTimes.remove(ret);
+            updateQueueLengthGauge(iItems.size());
+
+            QString account = accountOf(ret);
+            if (!hasQueuedSessions(account)) {
+                iAccountOrder.removeOne(account);
+            }
             break;
         }
     }
@@ -68,8 +116,9 @@ SyncSession *SyncQueue::head()
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     SyncSession *p = nullptr;
-    if (!iItems.isEmpty()) {
-        p = iItems.head();
+    int index = indexOfHead();
+    if (index >= 0) {
+        p = iItems.at(index);
     }
 
     return p;
@@ -136,3 +185,122 @@ const QList<SyncSession *> &SyncQueue::getQueuedSyncSessions() const
     FUNCTION_CALL_TRACE(lcButeoTrace);
     return iItems;
 }
+
+qint64 SyncQueue::enqueueTime(const SyncSession *aSession) const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    return iEnqueueTimes.value(aSession, 0);
+}
+
+void SyncQueue::setMaxRunningPerAccount(int aMax)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iMaxRunningPerAccount = aMax;
+}
+
+bool SyncQueue::canStart(const SyncSession *aSession) const
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    // Profiles without an account are unrelated to each other, so they are
+    // not held back by the per-account limit.
+    QString account = accountOf(aSession);
+    return (iMaxRunningPerAccount <= 0 || account.isEmpty()
+            || iRunningCounts.value(account) < iMaxRunningPerAccount);
+}
+
+void SyncQueue::sessionStarted(const SyncSession *aSession)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (aSession && !iRunningSessions.contains(aSession)) {
+        QString account = accountOf(aSession);
+        iRunningSessions.insert(aSession, account);
+        iRunningCounts[account]++;
+    }
+}
+
+void SyncQueue::sessionFinished(const SyncSession *aSession)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iRunningSessions.contains(aSession)) {
+        QString account = iRunningSessions.take(aSession);
+        if (--iRunningCounts[account] <= 0) {
+            iRunningCounts.remove(account);
+        }
+    }
+}
+
+int SyncQueue::indexOfHead() const
+{
+    // Only sessions of the highest priority class that can be started
+    // compete, so that e.g. a manual sync is never held back by scheduled
+    // syncs of other accounts.
+    int best = -1;
+    for (int i = 0; i < iItems.size(); ++i) {
+        if (!canStart(iItems.at(i))) {
+            continue;
+        }
+        int priority = priorityOf(iItems.at(i));
+        if (best < 0 || priority < best) {
+            best = priority;
+        }
+    }
+
+    if (best < 0) {
+        return -1;
+    }
+
+    // Serve the least recently served account among them. Within an
+    // account the queue order is preserved.
+    foreach (const QString &account, iAccountOrder) {
+        for (int i = 0; i < iItems.size(); ++i) {
+            SyncSession *session = iItems.at(i);
+            if (priorityOf(session) == best && accountOf(session) == account
+                    && canStart(session)) {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+bool SyncQueue::hasQueuedSessions(const QString &aAccountId) const
+{
+    foreach (SyncSession *session, iItems) {
+        if (accountOf(session) == aAccountId) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int SyncQueue::priorityOf(const SyncSession *aSession)
+{
+    // Same ordering as syncSessionPointerLessThan(), smaller is served first.
+    int priority = 0;
+    if (aSession->isScheduled()) {
+        priority += 2;
+    }
+    SyncProfile *profile = aSession->profile();
+    if (profile && profile->destinationType() != SyncProfile::DESTINATION_TYPE_DEVICE) {
+        priority += 1;
+    }
+
+    return priority;
+}
+
+QString SyncQueue::accountOf(const SyncSession *aSession)
+{
+    QString account;
+    if (aSession && aSession->profile()) {
+        account = aSession->profile()->key(KEY_ACCOUNT_ID);
+    }
+
+    return account;
+}
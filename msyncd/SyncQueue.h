@@ -24,6 +24,8 @@
 #define SYNCQUEUE_H
 
 #include <QQueue>
+#include <QHash>
+#include <QStringList>
 
 namespace Buteo {
 
@@ -33,10 +35,22 @@ class SyncSession;
  *
  * The queue is sorted every time when new items are added to it, so that
  * the sync sessions with highest priority will be at the front of the queue.
+ *
+ * Sessions are served fairly across accounts: among the startable
+ * sessions of the highest priority (manual before scheduled, device before
+ * online), the head of the queue is picked round-robin over their accounts
+ * (KEY_ACCOUNT_ID). An account that already has the maximum number of
+ * running sessions is skipped until one of them finishes. Profiles without
+ * an account share a single slot in the rotation and are not limited.
+ *
+ * Queueing times are recorded in the msyncd_queue_wait_ms histogram.
  */
 class SyncQueue
 {
 public:
+    //! \brief Constructor
+    SyncQueue();
+
     /*! \brief Adds a new profile to the queue. Queue is sorted automatically.
      *
      * \param aSession Session to add to queue
@@ -51,13 +65,15 @@ public:
 
     /*! \brief Removes the first item from the queue and returns it.
      *
-     * \return The removed item. NULL if the queue was empty.
+     * \return The removed item. NULL if the queue was empty or all accounts
+     *  with queued sessions are at their running session limit.
      */
     SyncSession *dequeue();
 
     /*! \brief Returns the first item in the queue but does not remove it.
      *
-     * \return First item of the queue. NULL if the queue is empty.
+     * \return First item of the queue. NULL if the queue is empty or all
+     *  accounts with queued sessions are at their running session limit.
      */
     SyncSession *head();
 
@@ -86,10 +102,68 @@ public:
      */
     const QList<SyncSession *> &getQueuedSyncSessions() const;
 
+    /*! \brief Returns the time when the given session was added to the queue.
+     *
+     * \param aSession Queued session.
+     * \return Enqueue time in milliseconds since epoch, 0 if the session is
+     *  not queued.
+     */
+    qint64 enqueueTime(const SyncSession *aSession) const;
+
+    /*! \brief Sets the maximum number of concurrently running sessions per
+     * account.
+     *
+     * \param aMax Maximum number of running sessions. Zero means unlimited.
+     */
+    void setMaxRunningPerAccount(int aMax);
+
+    /*! \brief Checks if the account of the given session may start one more
+     * session.
+     *
+     * \param aSession Session to check.
+     * \return True if the account is below its running session limit, or
+     *  the session has no account.
+     */
+    bool canStart(const SyncSession *aSession) const;
+
+    /*! \brief Marks the session as running, counting it against the running
+     * session limit of its account.
+     *
+     * \param aSession Session that was started.
+     */
+    void sessionStarted(const SyncSession *aSession);
+
+    /*! \brief Marks the session as no longer running.
+     *
+     * Sessions that were not marked as running are ignored.
+     * \param aSession Session that finished.
+     */
+    void sessionFinished(const SyncSession *aSession);
+
 private:
     void sort();
 
+    int indexOfHead() const;
+
+    bool hasQueuedSessions(const QString &aAccountId) const;
+
+    static int priorityOf(const SyncSession *aSession);
+
+    static QString accountOf(const SyncSession *aSession);
+
     QQueue<SyncSession *> iItems;
+
+    // Accounts having queued sessions in the order they are served, least
+    // recently served first.
+    QStringList iAccountOrder;
+
+    QHash<const SyncSession *, qint64> iEnqueueTimes;
+
+    QHash<const SyncSession *, QString> iRunningSessions;
+
+    QHash<QString, int> iRunningCounts;
+
+    int iMaxRunningPerAccount;
 };
 
 }
@@ -25,8 +25,11 @@
 #include "PluginRunner.h"
 #include "StorageBooker.h"
 #include "SyncProfile.h"
+#include "ProfileEngineDefs.h"
 #include "NetworkManager.h"
 #include "LogMacros.h"
+#include "Metrics.h"
+#include "TraceRecorder.h"
 
 using namespace Buteo;
 
@@ -44,8 +47,14 @@ SyncSession::SyncSession(SyncProfile *aProfile, QObject *aParent)
     , iCreateProfile(false)
     , iStorageBooker(0)
     , iNetworkManager(0)
+    , iProgressTimeout(0)
+    , iStallLevel(0)
+    , iStalled(false)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iWatchdog.setSingleShot(true);
+    connect(&iWatchdog, &QTimer::timeout, this, &SyncSession::onProgressTimeout);
 }
 
 SyncSession::~SyncSession()
@@ -120,6 +129,16 @@ bool SyncSession::start()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    TraceScope traceScope("SyncSession::start", "session", profileName());
+
+    iDuration.start();
+
+    bool ok = false;
+    const int progressTimeout = iProfile->key(KEY_PROGRESS_TIMEOUT).toInt(&ok);
+    if (ok && progressTimeout >= 0) {
+        iProgressTimeout = progressTimeout * 1000;
+    }
+
     bool rv = false;
     // If this is an online session, then we need to ensure that the network
     // session is opened before starting our plugin runner
@@ -147,6 +166,10 @@ bool SyncSession::tryStart()
         iStarted = rv = iPluginRunner->start();
     }
 
+    if (rv) {
+        resetWatchdog();
+    }
+
     if (!rv) {
         updateResults(SyncResults(QDateTime::currentDateTime(),
                                   SyncResults::SYNC_RESULT_FAILED,
@@ -265,14 +288,75 @@ bool SyncSession::isScheduled() const
     return iScheduled;
 }
 
+void SyncSession::setProgressTimeout(int aTimeout)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iProgressTimeout = qMax(0, aTimeout);
+}
+
+void SyncSession::resetWatchdog()
+{
+    // Once the session has been aborted for stalling, late progress does
+    // not stop the escalation; the plug-in has to finish.
+    if (iStalled) {
+        return;
+    }
+
+    iStallLevel = 0;
+    if (iProgressTimeout > 0 && iStarted && !iFinished) {
+        iWatchdog.start(iProgressTimeout);
+    }
+}
+
+void SyncSession::onProgressTimeout()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iFinished) {
+        return;
+    }
+
+    const QString pluginName = iPluginRunner ? iPluginRunner->pluginName() : QString();
+    ++iStallLevel;
+    if (iStallLevel == 1) {
+        qCWarning(lcButeoMsyncd) << "No progress from" << pluginName << "for" << profileName()
+                                 << "in" << iProgressTimeout << "ms";
+        iWatchdog.start(iProgressTimeout);
+    } else if (iStallLevel == 2) {
+        qCWarning(lcButeoMsyncd) << "Aborting stalled session of" << profileName();
+        Metrics::instance()->counter(QStringLiteral("msyncd_sessions_stalled_total"))->add();
+        iStalled = true;
+        iWatchdog.start(iProgressTimeout);
+        abort(Sync::SYNC_ABORTED);
+    } else if (iPluginRunner && iPluginRunner->killPlugin()) {
+        // The plug-in reports an error once its process is gone, which
+        // finishes the session.
+        qCWarning(lcButeoMsyncd) << "Killed stalled plug-in" << pluginName << "of" << profileName();
+    } else {
+        // An in-process plug-in cannot be killed, so the session gives up
+        // on it the same way as on a plug-in timeout. Its worker thread
+        // stays busy until the plug-in returns.
+        qCWarning(lcButeoMsyncd) << "Stalled plug-in" << pluginName << "of" << profileName()
+                                 << "did not abort, giving up";
+        if (iPluginRunner) {
+            disconnect(iPluginRunner, &PluginRunner::error, this, &SyncSession::onError);
+            disconnect(iPluginRunner, SIGNAL(success(const QString &, const QString &)),
+                       this, SLOT(onSuccess(const QString &, const QString &)));
+        }
+        onError(profileName(), QStringLiteral("Plugin stalled"), SyncResults::PLUGIN_STALLED);
+    }
+}
+
 void SyncSession::onSuccess(const QString &aProfileName, const QString &aMessage)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
-    iErrorCode = SyncResults::NO_ERROR;
+    iErrorCode = iStalled ? SyncResults::PLUGIN_STALLED : SyncResults::NO_ERROR;
 
     Q_UNUSED(aProfileName);
 
     iFinished = true;
+    iWatchdog.stop();
     if (!iAborted) {
         iStatus = Sync::SYNC_DONE;
     } else {
@@ -283,6 +367,10 @@ void SyncSession::onSuccess(const QString &aProfileName, const QString &aMessage
     if (iPluginRunner != 0) {
         updateResults(iPluginRunner->syncResults());
     }
+    if (iStalled) {
+        setFailureResult(SyncResults::SYNC_RESULT_FAILED, SyncResults::PLUGIN_STALLED);
+    }
+    recordMetrics();
     emit finished(profileName(), iStatus, iMessage, iErrorCode);
 
 }
@@ -294,7 +382,14 @@ void SyncSession::onError(const QString &aProfileName, const QString &aMessage,
 
     Q_UNUSED(aProfileName);
 
+    // Whatever the plug-in reports after being aborted or killed by the
+    // watchdog, the cause was the stall.
+    if (iStalled) {
+        aErrorCode = SyncResults::PLUGIN_STALLED;
+    }
+
     iFinished = true;
+    iWatchdog.stop();
     iStatus = mapToSyncStatusError(aErrorCode);
     iMessage = aMessage;
     iErrorCode = aErrorCode;
@@ -302,9 +397,29 @@ void SyncSession::onError(const QString &aProfileName, const QString &aMessage,
     if (iPluginRunner != 0) {
         updateResults(iPluginRunner->syncResults());
     }
+    if (iStalled) {
+        setFailureResult(SyncResults::SYNC_RESULT_FAILED, SyncResults::PLUGIN_STALLED);
+    }
+    recordMetrics();
     emit finished(profileName(), iStatus, iMessage, iErrorCode);
 }
 
+void SyncSession::recordMetrics()
+{
+    if (!iDuration.isValid()) {
+        return;
+    }
+
+    Metrics *metrics = Metrics::instance();
+    metrics->histogram(QStringLiteral("msyncd_session_duration_ms"))->record(iDuration.elapsed());
+    if (iStatus == Sync::SYNC_DONE) {
+        metrics->counter(QStringLiteral("msyncd_sessions_succeeded_total"))->add();
+    } else {
+        metrics->counter(QStringLiteral("msyncd_sessions_failed_total"))->add();
+    }
+    iDuration.invalidate();
+}
+
 Sync::SyncStatus SyncSession::mapToSyncStatusError(int aErrorCode)
 {
     Sync::SyncStatus status;
@@ -329,12 +444,14 @@ void SyncSession::onTransferProgress(const QString &aProfileName,
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    resetWatchdog();
     emit transferProgress(aProfileName, aDatabase, aType, aMimeType, aCommittedItems);
 }
 
 void SyncSession::onStorageAccquired (const QString &aMimeType)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
+    resetWatchdog();
     emit storageAccquired (profileName(), aMimeType);
 }
 
@@ -342,6 +459,7 @@ void SyncSession::onSyncProgressDetail(const QString &aProfileName, int aProgres
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
     Q_UNUSED(aProfileName);
+    resetWatchdog();
     emit syncProgressDetail (profileName(), aProgressDetail);
 }
 
@@ -349,6 +467,8 @@ void SyncSession::onDone()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    iWatchdog.stop();
+
     QString pluginName;
     if (iPluginRunner != 0) {
         disconnect(iPluginRunner, 0, this, 0);
@@ -390,10 +510,16 @@ bool SyncSession::reserveStorages(StorageBooker *aStorageBooker)
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
     bool success = false;
-    if (aStorageBooker != 0 && iProfile != 0 &&
-            aStorageBooker->reserveStorages(iProfile->storageBackendNames(),
-                                            iProfile->name())) {
-        success = true;
+    if (aStorageBooker != 0 && iProfile != 0) {
+        // Local storages are only read when data is copied to remote.
+        StorageBooker::AccessMode access =
+            (iProfile->syncDirection() == SyncProfile::SYNC_DIRECTION_TO_REMOTE)
+            ? StorageBooker::ACCESS_SHARED : StorageBooker::ACCESS_EXCLUSIVE;
+        success = aStorageBooker->reserveStorages(iProfile->storageBackendNames(),
+                                                  iProfile->name(), access);
+    }
+
+    if (success) {
         iStorageBooker = aStorageBooker;
     }
 
@@ -28,6 +28,8 @@
 #include "SyncResults.h"
 #include <QObject>
 #include <QMap>
+#include <QElapsedTimer>
+#include <QTimer>
 
 namespace Buteo {
 
@@ -131,6 +133,26 @@ public:
      */
     bool isScheduled() const;
 
+    /*! \brief Sets the progress deadline of the session
+     *
+     * If the plug-in reports no progress for aTimeout milliseconds a
+     * warning is logged. After another aTimeout without progress the
+     * session is aborted, and after a third one the plug-in process is
+     * killed. A stalled session finishes with SyncResults::PLUGIN_STALLED.
+     * The progress_timeout key of the profile, in seconds, overrides
+     * aTimeout. Must be called before start().
+     *
+     * An in-process plug-in cannot be killed. Its session is finished
+     * anyway, but the plug-in is abandoned: its worker thread keeps running
+     * it until it returns by itself, and is not available to other
+     * sessions meanwhile. Deleting the session does not wait for it, the
+     * plug-in is destroyed once it has returned.
+     *
+     * @param aTimeout Deadline in milliseconds, 0 (the default) disables
+     *  the watchdog
+     */
+    void setProgressTimeout(int aTimeout);
+
     /*! \brief Sets the results for this session
      *
      * This function can be used in error situations to set the results to this
@@ -152,7 +174,9 @@ public:
     /*! \brief Tries to reserve storages needed by the session
      *
      * Successfully reserved storages are automatically released when the session
-     * is deleted.
+     * is deleted. Profiles which only copy data to the remote side reserve their
+     * storages in shared mode, so that several of them can run concurrently.
+     * All other profiles reserve their storages exclusively.
      * @param aStorageBooker Storake booker to use for reserving the storages.
      *  If reserving is successfull, this booker is saved internally and used
      *  later to release the storages when the session is deleted.
@@ -216,6 +240,12 @@ signals:
 private:
     bool tryStart();
 
+    // Records duration and outcome of a finished session to Metrics.
+    void recordMetrics();
+
+    // Restarts the progress deadline from the first escalation step.
+    void resetWatchdog();
+
 private slots:
     // Slots for catching plug-in runner signals.
     void onSuccess(const QString &aProfileName, const QString &aMessage);
@@ -229,6 +259,7 @@ private slots:
     void onDestroyed(QObject *aPluginRunner);
     void onNetworkSessionOpened();
     void onNetworkSessionError();
+    void onProgressTimeout();
 
 private:
     SyncProfile *iProfile;
@@ -247,6 +278,11 @@ private:
     StorageBooker *iStorageBooker;
     QMap<QString, bool> iStorageMap;
     NetworkManager *iNetworkManager;
+    QElapsedTimer iDuration;
+    QTimer iWatchdog;
+    int iProgressTimeout;
+    int iStallLevel;
+    bool iStalled;
 
 #ifdef SYNCFW_UNIT_TESTS
     friend class SyncSessionTest;
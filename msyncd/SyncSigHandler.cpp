@@ -30,6 +30,7 @@
 
 #include "SyncSigHandler.h"
 #include "LogMacros.h"
+#include "LogRingBuffer.h"
 
 int SyncSigHandler::iSigHupFd[2];
 int SyncSigHandler::iSigTermFd[2];
@@ -43,6 +44,11 @@ SyncSigHandler::SyncSigHandler(QObject *aParent, const char */*aName*/)
     signal(SIGTERM, termSignalHandler);
     signal(SIGINT, termSignalHandler);
     signal(SIGHUP, hupSignalHandler);
+    signal(SIGSEGV, fatalSignalHandler);
+    signal(SIGABRT, fatalSignalHandler);
+    signal(SIGBUS, fatalSignalHandler);
+    signal(SIGFPE, fatalSignalHandler);
+    signal(SIGILL, fatalSignalHandler);
 
     //Adding socketpair to monitor those fd's.
     if (::socketpair(AF_UNIX, SOCK_STREAM, 0, iSigHupFd)) {
@@ -83,6 +89,15 @@ void SyncSigHandler::hupSignalHandler(int /*signal*/)
     // Do nothing
 }
 
+void SyncSigHandler::fatalSignalHandler(int signal)
+{
+    // Save the recent log records, then let the default action (core dump)
+    // take place.
+    Buteo::LogRingBuffer::dumpFromSignalHandler();
+    ::signal(signal, SIG_DFL);
+    ::raise(signal);
+}
+
 //Qt Slot will eventually get called corresponding to Unix signal.
 void SyncSigHandler::handleSigTerm()
 {
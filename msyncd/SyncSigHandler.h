@@ -57,6 +57,7 @@ public:
     // Unix signal handlers.
     static void hupSignalHandler(int unused);
     static void termSignalHandler(int unused);
+    static void fatalSignalHandler(int signal);
 
 public slots:
     /*! \brief QT signal handler to handle SIG_HUP
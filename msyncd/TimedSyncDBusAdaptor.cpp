@@ -0,0 +1,47 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "TimedSyncDBusAdaptor.h"
+#include "Metrics.h"
+
+using namespace Buteo;
+
+static MetricsHistogram *dbusCallHistogram()
+{
+    static MetricsHistogram *histogram = Metrics::instance()->histogram(QStringLiteral("msyncd_dbus_call_ms"));
+    return histogram;
+}
+
+TimedSyncDBusAdaptor::TimedSyncDBusAdaptor(QObject *parent)
+    : SyncDBusAdaptor(parent)
+{
+}
+
+int TimedSyncDBusAdaptor::qt_metacall(QMetaObject::Call aCall, int aId, void **aArgs)
+{
+    // Every incoming D-Bus method call is delivered through here, so this is
+    // the single place where call latency is recorded.
+    if (aCall != QMetaObject::InvokeMetaMethod)
+        return SyncDBusAdaptor::qt_metacall(aCall, aId, aArgs);
+
+    MetricsTimer callTimer(dbusCallHistogram());
+    return SyncDBusAdaptor::qt_metacall(aCall, aId, aArgs);
+}
@@ -0,0 +1,41 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#ifndef TIMEDSYNCDBUSADAPTOR_H
+#define TIMEDSYNCDBUSADAPTOR_H
+
+#include "SyncDBusAdaptor.h"
+
+/*
+ * SyncDBusAdaptor which records the duration of every method call in the
+ * msyncd_dbus_call_ms histogram. It has no meta object of its own, so the
+ * exported D-Bus interface is exactly that of SyncDBusAdaptor.
+ *
+ * Kept apart from SyncDBusAdaptor, which is regenerated by
+ * generate_dbus_adaptor.sh.
+ */
+class TimedSyncDBusAdaptor: public SyncDBusAdaptor
+{
+public:
+    explicit TimedSyncDBusAdaptor(QObject *parent);
+    int qt_metacall(QMetaObject::Call aCall, int aId, void **aArgs) override;
+};
+
+#endif
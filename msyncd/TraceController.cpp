@@ -0,0 +1,110 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "TraceController.h"
+#include "TraceRecorder.h"
+#include "LogMacros.h"
+#include "LogRingBuffer.h"
+
+#include <QDBusConnection>
+#include <QDir>
+#include <QStandardPaths>
+
+using namespace Buteo;
+
+static const char *DBUS_TRACE_OBJECT = "/trace";
+static const char *TRACE_FILE_ENV = "MSYNCD_TRACE_FILE";
+
+TraceController::TraceController(QObject *aParent)
+    : QObject(aParent)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QDBusConnection dbus = QDBusConnection::sessionBus();
+    if (dbus.registerObject(DBUS_TRACE_OBJECT, this, QDBusConnection::ExportScriptableSlots)) {
+        qCDebug(lcButeoMsyncd) << "Registered trace controller to D-Bus";
+    } else {
+        qCWarning(lcButeoMsyncd) << "Failed to register trace controller to D-Bus";
+    }
+
+    QString fileName = QString::fromLocal8Bit(qgetenv(TRACE_FILE_ENV));
+    if (!fileName.isEmpty()) {
+        startTrace(fileName);
+    }
+}
+
+TraceController::~TraceController()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    QDBusConnection::sessionBus().unregisterObject(DBUS_TRACE_OBJECT);
+
+    if (TraceRecorder::isEnabled()) {
+        stopTrace();
+    }
+    // Don't lose the last trace when msyncd exits.
+    TraceRecorder::instance()->waitForWritten();
+}
+
+QString TraceController::traceDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+           + QDir::separator() + QStringLiteral("traces");
+}
+
+bool TraceController::startTrace(const QString &aFileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    // The object is reachable by any client on the session bus, so only a
+    // plain file name inside the trace directory is accepted.
+    if (aFileName.isEmpty() || aFileName.contains(QLatin1Char('/'))
+            || aFileName == QStringLiteral(".") || aFileName == QStringLiteral("..")) {
+        qCWarning(lcButeoMsyncd) << "Invalid trace file name" << aFileName;
+        return false;
+    }
+
+    const QString dir = traceDir();
+    if (!QDir().mkpath(dir)) {
+        qCWarning(lcButeoMsyncd) << "Failed to create trace directory" << dir;
+        return false;
+    }
+    return TraceRecorder::instance()->start(dir + QDir::separator() + aFileName);
+}
+
+bool TraceController::stopTrace()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    return TraceRecorder::instance()->stop();
+}
+
+bool TraceController::isTracing() const
+{
+    return TraceRecorder::isEnabled();
+}
+
+QString TraceController::dumpLog()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    return LogRingBuffer::instance()->dump();
+}
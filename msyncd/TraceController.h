@@ -0,0 +1,89 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#ifndef TRACECONTROLLER_H
+#define TRACECONTROLLER_H
+
+#include <QObject>
+#include <QString>
+
+namespace Buteo {
+
+/*! \brief Lets trace recording be switched on and off and recent log
+ *         records be dumped over D-Bus.
+ *
+ * The controller is available from the "/trace" object on the msyncd
+ * service. Traces are always written to the "traces" directory under the
+ * msyncd data location; callers only choose the file name. If
+ * MSYNCD_TRACE_FILE is set in the environment, recording starts right
+ * away and the trace is written to that file when msyncd stops, unless
+ * it was stopped earlier over D-Bus.
+ */
+class TraceController : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.meego.msyncd.trace")
+
+public:
+    /*! \brief Constructor, registers the object on the session bus.
+     *
+     * @param aParent Parent object
+     */
+    explicit TraceController(QObject *aParent = nullptr);
+
+    /*! \brief Destructor, unregisters the object and writes out a
+     *         running trace.
+     */
+    virtual ~TraceController();
+
+public slots:
+    /*! \brief Starts recording a trace.
+     *
+     * @param aFileName Name of the file in the trace directory to write
+     *        the trace to, in the Chrome trace event format. Paths are
+     *        rejected.
+     * @return False if the name is invalid or a trace is already being
+     *         recorded
+     */
+    Q_SCRIPTABLE bool startTrace(const QString &aFileName);
+
+    /*! \brief Stops recording. The trace file is written in the background.
+     *
+     * @return False if no trace was being recorded
+     */
+    Q_SCRIPTABLE bool stopTrace();
+
+    //! Returns the directory trace files are written to
+    static QString traceDir();
+
+    //! Returns true if a trace is being recorded
+    Q_SCRIPTABLE bool isTracing() const;
+
+    /*! \brief Writes the recently captured log records to a new dump file
+     *         next to the ones written on sync errors.
+     *
+     * @return Path of the written file, empty on failure
+     */
+    Q_SCRIPTABLE QString dumpLog();
+};
+
+}
+
+#endif // TRACECONTROLLER_H
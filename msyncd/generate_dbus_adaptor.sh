@@ -22,5 +22,7 @@
 # */
 #
 
-qdbuscpp2xml -M -S SyncDBusInterface.h -o com.meego.msyncd.xml
-qdbusxml2cpp -a SyncDBusAdaptor -c SyncDBusAdaptor com.meego.msyncd.xml
+# com.meego.msyncd.xml is maintained by hand: it carries the SyncResults
+# signatures and type annotations that qdbuscpp2xml cannot produce, so it must
+# not be regenerated from SyncDBusInterface.h.
+qdbusxml2cpp -i SyncResults.h -a SyncDBusAdaptor -c SyncDBusAdaptor com.meego.msyncd.xml
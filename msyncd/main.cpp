@@ -27,6 +27,8 @@
 #include <QDateTime>
 
 #include "Logger.h"
+#include "AsyncLogWriter.h"
+#include "LogRingBuffer.h"
 #include "synchronizer.h"
 #include "SyncSigHandler.h"
 #include "SyncCommonDefs.h"
@@ -35,11 +37,22 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
 
+    // Write log output on its own thread, so that verbose logging does
+    // not stall the event loop.
+    Buteo::AsyncLogWriter::instance()->install();
+
+    // Keep recent log output in memory, so that it can be dumped when
+    // something goes wrong. MSYNCD_CAPTURE_DEBUG=1 also keeps debug output
+    // without printing it.
+    Buteo::LogRingBuffer::instance()->install(Sync::syncConfigDir() + QDir::separator() + "msyncd-recent",
+                                              qgetenv("MSYNCD_CAPTURE_DEBUG").toInt() > 0);
+
     Buteo::Synchronizer *synchronizer = new Buteo::Synchronizer(&app);
 
     if (!synchronizer->initialize()) {
         delete synchronizer;
         synchronizer = 0;
+        Buteo::AsyncLogWriter::instance()->shutdown();
         return -1;
     }
 
@@ -68,5 +81,7 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
 
     qDebug() << "Exiting program";
 
+    Buteo::AsyncLogWriter::instance()->shutdown();
+
     return returnValue;
 }
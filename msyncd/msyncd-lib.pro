@@ -44,42 +44,58 @@ HEADERS += ServerActivator.h \
     SyncDBusInterface.h \
     SyncBackupProxy.h \
     SyncDBusAdaptor.h \
+    TimedSyncDBusAdaptor.h \
     SyncBackupAdaptor.h \
     ClientThread.h \
     ServerThread.h \
     StorageBooker.h \
     SyncQueue.h \
+    PendingSyncsJournal.h \
     SyncScheduler.h \
     SyncBackup.h \
     AccountsHelper.h \
     SyncSession.h \
     PluginRunner.h \
+    PluginThreadPool.h \
     ClientPluginRunner.h \
     ServerPluginRunner.h \
+    ServerListener.h \
+    RfcommServiceRecord.h \
     SyncSigHandler.h \
     StorageChangeNotifier.h \
     SyncOnChange.h \
-    SyncOnChangeScheduler.h
+    SyncOnChangeScheduler.h \
+    AccountSyncIndex.h \
+    MetricsExporter.h \
+    TraceController.h
 
 SOURCES += ServerActivator.cpp \
     synchronizer.cpp \
     SyncDBusAdaptor.cpp \
+    TimedSyncDBusAdaptor.cpp \
     SyncBackupAdaptor.cpp \
     ClientThread.cpp \
     ServerThread.cpp \
     StorageBooker.cpp \
     SyncQueue.cpp \
+    PendingSyncsJournal.cpp \
     SyncScheduler.cpp \
     SyncBackup.cpp \
     AccountsHelper.cpp \
     SyncSession.cpp \
     PluginRunner.cpp \
+    PluginThreadPool.cpp \
     ClientPluginRunner.cpp \
     ServerPluginRunner.cpp \
+    ServerListener.cpp \
+    RfcommServiceRecord.cpp \
     SyncSigHandler.cpp \
     StorageChangeNotifier.cpp \
     SyncOnChange.cpp \
-    SyncOnChangeScheduler.cpp
+    SyncOnChangeScheduler.cpp \
+    AccountSyncIndex.cpp \
+    MetricsExporter.cpp \
+    TraceController.cpp
 
 contains(DEFINES, USE_KEEPALIVE) {
     PKGCONFIG += keepalive
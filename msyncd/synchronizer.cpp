@@ -26,14 +26,19 @@
 #include <gio/gio.h>
 
 #include "synchronizer.h"
-#include "SyncDBusAdaptor.h"
+#include "TimedSyncDBusAdaptor.h"
 #include "SyncSession.h"
 #include "ClientPluginRunner.h"
 #include "ServerPluginRunner.h"
+#include "ServerListener.h"
 #include "AccountsHelper.h"
 #include "NetworkManager.h"
 #include "TransportTracker.h"
 #include "ServerActivator.h"
+#include "MetricsExporter.h"
+#include "PluginThreadPool.h"
+#include "TraceController.h"
+#include "PendingSyncsJournal.h"
 
 #include "SyncCommonDefs.h"
 #include "StoragePlugin.h"
@@ -43,6 +48,9 @@
 #include "ProfileFactory.h"
 #include "ProfileEngineDefs.h"
 #include "LogMacros.h"
+#include "TraceRecorder.h"
+#include "Metrics.h"
+#include "LogRingBuffer.h"
 #include "BtHelper.h"
 
 #ifdef HAS_MCE
@@ -54,6 +62,10 @@
 #include <termios.h>
 
 #include <QRegularExpression>
+#include <QSettings>
+#include <QSet>
+#include <QStandardPaths>
+#include <QDir>
 #include <QtDebug>
 
 using namespace Buteo;
@@ -61,6 +73,46 @@ using namespace Buteo;
 static const QString SYNC_DBUS_OBJECT = "/synchronizer";
 static const QString SYNC_DBUS_SERVICE = "com.meego.msyncd";
 static const QString BT_PROPERTIES_NAME = "Name";
+static const QString PENDING_SYNCS_FILE = "pendingsyncs.ini";
+static const char *OOP_POOL_SIZE_ENV = "MSYNCD_OOP_POOL_SIZE";
+static const int DEFAULT_OOP_POOL_SIZE = 0;
+static const char *OOP_KEEPALIVE_ENV = "MSYNCD_OOP_KEEPALIVE";
+static const char *OOP_KEEPALIVE_MAX_ENV = "MSYNCD_OOP_KEEPALIVE_MAX";
+static const int DEFAULT_OOP_KEEPALIVE = 60; // seconds
+static const int DEFAULT_OOP_KEEPALIVE_MAX = 2;
+static const char *OOP_NICE_ENV = "MSYNCD_OOP_NICE";
+static const char *OOP_MEMORY_LIMIT_ENV = "MSYNCD_OOP_MEMORY_LIMIT"; // MiB
+static const char *OOP_CGROUP_ENV = "MSYNCD_OOP_CGROUP";
+static const char *PLUGIN_RESIDENCY_ENV = "MSYNCD_PLUGIN_RESIDENCY";
+static const char *PLUGIN_RESIDENCY_BUDGET_ENV = "MSYNCD_PLUGIN_RESIDENCY_BUDGET";
+static const int DEFAULT_PLUGIN_RESIDENCY = 4;
+static const int DEFAULT_PLUGIN_RESIDENCY_BUDGET = 16384; // KiB
+static const char *PLUGIN_THREADS_ENV = "MSYNCD_PLUGIN_THREADS";
+static const int DEFAULT_PLUGIN_THREADS = 6;
+static const char *MAX_SYNCS_PER_ACCOUNT_ENV = "MSYNCD_MAX_SYNCS_PER_ACCOUNT";
+// Stopped sessions uninitialise their plug-ins on the worker threads
+static const int PLUGIN_SHUTDOWN_TIMEOUT = 35000; // ms
+static const char *PROGRESS_TIMEOUT_ENV = "MSYNCD_PROGRESS_TIMEOUT";
+static const int DEFAULT_PROGRESS_TIMEOUT = 0; // seconds, disabled
+static const char *SERVER_IDLE_TIMEOUT_ENV = "MSYNCD_SERVER_IDLE_TIMEOUT";
+static const int DEFAULT_SERVER_IDLE_TIMEOUT = 300; // seconds
+static const int ACCOUNT_INDEX_REBUILD_DELAY = 1000; // ms
+
+static QString syncProfileDir()
+{
+    return Sync::syncConfigDir() + QDir::separator() + Profile::TYPE_SYNC;
+}
+
+static QHash<QString, QDateTime> profileFileTimes()
+{
+    QHash<QString, QDateTime> times;
+    QDir dir(syncProfileDir());
+    foreach (const QFileInfo &fileInfo, dir.entryInfoList(QStringList(QStringLiteral("*.xml")),
+                                                          QDir::Files | QDir::NoSymLinks)) {
+        times.insert(fileInfo.completeBaseName(), fileInfo.lastModified());
+    }
+    return times;
+}
 
 class Buteo::BatteryInfo
 {
@@ -94,10 +146,15 @@ Synchronizer::Synchronizer(QCoreApplication *aApplication)
     : iNetworkManager(nullptr)
     , iSyncScheduler(nullptr)
     , iSyncBackup(nullptr)
+    , iMetricsExporter(nullptr)
+    , iTraceController(nullptr)
     , iTransportTracker(nullptr)
     , iServerActivator(nullptr)
     , iAccounts(nullptr)
     , iClosing(false)
+    , iPendingSyncsReplayed(false)
+    , iProgressTimeout(0)
+    , iServerIdleTimeout(0)
     , iSOCEnabled(false)
     , iSyncUIInterface(nullptr)
     , iBatteryInfo(new BatteryInfo)
@@ -106,9 +163,26 @@ Synchronizer::Synchronizer(QCoreApplication *aApplication)
     FUNCTION_CALL_TRACE(lcButeoTrace);
     this->setParent(aApplication);
 
+    SyncResults::registerDBusTypes();
+
     iProfileChangeTriggerTimer.setSingleShot(true);
     connect(&iProfileChangeTriggerTimer, &QTimer::timeout,
             this, &Synchronizer::profileChangeTriggerTimeout);
+
+    iPendingSyncsTimer.setSingleShot(true);
+    iPendingSyncsTimer.setInterval(0);
+    connect(&iPendingSyncsTimer, &QTimer::timeout,
+            this, &Synchronizer::writePendingSyncs);
+
+    // Saving a profile creates and removes its backup file, so every write
+    // shows up as a change of the directory. Only the profile files that
+    // changed are reloaded.
+    iAccountIndexTimer.setSingleShot(true);
+    iAccountIndexTimer.setInterval(ACCOUNT_INDEX_REBUILD_DELAY);
+    connect(&iAccountIndexTimer, &QTimer::timeout,
+            this, &Synchronizer::reindexChangedProfiles);
+    connect(&iProfileWatcher, &QFileSystemWatcher::directoryChanged,
+            &iAccountIndexTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
 }
 
 Synchronizer::~Synchronizer()
@@ -127,8 +201,8 @@ bool Synchronizer::initialize()
     qCDebug(lcButeoMsyncd) << "Starting msyncd";
 
     // Create a D-Bus adaptor. It will get deleted when the Synchronizer is
-    // deleted.
-    new SyncDBusAdaptor(this);
+    // deleted. Method calls are timed for the metrics endpoint.
+    new TimedSyncDBusAdaptor(this);
 
     // Register our object on the session bus and expose interface to others.
     QDBusConnection dbus = QDBusConnection::sessionBus();
@@ -140,6 +214,9 @@ bool Synchronizer::initialize()
         qCDebug(lcButeoMsyncd) << "Registered to D-Bus";
     } // else ok
 
+    iMetricsExporter = new MetricsExporter(this);
+    iTraceController = new TraceController(this);
+
     connect(this, SIGNAL(syncStatus(QString, int, QString, int)),
             this, SLOT(slotSyncStatus(QString, int, QString, int)),
             Qt::QueuedConnection);
@@ -148,6 +225,12 @@ bool Synchronizer::initialize()
     connect(&iProfileManager, SIGNAL(signalProfileChanged(QString, int, QString)),
             this, SLOT(slotProfileChanged(QString, int, QString)), Qt::QueuedConnection);
 
+    // Build the account index, it is kept up to date from profile change
+    // events and session state transitions afterwards.
+    QDir().mkpath(syncProfileDir());
+    iProfileWatcher.addPath(syncProfileDir());
+    rebuildAccountIndex();
+
     iNetworkManager = new NetworkManager(this);
 
     iTransportTracker = new TransportTracker(this);
@@ -175,6 +258,77 @@ bool Synchronizer::initialize()
     connect(this, SIGNAL(storageReleased()),
             this, SLOT(onStorageReleased()), Qt::QueuedConnection);
 
+    // Runners left behind by a crashed instance are cleaned up from the
+    // registry, which also tracks the runners started from now on.
+    iPluginManager.setOOPProcessRegistry(
+                QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)
+                + QStringLiteral("/msyncd/oopp-runners"));
+
+    // Runners connect to msyncd directly, before any of them is started
+    iPluginManager.setOOPPeerServer(
+                QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation)
+                + QStringLiteral("/msyncd"));
+
+    // Keep idle out-of-process plugin runners on the bus, so that syncs do
+    // not wait for the runner process to start up.
+    bool poolSizeOk = false;
+    int poolSize = qgetenv(OOP_POOL_SIZE_ENV).toInt(&poolSizeOk);
+    iPluginManager.setOOPPoolSize(poolSizeOk ? poolSize : DEFAULT_OOP_POOL_SIZE);
+
+    // Keep plugin processes around for a while after their session, so
+    // that the next sync of the same profile can reuse them.
+    bool keepAliveOk = false;
+    int keepAlive = qgetenv(OOP_KEEPALIVE_ENV).toInt(&keepAliveOk);
+    bool keepAliveMaxOk = false;
+    int keepAliveMax = qgetenv(OOP_KEEPALIVE_MAX_ENV).toInt(&keepAliveMaxOk);
+    iPluginManager.setOOPKeepAlive((keepAliveOk ? keepAlive : DEFAULT_OOP_KEEPALIVE) * 1000,
+                                   keepAliveMaxOk ? keepAliveMax : DEFAULT_OOP_KEEPALIVE_MAX);
+
+    // Resource limits of plugin processes, profiles may override them
+    bool oopNiceOk = false;
+    int oopNice = qgetenv(OOP_NICE_ENV).toInt(&oopNiceOk);
+    bool oopMemoryLimitOk = false;
+    qint64 oopMemoryLimit = qgetenv(OOP_MEMORY_LIMIT_ENV).toLongLong(&oopMemoryLimitOk);
+    iPluginManager.setOOPResourceLimits(oopNiceOk ? oopNice : 0,
+                                        (oopMemoryLimitOk ? oopMemoryLimit : 0) * 1024 * 1024,
+                                        QString::fromLocal8Bit(qgetenv(OOP_CGROUP_ENV)));
+
+    // Keep recently used in-process plugin libraries loaded, so that
+    // frequently synced profiles do not load and unload them every time.
+    bool residencyOk = false;
+    int residency = qgetenv(PLUGIN_RESIDENCY_ENV).toInt(&residencyOk);
+    bool residencyBudgetOk = false;
+    qint64 residencyBudget = qgetenv(PLUGIN_RESIDENCY_BUDGET_ENV).toLongLong(&residencyBudgetOk);
+    iPluginManager.setPluginResidency(residencyOk ? residency : DEFAULT_PLUGIN_RESIDENCY,
+                                      (residencyBudgetOk ? residencyBudget : DEFAULT_PLUGIN_RESIDENCY_BUDGET) * 1024);
+
+    // In-process plugins run on a bounded set of reused worker threads.
+    // Listening server plugins get threads outside the bound.
+    bool pluginThreadsOk = false;
+    int pluginThreads = qgetenv(PLUGIN_THREADS_ENV).toInt(&pluginThreadsOk);
+    PluginThreadPool::instance()->setMaxThreads(pluginThreadsOk ? pluginThreads : DEFAULT_PLUGIN_THREADS);
+
+    // One account may not take all sync slots, zero lifts the limit.
+    bool maxSyncsPerAccountOk = false;
+    int maxSyncsPerAccount = qgetenv(MAX_SYNCS_PER_ACCOUNT_ENV).toInt(&maxSyncsPerAccountOk);
+    if (maxSyncsPerAccountOk) {
+        iSyncQueue.setMaxRunningPerAccount(maxSyncsPerAccount);
+    }
+
+    // Sessions whose plugin stops reporting progress are aborted, and
+    // their runner killed if the abort is ignored as well. Plugins may
+    // legitimately go quiet for long, so this is off unless configured
+    // here or with the progress_timeout key of a profile.
+    bool progressTimeoutOk = false;
+    int progressTimeout = qgetenv(PROGRESS_TIMEOUT_ENV).toInt(&progressTimeoutOk);
+    iProgressTimeout = (progressTimeoutOk ? progressTimeout : DEFAULT_PROGRESS_TIMEOUT) * 1000;
+
+    // Servers with a listen endpoint are loaded when a connection arrives
+    // and unloaded again after this long without a session.
+    bool serverIdleTimeoutOk = false;
+    int serverIdleTimeout = qgetenv(SERVER_IDLE_TIMEOUT_ENV).toInt(&serverIdleTimeoutOk);
+    iServerIdleTimeout = (serverIdleTimeoutOk ? serverIdleTimeout : DEFAULT_SERVER_IDLE_TIMEOUT) * 1000;
+
     startServers();
 
     // For Backup/restore handling
@@ -183,6 +337,11 @@ bool Synchronizer::initialize()
     // Initialize scheduler
     initializeScheduler();
 
+    // Restart syncs which were pending when msyncd was stopped. Queued, so
+    // that syncs for alarms which are already due get requested first and
+    // the replayed requests are merged with them.
+    QMetaObject::invokeMethod(this, "replayPendingSyncs", Qt::QueuedConnection);
+
     // Connect backup signals after the scheduler has been initialized
     connect(iSyncBackup, SIGNAL(startBackup()), this, SLOT(backupStarts()));
     connect(iSyncBackup, SIGNAL(backupDone()), this, SLOT(backupFinished()));
@@ -260,6 +419,11 @@ void Synchronizer::close()
         iSyncOnChange.disable();
     }
 
+    if (iPendingSyncsTimer.isActive()) {
+        iPendingSyncsTimer.stop();
+        writePendingSyncs();
+    }
+
     QList<SyncSession *> sessions = iActiveSessions.values();
     foreach (SyncSession *session, sessions) {
         if (session) {
@@ -271,12 +435,23 @@ void Synchronizer::close()
 
     stopServers();
 
+    iPluginManager.setOOPPoolSize(0);
+    iPluginManager.setOOPKeepAlive(0, 0);
+    iPluginManager.setPluginResidency(0, 0);
+    PluginThreadPool::instance()->shutdown(PLUGIN_SHUTDOWN_TIMEOUT);
+
     delete iSyncScheduler;
     iSyncScheduler = nullptr;
 
     delete iSyncBackup;
     iSyncBackup = nullptr;
 
+    delete iMetricsExporter;
+    iMetricsExporter = nullptr;
+
+    delete iTraceController;
+    iTraceController = nullptr;
+
     // Unregister from D-Bus.
     QDBusConnection dbus = QDBusConnection::sessionBus();
     dbus.unregisterObject(SYNC_DBUS_OBJECT);
@@ -335,9 +510,7 @@ bool Synchronizer::startScheduledSync(QString aProfileName)
             qCInfo(lcButeoMsyncd) << "Device offline. Wait for internet connection.";
         }
 
-        if (!iWaitingOnlineSyncs.contains(aProfileName)) {
-            iWaitingOnlineSyncs.append(aProfileName);
-        }
+        addWaitingOnlineSync(aProfileName);
 
         qCDebug(lcButeoMsyncd) << "Marking" << aProfileName << "sync as NOTPOSSIBLE due to connectivity status";
         if (iSyncScheduler) {
@@ -376,6 +549,12 @@ bool Synchronizer::saveSyncResults(QString aProfileId, QString aSyncResults)
     return status;
 }
 
+bool Synchronizer::storeSyncResults(QString aProfileId, Buteo::SyncResults aSyncResults)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+    return iProfileManager.saveSyncResults(aProfileId, aSyncResults);
+}
+
 QString Synchronizer::createSyncProfileForAccount(uint aAccountId)
 {
     iAccounts->createProfileForAccount(aAccountId);
@@ -388,6 +567,8 @@ bool Synchronizer::startSync(const QString &aProfileName, bool aScheduled)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    TraceScope traceScope("startSync", "session", aProfileName);
+
     bool success = false;
 
     if (isBackupRestoreInProgress()) {
@@ -408,11 +589,8 @@ bool Synchronizer::startSync(const QString &aProfileName, bool aScheduled)
     iSyncOnChangeScheduler.removeProfile(aProfileName);
 
     // Do the same if the profile is pending sync due to a profile change.
-    for (int i = iProfileChangeTriggerQueue.size() - 1; i >= 0; --i) {
-        if (iProfileChangeTriggerQueue[i].first == aProfileName) {
-            qCDebug(lcButeoMsyncd) << "Removing queued profile change sync due to sync trigger:" << aProfileName;
-            iProfileChangeTriggerQueue.removeAt(i);
-        }
+    if (removeProfileChanges(aProfileName)) {
+        qCDebug(lcButeoMsyncd) << "Removed queued profile change sync due to sync trigger:" << aProfileName;
     }
 
     if (iActiveSessions.contains(aProfileName)) {
@@ -426,7 +604,7 @@ bool Synchronizer::startSync(const QString &aProfileName, bool aScheduled)
         // Manual sync is allowed to happen in any kind of connection
         // if sync is not scheduled remove it from iWaitingOnlineSyncs to avoid
         // sync it twice later
-        iWaitingOnlineSyncs.removeOne(aProfileName);
+        removeWaitingOnlineSync(aProfileName);
         qCDebug(lcButeoMsyncd) << "Removing" << aProfileName << "from online waiting list.";
     }
 
@@ -450,11 +628,12 @@ bool Synchronizer::startSync(const QString &aProfileName, bool aScheduled)
 
     SyncSession *session = new SyncSession(profile, this);
     session->setScheduled(aScheduled);
+    session->setProgressTimeout(iProgressTimeout);
 
     if (profile->clientProfile()
             && clientProfileActive(profile->clientProfile()->name())) {
         qCDebug(lcButeoMsyncd) << "Sync request of the same type in progress, adding request to the sync queue";
-        iSyncQueue.enqueue(session);
+        queueSession(session);
         emit syncStatus(aProfileName, Sync::SYNC_QUEUED, "", 0);
         return false;
     }
@@ -474,9 +653,14 @@ bool Synchronizer::startSync(const QString &aProfileName, bool aScheduled)
         qCWarning(lcButeoMsyncd) << "Power save mode active, scheduled sync for profile" << aProfileName << "aborted";
         session->setFailureResult(SyncResults::SYNC_RESULT_FAILED, Buteo::SyncResults::POWER_SAVING_MODE);
         emit syncStatus(aProfileName, Sync::SYNC_ERROR, "Power Save Mode active", Buteo::SyncResults::POWER_SAVING_MODE);
+    } else if (!iSyncQueue.canStart(session)) {
+        qCDebug(lcButeoMsyncd) << "Account has too many syncs running, queuing sync request";
+        queueSession(session);
+        emit syncStatus(aProfileName, Sync::SYNC_QUEUED, "", 0);
+        success = true;
     } else if (!session->reserveStorages(&iStorageBooker)) {
         qCDebug(lcButeoMsyncd) << "Needed storage(s) already in use, queuing sync request";
-        iSyncQueue.enqueue(session);
+        queueSession(session);
         emit syncStatus(aProfileName, Sync::SYNC_QUEUED, "", 0);
         success = true;
     } else {
@@ -502,6 +686,8 @@ bool Synchronizer::startSyncNow(SyncSession *aSession)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    TraceScope traceScope("startSyncNow", "session", aSession ? aSession->profileName() : QString());
+
     if (!aSession || isBackupRestoreInProgress()) {
         qCWarning(lcButeoMsyncd) << "Session is null || backup in progress";
         return false;
@@ -587,6 +773,9 @@ bool Synchronizer::startSyncNow(SyncSession *aSession)
 
         qCDebug(lcButeoMsyncd) << "Sync session started";
         iActiveSessions.insert(aSession->profileName(), aSession);
+        iSyncQueue.sessionStarted(aSession);
+        iAccountIndex.setSyncState(aSession->profileName(), AccountSyncIndex::STATE_RUNNING);
+        TraceRecorder::instance()->asyncBegin("session", "session", aSession->profileName());
     } else {
         qCWarning(lcButeoMsyncd) << "Failed to start sync session";
         return false;
@@ -600,6 +789,8 @@ void Synchronizer::onSessionFinished(const QString &aProfileName,
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    TraceScope traceScope("onSessionFinished", "session", aProfileName);
+
     qCDebug(lcButeoMsyncd) << "Session finished:" << aProfileName << ", status:" << aStatus;
 
     if (iActiveSessions.contains(aProfileName)) {
@@ -635,11 +826,13 @@ void Synchronizer::onSessionFinished(const QString &aProfileName,
             }
             case Sync::SYNC_ERROR: {
                 session->setFailureResult(SyncResults::SYNC_RESULT_FAILED, aErrorCode);
+                qCWarning(lcButeoMsyncd) << "Sync failed for" << aProfileName << ", error:" << aErrorCode;
+                LogRingBuffer::instance()->dump();
                 if (session->isProfileCreated()) {
                     iProfileManager.removeProfile(session->profileName());
                 }
 
-                QDateTime nextRetryInterval = iProfileManager.getNextRetryInterval(session->profile());
+                QDateTime nextRetryInterval = iProfileManager.getNextRetryInterval(session->profile(), aErrorCode);
                 if (nextRetryInterval.isValid()) {
                     if (iSyncScheduler) {
                         // can be null if in backup/restore state.
@@ -657,6 +850,7 @@ void Synchronizer::onSessionFinished(const QString &aProfileName,
             }
 
             iActiveSessions.remove(aProfileName);
+            iSyncQueue.sessionFinished(session);
             if (session->isScheduled()) {
                 // Calling this multiple times has no effect, even if the
                 // session was not actually opened
@@ -711,16 +905,15 @@ bool Synchronizer::startNextSync()
 
     SyncSession *session = iSyncQueue.head();
     if (session == 0) {
-        qCWarning(lcButeoMsyncd) << "Null session found from queue";
-        iSyncQueue.dequeue();
-        return true;
+        qCDebug(lcButeoMsyncd) << "All accounts with queued syncs are at their running sync limit";
+        return false;
     }
 
     SyncProfile *profile = session->profile();
     if (profile == 0) {
         qCWarning(lcButeoMsyncd) << "Null profile found from queued session";
         cleanupSession(session, Sync::SYNC_ERROR);
-        iSyncQueue.dequeue();
+        dequeueSession();
         return true;
     }
 
@@ -729,7 +922,7 @@ bool Synchronizer::startNextSync()
 
     if (session->isScheduled() && iBatteryInfo->isLowPower()) {
         qCWarning(lcButeoMsyncd) << "Low power, scheduled sync aborted";
-        iSyncQueue.dequeue();
+        dequeueSession();
         session->setFailureResult(SyncResults::SYNC_RESULT_FAILED, Buteo::SyncResults::LOW_BATTERY_POWER);
         cleanupSession(session, Sync::SYNC_ERROR);
         emit syncStatus(profileName, Sync::SYNC_ERROR, "Low Battery", Buteo::SyncResults::LOW_BATTERY_POWER);
@@ -742,7 +935,7 @@ bool Synchronizer::startNextSync()
         return false;
     } else {
         // Sync can be started now.
-        iSyncQueue.dequeue();
+        dequeueSession();
         if (startSyncNow(session)) {
             emit syncStatus(profileName, Sync::SYNC_STARTED, "", 0);
         } else {
@@ -763,6 +956,8 @@ void Synchronizer::cleanupSession(SyncSession *aSession, Sync::SyncStatus aStatu
 
     if (aSession) {
         QString profileName = aSession->profileName();
+        TraceScope traceScope("cleanupSession", "session", profileName);
+        TraceRecorder::instance()->asyncEnd("session", "session", profileName);
         if (!profileName.isEmpty()) {
             qCDebug(lcButeoMsyncd) << "Clean up session for profile" << profileName;
             SyncProfile *profile = aSession->profile();
@@ -773,12 +968,14 @@ void Synchronizer::cleanupSession(SyncSession *aSession, Sync::SyncStatus aStatu
 
             // UI needs to know that Sync Log has been updated.
             emit resultsAvailable(profileName, aSession->results().toString());
+            emit syncResultsAvailable(profileName, aSession->results());
 
             if (aSession->isScheduled()) {
                 reschedule(profileName);
                 emit signalProfileChanged(profileName, 1, QString());
             }
         }
+        iAccountIndex.setSyncState(profileName, AccountSyncIndex::STATE_IDLE);
         aSession->setProfileCreated(false);
         aSession->releaseStorages();
         aSession->deleteLater();
@@ -796,9 +993,10 @@ void Synchronizer::abortSync(QString aProfileName)
     } else {
         qCWarning(lcButeoMsyncd) << "No sync in progress with the given profile";
         // Check if sync was queued, in which case, remove it from the queue
-        SyncSession *queuedSession = iSyncQueue.dequeue(aProfileName);
+        SyncSession *queuedSession = dequeueSession(aProfileName);
         if (queuedSession) {
             qCDebug(lcButeoMsyncd) << "Removed queued sync" << aProfileName;
+            iAccountIndex.setSyncState(aProfileName, AccountSyncIndex::STATE_IDLE);
             delete queuedSession;
         }
         SyncResults syncResults(QDateTime::currentDateTime(), SyncResults::SYNC_RESULT_CANCELLED, Buteo::SyncResults::ABORTED);
@@ -849,16 +1047,22 @@ bool Synchronizer::cleanupProfile(const QString &aProfileId)
             return status;
         }
 
-        const SyncResults *syncResults = profile->lastResults();
-        if (!pluginRunner->cleanUp() && syncResults) {
-            qCCritical(lcButeoMsyncd) << "Error in removing anchors, sync session ";
-        } else {
-            qCDebug(lcButeoMsyncd) << "Removing the profile";
-            iProfileManager.removeProfile(aProfileId);
-            status = true;
-        }
-        delete profile;
-        delete pluginRunner;
+        // An out-of-process plug-in may still be starting, the profile is
+        // removed once it has cleaned up.
+        connect(pluginRunner, &PluginRunner::cleanUpDone, this,
+                [this, pluginRunner, profile, aProfileId](bool aSuccess) {
+            const SyncResults *syncResults = profile->lastResults();
+            if (!aSuccess && syncResults) {
+                qCCritical(lcButeoMsyncd) << "Error in removing anchors, sync session ";
+            } else {
+                qCDebug(lcButeoMsyncd) << "Removing the profile";
+                iProfileManager.removeProfile(aProfileId);
+            }
+            delete profile;
+            pluginRunner->deleteLater();
+        });
+        pluginRunner->startCleanUp();
+        status = true;
     }
     return status;
 }
@@ -1118,12 +1322,21 @@ void Synchronizer::startServers(bool resume)
             if (false == resume) {
                 startServer(server);
             } else {
-                ServerPluginRunner *pluginRunner = iServers[server];
+                ServerPluginRunner *pluginRunner = iServers.value(server);
                 if (pluginRunner) {
                     pluginRunner->resume();
                 }
             }
         }
+
+        if (resume) {
+            // Servers which were not loaded wait for connections again
+            foreach (ServerListener *listener, iServerListeners) {
+                if (!iServers.value(listener->serverName())) {
+                    listener->listen();
+                }
+            }
+        }
     } else {
         qCCritical(lcButeoMsyncd) << "No server plug-in activator";
     }
@@ -1139,6 +1352,23 @@ void Synchronizer::stopServers(bool suspend)
         iServerActivator->disconnect();
     }
 
+    if (false == suspend) {
+        // Also stops the servers which are waiting for a connection
+        QStringList listeningServers = iServerListeners.keys();
+        foreach (QString server, listeningServers) {
+            if (!iServers.contains(server)) {
+                stopServer(server);
+            }
+        }
+    } else {
+        // No server is loaded until resumed
+        foreach (ServerListener *listener, iServerListeners) {
+            if (!iServers.value(listener->serverName())) {
+                listener->close();
+            }
+        }
+    }
+
     QStringList activeServers = iServers.keys();
     foreach (QString server, activeServers) {
         if (false == suspend) {
@@ -1158,12 +1388,46 @@ void Synchronizer::startServer(const QString &aProfileName)
 
     qCDebug(lcButeoMsyncd) << "Starting server plug-in:" << aProfileName;
 
-    if (iServers.contains(aProfileName)) {
+    if (iServers.contains(aProfileName) || iServerListeners.contains(aProfileName)) {
         qCWarning(lcButeoMsyncd) << "Server thread already running for profile:" << aProfileName;
         // Remove reference from the activator
         iServerActivator->removeRef(aProfileName, false);
         return;
     }
+
+    Profile *serverProfile = loadServerProfile(aProfileName);
+    if (!serverProfile) {
+        return;
+    }
+
+    const QString endpoint = serverProfile->key(KEY_LISTEN_ENDPOINT);
+    if (!endpoint.isEmpty()) {
+        ServerListener *listener = new ServerListener(aProfileName, endpoint, this);
+        bool idleTimeoutOk = false;
+        int idleTimeout = serverProfile->key(KEY_LISTEN_IDLE_TIMEOUT).toInt(&idleTimeoutOk);
+        listener->setIdleTimeout(idleTimeoutOk ? idleTimeout * 1000 : iServerIdleTimeout);
+        listener->setServiceUuid(serverProfile->key(KEY_LISTEN_SERVICE_UUID));
+
+        if (listener->listen()) {
+            qCDebug(lcButeoMsyncd) << "Server" << aProfileName << "waits for a connection on" << endpoint;
+            connect(listener, &ServerListener::activated, this, &Synchronizer::onServerActivated);
+            connect(listener, &ServerListener::idle, this, &Synchronizer::onServerIdle);
+            iServerListeners.insert(aProfileName, listener);
+            delete serverProfile;
+            return;
+        }
+
+        qCWarning(lcButeoMsyncd) << "Cannot listen on" << endpoint << ", loading server" << aProfileName << "now";
+        delete listener;
+    }
+
+    startServerPlugin(aProfileName, serverProfile);
+}
+
+Profile *Synchronizer::loadServerProfile(const QString &aProfileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
     Profile *serverProfile = iProfileManager.profile(
                                  aProfileName, Profile::TYPE_SERVER);
 
@@ -1181,12 +1445,17 @@ void Synchronizer::startServer(const QString &aProfileName)
         qCWarning(lcButeoMsyncd) << "Profile not found or not valid:"  << aProfileName;
         delete serverProfile;
         serverProfile = nullptr;
-
-        return;
     }
 
+    return serverProfile;
+}
+
+bool Synchronizer::startServerPlugin(const QString &aProfileName, Profile *aProfile)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
     ServerPluginRunner *pluginRunner = new ServerPluginRunner(aProfileName,
-                                                              serverProfile, &iPluginManager, this, iServerActivator, this);
+                                                              aProfile, &iPluginManager, this, iServerActivator, this);
 
     // Relay connectivity state change signal to plug-in runner.
     connect(iTransportTracker, SIGNAL(connectivityStateChanged(Sync::ConnectivityType, bool)),
@@ -1201,11 +1470,11 @@ void Synchronizer::startServer(const QString &aProfileName)
         delete pluginRunner;
         pluginRunner = nullptr;
 
-        return;
+        return false;
     }
 
     iServers.insert(aProfileName, pluginRunner);
-
+    return true;
 }
 
 void Synchronizer::stopServer(const QString &aProfileName)
@@ -1214,6 +1483,10 @@ void Synchronizer::stopServer(const QString &aProfileName)
 
     qCDebug(lcButeoMsyncd) << "Stopping server:" << aProfileName;
 
+    // Taken first, so that the listener does not restart when the plug-in
+    // runner is done.
+    ServerListener *listener = iServerListeners.take(aProfileName);
+
     if (iServers.contains(aProfileName)) {
         ServerPluginRunner *pluginRunner = iServers[aProfileName];
         if (pluginRunner) {
@@ -1232,9 +1505,59 @@ void Synchronizer::stopServer(const QString &aProfileName)
             delete pluginRunner;
         }
         pluginRunner = nullptr;
-    } else {
+    } else if (!listener) {
         qCWarning(lcButeoMsyncd) << "Server not found";
     }
+
+    // stop() has returned, so the plug-in no longer uses the endpoint
+    delete listener;
+}
+
+void Synchronizer::onServerActivated(const QString &aProfileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    ServerListener *listener = iServerListeners.value(aProfileName);
+    if (!listener || iServers.contains(aProfileName)) {
+        return;
+    }
+
+    TraceScope traceScope("activateServer", "server", aProfileName);
+
+    // Not listening again on failure, the pending connection would
+    // activate the server right away.
+    Profile *serverProfile = loadServerProfile(aProfileName);
+    if (!serverProfile) {
+        listener->close();
+        return;
+    }
+
+    // The plug-in accepts the pending connection from the listening
+    // socket, an out-of-process plug-in gets it passed over D-Bus.
+    if (listener->socketDescriptor() >= 0) {
+        serverProfile->setKey(KEY_LISTEN_FD, QString::number(listener->socketDescriptor()));
+    }
+
+    Metrics::instance()->counter(QStringLiteral("msyncd_server_activations_total"))->add();
+
+    if (startServerPlugin(aProfileName, serverProfile)) {
+        listener->watch(iServers.value(aProfileName));
+    } else {
+        qCWarning(lcButeoMsyncd) << "Failed to activate server" << aProfileName;
+        listener->close();
+    }
+}
+
+void Synchronizer::onServerIdle(const QString &aProfileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    ServerPluginRunner *pluginRunner = iServers.value(aProfileName);
+    if (pluginRunner) {
+        qCDebug(lcButeoMsyncd) << "Unloading idle server" << aProfileName;
+        // onServerDone() starts listening again
+        pluginRunner->stop();
+    }
 }
 
 void Synchronizer::onServerDone()
@@ -1251,9 +1574,16 @@ void Synchronizer::onServerDone()
     qCDebug(lcButeoMsyncd) << "Server stopped:" << serverName;
     if (iServers.values().contains(pluginRunner)) {
         qCDebug(lcButeoMsyncd) << "Deleting server";
-        iServers.remove(iServers.key(pluginRunner));
+        const QString profileName = iServers.key(pluginRunner);
+        iServers.remove(profileName);
         pluginRunner->deleteLater();
         pluginRunner = nullptr;
+
+        // An on-demand server waits for the next connection
+        ServerListener *listener = iServerListeners.value(profileName);
+        if (listener && !iClosing && !listener->listen()) {
+            qCWarning(lcButeoMsyncd) << "Cannot listen on" << listener->endpoint() << "again";
+        }
     }
 }
 
@@ -1333,6 +1663,7 @@ void Synchronizer::onNewSession(const QString &aDestination)
         }
 
         SyncSession *session = new SyncSession(profile, this);
+        session->setProgressTimeout(iProgressTimeout);
         qCDebug(lcButeoMsyncd) << "Disable sync on change";
         //As sync is ongoing, disable sync on change for now, we can query later if
         //there are changes.
@@ -1357,6 +1688,7 @@ void Synchronizer::onNewSession(const QString &aDestination)
         session->setStorageMap(storageMap);
 
         iActiveSessions.insert(profile->name(), session);
+        iAccountIndex.setSyncState(profile->name(), AccountSyncIndex::STATE_RUNNING);
 
         // Connect signals from sync session.
         connect(session, SIGNAL(transferProgress(const QString &,
@@ -1382,24 +1714,40 @@ void Synchronizer::onNewSession(const QString &aDestination)
 
 void Synchronizer::slotProfileChanged(QString aProfileName, int aChangeType, QString aProfileAsXml)
 {
+    if (aChangeType == ProfileManager::PROFILE_REMOVED) {
+        iAccountIndex.removeProfile(aProfileName);
+    } else {
+        SyncProfile *profile = iProfileManager.syncProfile(aProfileName);
+        if (profile) {
+            iAccountIndex.updateProfile(*profile);
+            delete profile;
+        }
+    }
+
+    // The index is up to date with our own write, the directory watcher
+    // does not need to reload the file.
+    QFileInfo profileFile(syncProfileDir() + QDir::separator() + aProfileName + QStringLiteral(".xml"));
+    if (profileFile.exists()) {
+        iProfileFileTimes.insert(aProfileName, profileFile.lastModified());
+    } else {
+        iProfileFileTimes.remove(aProfileName);
+    }
+
     // queue up a sync when a new profile is added or an existing profile is modified.
     // we coalesce changes to profiles so that we do not trigger syncs immediately
     // on change, to avoid thrash during backup/restore and races if the client wishes
     // to trigger manually.  Temporary until we can improve Buteo's SyncOnChange handler.
     switch (aChangeType) {
     case ProfileManager::PROFILE_ADDED:
-        iProfileChangeTriggerQueue.append(qMakePair(aProfileName, ProfileManager::PROFILE_ADDED));
+        addProfileChange(aProfileName, ProfileManager::PROFILE_ADDED);
         iProfileChangeTriggerTimer.start(30000); // 30 seconds.
         break;
     case ProfileManager::PROFILE_REMOVED:
         iSyncOnChangeScheduler.removeProfile(aProfileName);
-        iWaitingOnlineSyncs.removeAll(aProfileName);
-        for (int i = iProfileChangeTriggerQueue.size() - 1; i >= 0; --i) {
-            if (iProfileChangeTriggerQueue[i].first == aProfileName) {
-                qCDebug(lcButeoMsyncd) << "Removing queued profile change sync due to profile removal:"
-                                       << aProfileName;
-                iProfileChangeTriggerQueue.removeAt(i);
-            }
+        removeWaitingOnlineSync(aProfileName);
+        if (removeProfileChanges(aProfileName)) {
+            qCDebug(lcButeoMsyncd) << "Removed queued profile change sync due to profile removal:"
+                                   << aProfileName;
         }
         break;
     case ProfileManager::PROFILE_MODIFIED: {
@@ -1411,7 +1759,7 @@ void Synchronizer::slotProfileChanged(QString aProfileName, int aChangeType, QSt
             }
         }
         if (!alreadyQueued) {
-            iProfileChangeTriggerQueue.append(qMakePair(aProfileName, ProfileManager::PROFILE_MODIFIED));
+            addProfileChange(aProfileName, ProfileManager::PROFILE_MODIFIED);
         }
         iProfileChangeTriggerTimer.start(30000); // 30 seconds.
         break;
@@ -1427,7 +1775,8 @@ void Synchronizer::profileChangeTriggerTimeout()
         return;
     }
 
-    QPair<QString, ProfileManager::ProfileChangeType> queuedChange = iProfileChangeTriggerQueue.takeFirst();
+    QPair<QString, ProfileManager::ProfileChangeType> queuedChange = iProfileChangeTriggerQueue.first();
+    removeProfileChanges(queuedChange.first);
     SyncProfile *profile = iProfileManager.syncProfile(queuedChange.first);
     if (profile) {
         if (queuedChange.second == ProfileManager::PROFILE_ADDED) {
@@ -1447,6 +1796,197 @@ void Synchronizer::profileChangeTriggerTimeout()
     QMetaObject::invokeMethod(this, "profileChangeTriggerTimeout", Qt::QueuedConnection);
 }
 
+void Synchronizer::queueSession(SyncSession *aSession)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iSyncQueue.enqueue(aSession);
+    iAccountIndex.setSyncState(aSession->profileName(), AccountSyncIndex::STATE_QUEUED);
+    pendingSyncsChanged();
+}
+
+SyncSession *Synchronizer::dequeueSession()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    SyncSession *session = iSyncQueue.dequeue();
+    if (session) {
+        pendingSyncsChanged();
+    }
+    return session;
+}
+
+SyncSession *Synchronizer::dequeueSession(const QString &aProfileName)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    SyncSession *session = iSyncQueue.dequeue(aProfileName);
+    if (session) {
+        pendingSyncsChanged();
+    }
+    return session;
+}
+
+void Synchronizer::addWaitingOnlineSync(const QString &aProfileName)
+{
+    if (!iWaitingOnlineSyncs.contains(aProfileName)) {
+        iWaitingOnlineSyncs.append(aProfileName);
+        pendingSyncsChanged();
+    }
+}
+
+void Synchronizer::removeWaitingOnlineSync(const QString &aProfileName)
+{
+    if (iWaitingOnlineSyncs.removeAll(aProfileName) > 0) {
+        pendingSyncsChanged();
+    }
+}
+
+void Synchronizer::addProfileChange(const QString &aProfileName,
+                                    ProfileManager::ProfileChangeType aChangeType)
+{
+    QPair<QString, ProfileManager::ProfileChangeType> change(aProfileName, aChangeType);
+    if (!iProfileChangeTriggerQueue.contains(change)) {
+        iProfileChangeTriggerQueue.append(change);
+        pendingSyncsChanged();
+    }
+}
+
+bool Synchronizer::removeProfileChanges(const QString &aProfileName)
+{
+    bool removed = false;
+    for (int i = iProfileChangeTriggerQueue.size() - 1; i >= 0; --i) {
+        if (iProfileChangeTriggerQueue.at(i).first == aProfileName) {
+            iProfileChangeTriggerQueue.removeAt(i);
+            removed = true;
+        }
+    }
+    if (removed) {
+        pendingSyncsChanged();
+    }
+    return removed;
+}
+
+void Synchronizer::rebuildAccountIndex()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    iProfileFileTimes = profileFileTimes();
+    QList<SyncProfile *> allProfiles = iProfileManager.allSyncProfiles();
+    iAccountIndex.rebuild(allProfiles);
+    qDeleteAll(allProfiles);
+}
+
+void Synchronizer::reindexChangedProfiles()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    const QHash<QString, QDateTime> times = profileFileTimes();
+    QSet<QString> changed;
+    for (auto it = times.constBegin(); it != times.constEnd(); ++it) {
+        if (iProfileFileTimes.value(it.key()) != it.value()) {
+            changed.insert(it.key());
+        }
+    }
+    for (auto it = iProfileFileTimes.constBegin(); it != iProfileFileTimes.constEnd(); ++it) {
+        if (!times.contains(it.key())) {
+            changed.insert(it.key());
+        }
+    }
+    iProfileFileTimes = times;
+
+    // A removed file may uncover a system profile of the same name, so
+    // the profile is looked up again in either case.
+    foreach (const QString &profileName, changed) {
+        qCDebug(lcButeoMsyncd) << "Profile changed on disk, reindexing" << profileName;
+        SyncProfile *profile = iProfileManager.syncProfile(profileName);
+        if (profile) {
+            iAccountIndex.updateProfile(*profile);
+            delete profile;
+        } else {
+            iAccountIndex.removeProfile(profileName);
+        }
+    }
+}
+
+void Synchronizer::pendingSyncsChanged()
+{
+    if (iPendingSyncsReplayed && !iClosing) {
+        iPendingSyncsTimer.start();
+    }
+}
+
+void Synchronizer::writePendingSyncs()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    PendingSyncsJournal journal;
+    foreach (SyncSession *session, iSyncQueue.getQueuedSyncSessions()) {
+        journal.iQueue.append(PendingSyncsJournal::QueuedSync(session->profileName(),
+                                                              session->isScheduled(),
+                                                              iSyncQueue.enqueueTime(session)));
+    }
+    journal.iWaitingOnline = iWaitingOnlineSyncs;
+    journal.iProfileChanges = iProfileChangeTriggerQueue;
+    journal.save(Sync::syncConfigDir() + QDir::separator() + PENDING_SYNCS_FILE);
+}
+
+void Synchronizer::replayPendingSyncs()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    PendingSyncsJournal journal;
+    journal.load(Sync::syncConfigDir() + QDir::separator() + PENDING_SYNCS_FILE);
+
+    QList<PendingSyncsJournal::QueuedSync> queued;
+    foreach (const PendingSyncsJournal::QueuedSync &request, journal.iQueue) {
+        SyncProfile *profile = iProfileManager.syncProfile(request.iProfileName);
+        if (!profile) {
+            continue;
+        }
+        // A scheduled request is obsolete if the profile has synced since.
+        QDateTime enqueued = QDateTime::fromMSecsSinceEpoch(request.iEnqueueTime);
+        if (!request.iScheduled || !profile->lastSyncTime().isValid()
+                || profile->lastSyncTime() < enqueued) {
+            queued.append(request);
+        }
+        delete profile;
+    }
+
+    qCDebug(lcButeoMsyncd) << "Replaying pending syncs:" << queued.size() << "queued,"
+                           << journal.iWaitingOnline.size() << "waiting online,"
+                           << journal.iProfileChanges.size() << "profile changes";
+
+    // The journal may be rewritten from now on.
+    iPendingSyncsReplayed = true;
+
+    // startSync() ignores requests for profiles already queued or running,
+    // which merges the replayed requests with the alarms that were due.
+    foreach (const PendingSyncsJournal::QueuedSync &request, queued) {
+        if (request.iScheduled) {
+            startScheduledSync(request.iProfileName);
+        } else {
+            startSync(request.iProfileName);
+        }
+    }
+
+    foreach (const QString &profileName, journal.iWaitingOnline) {
+        if (!iSyncQueue.contains(profileName) && !iActiveSessions.contains(profileName)) {
+            startScheduledSync(profileName);
+        }
+    }
+
+    for (int i = 0; i < journal.iProfileChanges.size(); ++i) {
+        addProfileChange(journal.iProfileChanges.at(i).first, journal.iProfileChanges.at(i).second);
+    }
+    if (!iProfileChangeTriggerQueue.isEmpty()) {
+        iProfileChangeTriggerTimer.start(30000); // 30 seconds.
+    }
+
+    // Requests which were dropped as obsolete are removed from the journal.
+    pendingSyncsChanged();
+}
+
 void Synchronizer::reschedule(const QString &aProfileName)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
@@ -1473,38 +2013,34 @@ void Synchronizer::reschedule(const QString &aProfileName)
 void Synchronizer::slotSyncStatus(QString aProfileName, int aStatus, QString aMessage, int aMoreDetails)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
-    SyncProfile *profile = iProfileManager.syncProfile(aProfileName);
 
-    if (profile) {
-        QString accountId = profile->key(KEY_ACCOUNT_ID);
-        if (!accountId.isNull()) {
-            switch (aStatus) {
-            case Sync::SYNC_QUEUED:
-            case Sync::SYNC_STARTED:
-            case Sync::SYNC_ERROR:
-            case Sync::SYNC_DONE:
-            case Sync::SYNC_ABORTED:
-            case Sync::SYNC_CANCELLED:
-            case Sync::SYNC_NOTPOSSIBLE: {
-                qCDebug(lcButeoMsyncd) << "Sync status changed for account" << accountId;
-                qlonglong aPrevSyncTime;
-                qlonglong aNextSyncTime;
-                int aFailedReason;
-                int aNewStatus = status(accountId.toUInt(), aFailedReason, aPrevSyncTime, aNextSyncTime);
-                emit statusChanged(accountId.toUInt(), aNewStatus, aFailedReason, aPrevSyncTime, aNextSyncTime);
-            }
-            break;
-            case Sync::SYNC_STOPPING:
-            case Sync::SYNC_PROGRESS:
-            default:
-                break;
-            }
+    QString accountId = iAccountIndex.accountId(aProfileName);
+    if (!accountId.isEmpty()) {
+        switch (aStatus) {
+        case Sync::SYNC_QUEUED:
+        case Sync::SYNC_STARTED:
+        case Sync::SYNC_ERROR:
+        case Sync::SYNC_DONE:
+        case Sync::SYNC_ABORTED:
+        case Sync::SYNC_CANCELLED:
+        case Sync::SYNC_NOTPOSSIBLE: {
+            qCDebug(lcButeoMsyncd) << "Sync status changed for account" << accountId;
+            qlonglong aPrevSyncTime;
+            qlonglong aNextSyncTime;
+            int aFailedReason;
+            int aNewStatus = status(accountId.toUInt(), aFailedReason, aPrevSyncTime, aNextSyncTime);
+            emit statusChanged(accountId.toUInt(), aNewStatus, aFailedReason, aPrevSyncTime, aNextSyncTime);
         }
-        if (iSyncScheduler) {
-            // can be null if in backup/restore state.
-            iSyncScheduler->syncStatusChanged(aProfileName, aStatus, aMessage, aMoreDetails);
+        break;
+        case Sync::SYNC_STOPPING:
+        case Sync::SYNC_PROGRESS:
+        default:
+            break;
         }
-        delete profile;
+    }
+    if (iSyncScheduler) {
+        // can be null if in backup/restore state.
+        iSyncScheduler->syncStatusChanged(aProfileName, aStatus, aMessage, aMoreDetails);
     }
 }
 
@@ -1579,6 +2115,11 @@ void Synchronizer::backupRestoreFinished()
 {
     qCDebug(lcButeoMsyncd) << "Synchronizer::backupFinished";
     iClosing = false;
+    // A restore replaces the profiles without change notifications
+    rebuildAccountIndex();
+    // Changes made while the journal was not written, or the journal
+    // brought back by a restore, are replaced with the current state.
+    pendingSyncsChanged();
     startServers(true);
     initializeScheduler();
     iSyncBackup->sendReply(0);
@@ -1646,81 +2187,15 @@ int Synchronizer::status(unsigned int aAccountId, int &aFailedReason, qlonglong
                          qlonglong &aNextSyncTime)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
-    int status = 1; // Initialize to Done
-    QDateTime prevSyncTime; // Initialize to invalid
-    QDateTime nextSyncTime;
-    QList<SyncProfile *> profileList = iAccounts->getProfilesByAccountId(aAccountId);
-
-    foreach (SyncProfile *profile, profileList) {
-        // First check if sync is going on for any profile corresponding to this
-        // account ID
-        if (iActiveSessions.contains(profile->name()) || iSyncQueue.contains(profile->name())) {
-            qCDebug(lcButeoMsyncd) << "Sync running for" << aAccountId;
-            status = 0;
-            break;
-        } else {
-            // Check if the last sync resulted in an error for any of the
-            // profiles
-            const SyncResults *lastResults = profile->lastResults();
-            if (lastResults && SyncResults::SYNC_RESULT_FAILED == lastResults->majorCode()) {
-                status = 2;
-                // TODO: Determine the set of failure enums needed here
-                aFailedReason = lastResults->minorCode();
-                break;
-            }
-        }
-    }
 
-    if (status != 0) {
-        // Need to return the next and last sync times
-        foreach (SyncProfile *profile, profileList) {
-            if (!prevSyncTime.isValid()) {
-                prevSyncTime = profile->lastSyncTime();
-            } else {
-                (prevSyncTime > profile->lastSyncTime()) ? prevSyncTime : profile->lastSyncTime();
-            }
-        }
-        if (prevSyncTime.isValid()) {
-            // Doesn't really matter which profile we do this for, as all of
-            // them have the same schedule
-            SyncProfile *profile = profileList.first();
-            nextSyncTime = profile->nextSyncTime(prevSyncTime);
-        }
-    }
-    aPrevSyncTime = prevSyncTime.toMSecsSinceEpoch();
-    aNextSyncTime = nextSyncTime.toMSecsSinceEpoch();
-    qDeleteAll(profileList);
-    return status;
+    return iAccountIndex.status(aAccountId, aFailedReason, aPrevSyncTime, aNextSyncTime);
 }
 
 QList<unsigned int> Synchronizer::syncingAccounts()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
-    QList<unsigned int> syncingAccountsList;
-    // Check active sessions
-    QList<SyncSession *> activeSessions = iActiveSessions.values();
 
-    foreach (SyncSession *session, activeSessions) {
-        if (session->profile()) {
-            SyncProfile *profile = session->profile();
-            QString accountId = profile->key(KEY_ACCOUNT_ID);
-            if (!accountId.isNull()) {
-                syncingAccountsList.append(accountId.toUInt());
-            }
-        }
-    }
-    // Check queued syncs
-    const QList<SyncSession *> queuedSessions = iSyncQueue.getQueuedSyncSessions();
-    foreach (const SyncSession *session, queuedSessions) {
-        if (session->profile()) {
-            SyncProfile *profile = session->profile();
-            QString accountId = profile->key(KEY_ACCOUNT_ID);
-            if (!accountId.isNull()) {
-                syncingAccountsList.append(accountId.toUInt());
-            }
-        }
-    }
-    return syncingAccountsList;
+    return iAccountIndex.syncingAccounts();
 }
 
 QString Synchronizer::getLastSyncResult(const QString &aProfileId)
@@ -1746,6 +2221,28 @@ QString Synchronizer::getLastSyncResult(const QString &aProfileId)
     return lastSyncResult;
 }
 
+SyncResults Synchronizer::lastSyncResults(const QString &aProfileId)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!aProfileId.isEmpty()) {
+        SyncProfile *profile = iProfileManager.syncProfile(aProfileId);
+        if (profile) {
+            const SyncResults *syncResults = profile->lastResults();
+            if (syncResults) {
+                const SyncResults results(*syncResults);
+                delete profile;
+                return results;
+            }
+            qCDebug(lcButeoMsyncd) << "SyncResults not Found!!!";
+            delete profile;
+        } else {
+            qCDebug(lcButeoMsyncd) << "No profile found with aProfileId" << aProfileId;
+        }
+    }
+    return SyncResults(QDateTime(), SyncResults::SYNC_RESULT_INVALID, SyncResults::NO_ERROR);
+}
+
 QStringList Synchronizer::allVisibleSyncProfiles()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
@@ -1852,7 +2349,7 @@ void Synchronizer::onNetworkStateChanged(bool aState, Sync::InternetConnectionTy
             if (acceptScheduledSync(aState, type, profile)) {
                 // start sync now, we do not need to call 'startScheduledSync' since that function
                 // only checks for internet connection
-                iWaitingOnlineSyncs.removeOne(profileName);
+                removeWaitingOnlineSync(profileName);
                 startSync(profileName, true);
             }
             delete profile;
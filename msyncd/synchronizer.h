@@ -27,6 +27,7 @@
 
 #include "SyncDBusInterface.h"
 #include "SyncQueue.h"
+#include "AccountSyncIndex.h"
 #include "StorageBooker.h"
 #include "SyncScheduler.h"
 #include "SyncBackup.h"
@@ -47,6 +48,8 @@
 #include <QDBusInterface>
 #include <QScopedPointer>
 #include <QTimer>
+#include <QFileSystemWatcher>
+#include <QDateTime>
 
 struct _GSettings;
 
@@ -54,11 +57,14 @@ namespace Buteo {
 
 class PluginManager;
 class ServerPluginRunner;
+class ServerListener;
 class NetworkManager;
 class TransportTracker;
 class ServerActivator;
 class AccountsHelper;
 class BatteryInfo;
+class MetricsExporter;
+class TraceController;
 
 /// \brief The main entry point to the synchronization framework.
 ///
@@ -141,6 +147,9 @@ public slots:
     //! \see SyncDBusInterface::saveSyncResults
     virtual bool saveSyncResults(QString aProfileId, QString aSyncResults);
 
+    //! \see SyncDBusInterface::storeSyncResults
+    virtual bool storeSyncResults(QString aProfileId, Buteo::SyncResults aSyncResults);
+
     //! \see SyncDBusInterface::createSyncProfileForAccount
     virtual QString createSyncProfileForAccount(uint aAccountId);
 
@@ -150,6 +159,9 @@ public slots:
      */
     virtual QString getLastSyncResult(const QString &aProfileId);
 
+    //! \see SyncDBusInterface::lastSyncResults
+    virtual Buteo::SyncResults lastSyncResults(const QString &aProfileId);
+
     /*! \brief Gets all visible sync profiles.
      *
      * Returns all sync profiles that should be visible in sync ui. A profile
@@ -278,6 +290,18 @@ private slots:
      */
     void stopServer(const QString &aProfileName);
 
+    /*! \brief Loads a server plug-in which waited for a connection
+     *
+     * @param aProfileName Server profile name
+     */
+    void onServerActivated(const QString &aProfileName);
+
+    /*! \brief Unloads an activated server plug-in which has gone idle
+     *
+     * @param aProfileName Server profile name
+     */
+    void onServerIdle(const QString &aProfileName);
+
     void onNetworkStateChanged(bool aState, Sync::InternetConnectionType type);
 
     /*! \brief call this to request the sync daemon to enable soc
@@ -320,6 +344,22 @@ private slots:
     /*! \brief Triggers sync for profiles which were queued for sync due to profile changes. */
     void profileChangeTriggerTimeout();
 
+    /*! \brief Writes the pending sync requests to the journal file. */
+    void writePendingSyncs();
+
+    /*! \brief Restarts the sync requests that were pending when msyncd was
+     * stopped last time, as recorded in the journal file.
+     */
+    void replayPendingSyncs();
+
+    /*! \brief Reloads the account index from the stored profiles. */
+    void rebuildAccountIndex();
+
+    /*! \brief Reindexes the profiles whose files were changed by other
+     * processes since the last check.
+     */
+    void reindexChangedProfiles();
+
 private:
     bool startSync(const QString &aProfileName, bool aScheduled);
 
@@ -357,6 +397,21 @@ private:
      */
     void stopServers(bool suspend = false);
 
+    /*! \brief Loads and expands a server profile
+     *
+     * @param aProfileName Server profile name
+     * @return Valid profile owned by the caller, or null
+     */
+    Profile *loadServerProfile(const QString &aProfileName);
+
+    /*! \brief Creates and starts the plug-in runner of a server
+     *
+     * @param aProfileName Server profile name
+     * @param aProfile Server profile, ownership is transferred
+     * @return Success indicator
+     */
+    bool startServerPlugin(const QString &aProfileName, Profile *aProfile);
+
     /*! \brief Helper function when backup/restore starts.
      *
      */
@@ -375,9 +430,12 @@ private:
     bool isBackupRestoreInProgress();
 
     /*! \brief Requests for a cleanup from the plugin for the given profileId
+     *
+     * The profile is removed once the plugin has cleaned up, which may
+     * happen after this returns.
      *
      * @param aProfileId Name/Id of the profile
-     * @return True or False to indicate success or failure
+     * @return True if the cleanup was started
      */
     bool cleanupProfile(const QString &profileId);
 
@@ -405,23 +463,77 @@ private:
      */
     void reportExternalSyncStatus(const SyncProfile *aProfile, bool force = false);
 
+    /*! \brief Schedules writing of the pending sync requests journal.
+     *
+     * Called by the functions below, which are the only ones modifying the
+     * sync queue, the list of syncs waiting for connectivity and the queue
+     * of profile change syncs. Changes made during one event loop iteration
+     * are written at once.
+     */
+    void pendingSyncsChanged();
+
+    /*! \brief Adds a session to the sync queue.
+     *
+     * @param aSession Session to queue
+     */
+    void queueSession(SyncSession *aSession);
+
+    /*! \brief Removes the head of the sync queue.
+     *
+     * @return Removed session, NULL if no session can be started
+     */
+    SyncSession *dequeueSession();
+
+    /*! \brief Removes the queued session of a profile.
+     *
+     * @param aProfileName Name of the profile
+     * @return Removed session, NULL if the profile was not queued
+     */
+    SyncSession *dequeueSession(const QString &aProfileName);
+
+    //! \brief Adds a scheduled sync to wait for a suitable connection.
+    void addWaitingOnlineSync(const QString &aProfileName);
+
+    //! \brief Removes a sync from the syncs waiting for a connection.
+    void removeWaitingOnlineSync(const QString &aProfileName);
+
+    //! \brief Queues a sync triggered by a profile change.
+    void addProfileChange(const QString &aProfileName,
+                          ProfileManager::ProfileChangeType aChangeType);
+
+    /*! \brief Removes the syncs triggered by changes of a profile.
+     *
+     * @return True if any were removed
+     */
+    bool removeProfileChanges(const QString &aProfileName);
+
     QMap<QString, SyncSession *> iActiveSessions;
     QMap<QString, bool> iExternalSyncProfileStatus;
     QList<QString> iProfilesToRemove;
     QMap<QString, ServerPluginRunner *> iServers;
+    // Servers loaded on demand, by profile name
+    QMap<QString, ServerListener *> iServerListeners;
     QList<QString> iWaitingOnlineSyncs;
     NetworkManager *iNetworkManager;
     QMap<QString, int> iCountersStorage;
     PluginManager iPluginManager;
     ProfileManager iProfileManager;
     SyncQueue iSyncQueue;
+    AccountSyncIndex iAccountIndex;
     StorageBooker iStorageBooker;
     SyncScheduler *iSyncScheduler;
     SyncBackup *iSyncBackup;
+    MetricsExporter *iMetricsExporter;
+    TraceController *iTraceController;
     TransportTracker *iTransportTracker;
     ServerActivator *iServerActivator;
     AccountsHelper *iAccounts;
     bool iClosing;
+    bool iPendingSyncsReplayed;
+    // Progress deadline of sync sessions in milliseconds
+    int iProgressTimeout;
+    // Idle time in milliseconds after which on-demand servers are unloaded
+    int iServerIdleTimeout;
     SyncOnChange iSyncOnChange;
     SyncOnChangeScheduler iSyncOnChangeScheduler;
 
@@ -449,6 +561,13 @@ private:
      */
     QList<QPair<QString, ProfileManager::ProfileChangeType> > iProfileChangeTriggerQueue;
     QTimer iProfileChangeTriggerTimer;
+    QTimer iPendingSyncsTimer;
+
+    // Reindexes profiles written by other processes. Modification times of
+    // the profile files as last seen by the index, by profile name.
+    QFileSystemWatcher iProfileWatcher;
+    QTimer iAccountIndexTimer;
+    QHash<QString, QDateTime> iProfileFileTimes;
 
 #ifdef SYNCFW_UNIT_TESTS
     friend class SynchronizerTest;
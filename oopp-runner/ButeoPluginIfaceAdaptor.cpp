@@ -75,6 +75,26 @@ void ButeoPluginIfaceAdaptor::resume()
     QMetaObject::invokeMethod(parent(), "resume");
 }
 
+bool ButeoPluginIfaceAdaptor::setListenSocket(const QDBusUnixFileDescriptor &aSocket)
+{
+    // handle method call com.buteo.msyncd.baseplugin.setListenSocket
+    bool out0;
+    QMetaObject::invokeMethod(parent(), "setListenSocket", Q_RETURN_ARG(bool, out0),
+                              Q_ARG(QDBusUnixFileDescriptor, aSocket));
+    return out0;
+}
+
+bool ButeoPluginIfaceAdaptor::setPluginParams(const QString &aPluginName, const QString &aProfileName,
+                                              const QString &aPluginFilePath)
+{
+    // handle method call com.buteo.msyncd.baseplugin.setPluginParams
+    bool out0;
+    QMetaObject::invokeMethod(parent(), "setPluginParams", Q_RETURN_ARG(bool, out0),
+                              Q_ARG(QString, aPluginName), Q_ARG(QString, aProfileName),
+                              Q_ARG(QString, aPluginFilePath));
+    return out0;
+}
+
 bool ButeoPluginIfaceAdaptor::startListen()
 {
     // handle method call com.buteo.msyncd.baseplugin.startListen
@@ -103,6 +123,14 @@ void ButeoPluginIfaceAdaptor::suspend()
     QMetaObject::invokeMethod(parent(), "suspend");
 }
 
+Buteo::SyncResults ButeoPluginIfaceAdaptor::syncResults()
+{
+    // handle method call com.buteo.msyncd.baseplugin.syncResults
+    Buteo::SyncResults out0;
+    QMetaObject::invokeMethod(parent(), "syncResults", Q_RETURN_ARG(Buteo::SyncResults, out0));
+    return out0;
+}
+
 bool ButeoPluginIfaceAdaptor::uninit()
 {
     // handle method call com.buteo.msyncd.baseplugin.uninit
@@ -14,6 +14,7 @@
 
 #include <QtCore/QObject>
 #include <QtDBus/QtDBus>
+#include <SyncResults.h>
 QT_BEGIN_NAMESPACE
 class QByteArray;
 template<class T> class QList;
@@ -70,10 +71,20 @@ class ButeoPluginIfaceAdaptor: public QDBusAbstractAdaptor
                 "    <method name=\"getSyncResults\">\n"
                 "      <arg direction=\"out\" type=\"s\"/>\n"
                 "    </method>\n"
+                "    <method name=\"syncResults\">\n"
+                "      <arg direction=\"out\" type=\"(xiisba(s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis)))\"/>\n"
+                "      <annotation value=\"Buteo::SyncResults\" name=\"org.qtproject.QtDBus.QtTypeName.Out0\"/>\n"
+                "    </method>\n"
                 "    <method name=\"connectivityStateChanged\">\n"
                 "      <arg direction=\"in\" type=\"i\" name=\"aType\"/>\n"
                 "      <arg direction=\"in\" type=\"b\" name=\"aState\"/>\n"
                 "    </method>\n"
+                "    <method name=\"setPluginParams\">\n"
+                "      <arg direction=\"in\" type=\"s\" name=\"aPluginName\"/>\n"
+                "      <arg direction=\"in\" type=\"s\" name=\"aProfileName\"/>\n"
+                "      <arg direction=\"in\" type=\"s\" name=\"aPluginFilePath\"/>\n"
+                "      <arg direction=\"out\" type=\"b\"/>\n"
+                "    </method>\n"
                 "    <method name=\"startSync\">\n"
                 "      <arg direction=\"out\" type=\"b\"/>\n"
                 "    </method>\n"
@@ -86,6 +97,10 @@ class ButeoPluginIfaceAdaptor: public QDBusAbstractAdaptor
                 "    <method name=\"stopListen\"/>\n"
                 "    <method name=\"suspend\"/>\n"
                 "    <method name=\"resume\"/>\n"
+                "    <method name=\"setListenSocket\">\n"
+                "      <arg direction=\"in\" type=\"h\" name=\"aSocket\"/>\n"
+                "      <arg direction=\"out\" type=\"b\"/>\n"
+                "    </method>\n"
                 "  </interface>\n"
                 "")
 public:
@@ -100,10 +115,13 @@ public Q_SLOTS: // METHODS
     QString getSyncResults();
     bool init();
     void resume();
+    bool setListenSocket(const QDBusUnixFileDescriptor &aSocket);
+    bool setPluginParams(const QString &aPluginName, const QString &aProfileName, const QString &aPluginFilePath);
     bool startListen();
     bool startSync();
     void stopListen();
     void suspend();
+    Buteo::SyncResults syncResults();
     bool uninit();
 Q_SIGNALS: // SIGNALS
     void accquiredStorage(const QString &aMimeType);
@@ -23,13 +23,30 @@
 
 #include <SyncResults.h>
 #include <ProfileManager.h>
+#include <ProfileEngineDefs.h>
 #include <LogMacros.h>
 #include <SyncCommonDefs.h>
 #include <ClientPlugin.h>
 #include <ServerPlugin.h>
 
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
 #include <QPluginLoader>
 #include <QFileInfo>
+#include <QRegularExpression>
+#include <QTimer>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define DBUS_SERVICE_NAME_PREFIX "com.buteo.msyncd.plugin."
+#define DBUS_SERVICE_OBJ_PATH "/"
+#define PEER_OBJECT_PATH "/msyncd"
+#define PEER_INTERFACE "com.buteo.msyncd.pluginpeer"
+
+// msyncd answers attach() from its event loop right away
+static const int PEER_ATTACH_TIMEOUT = 5000;
 
 using namespace Buteo;
 
@@ -43,6 +60,7 @@ PluginServiceObj::PluginServiceObj(const QString &aPluginName,
     , iProfileName(aProfileName)
     , iPluginFilePath(aPluginFilePath)
 {
+    SyncResults::registerDBusTypes();
 }
 
 PluginServiceObj::~PluginServiceObj()
@@ -51,6 +69,59 @@ PluginServiceObj::~PluginServiceObj()
     iPlugin = nullptr;
 
     delete iPluginCb;
+
+    if (iListenFd >= 0) {
+        ::close(iListenFd);
+    }
+}
+
+QString PluginServiceObj::serviceName(const QString &aProfileName)
+{
+    // randomly-generated profile names cannot be registered
+    // as dbus service paths due to being purely numeric.
+    int numericIdx = aProfileName.indexOf(QRegularExpression("[0123456789]"));
+
+    return numericIdx == 0
+               ? QLatin1String(DBUS_SERVICE_NAME_PREFIX) + QStringLiteral("profile-") + aProfileName
+               : QLatin1String(DBUS_SERVICE_NAME_PREFIX) + aProfileName;
+}
+
+void PluginServiceObj::setPeerConnection(const QString &aConnectionName)
+{
+    iPeerConnectionName = aConnectionName;
+}
+
+bool PluginServiceObj::attachPeer()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (iPeerConnectionName.isEmpty()) {
+        return false;
+    }
+
+    QDBusConnection peer(iPeerConnectionName);
+    if (!peer.isConnected()) {
+        qCWarning(lcButeoPlugin) << "Peer connection to msyncd lost, using the session bus";
+        return false;
+    }
+
+    if (!peer.registerObject(DBUS_SERVICE_OBJ_PATH, this)) {
+        qCWarning(lcButeoPlugin) << "Unable to register dbus object on the peer connection";
+        return false;
+    }
+
+    QDBusMessage call = QDBusMessage::createMethodCall(QString(), PEER_OBJECT_PATH, PEER_INTERFACE,
+                                                       QStringLiteral("attach"));
+    call << iProfileName;
+    const QDBusMessage reply = peer.call(call, QDBus::Block, PEER_ATTACH_TIMEOUT);
+    if (reply.type() != QDBusMessage::ReplyMessage || !reply.arguments().value(0).toBool()) {
+        qCWarning(lcButeoPlugin) << "Unable to attach to msyncd, using the session bus:" << reply.errorMessage();
+        peer.unregisterObject(DBUS_SERVICE_OBJ_PATH);
+        return false;
+    }
+
+    qCDebug(lcButeoPlugin) << "Attached to msyncd for profile" << iProfileName;
+    return true;
 }
 
 SyncPluginBase *PluginServiceObj::initializePlugin()
@@ -88,6 +159,12 @@ SyncPluginBase *PluginServiceObj::initializePlugin()
             pm.expand(*profile);
         }
 
+        if (iListenFd >= 0) {
+            // Same handover as for in-process servers, the plugin must not
+            // close the socket.
+            profile->setKey(KEY_LISTEN_FD, QString::number(iListenFd));
+        }
+
         // Create the plugin (server)
         return iSyncPluginLoader->createServerPlugin(iPluginName, *profile, iPluginCb);
 
@@ -101,6 +178,11 @@ bool PluginServiceObj::init()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
 
+    // A runner kept alive by msyncd may still hold the plugin created for
+    // a previous cleanUp() call.
+    delete iPlugin;
+    iInitialized = false;
+
     iPlugin = initializePlugin();
     if (!iPlugin) {
         qCWarning(lcButeoPlugin) << "PluginServiceObj::init(): unable to initialize plugin";
@@ -125,7 +207,8 @@ bool PluginServiceObj::init()
     connect(iPlugin, &SyncPluginBase::syncProgressDetail,
             this, &PluginServiceObj::syncProgressDetail);
 
-    return iPlugin->init();
+    iInitialized = iPlugin->init();
+    return iInitialized;
 }
 
 bool PluginServiceObj::uninit()
@@ -138,6 +221,7 @@ bool PluginServiceObj::uninit()
     }
 
     if (iPlugin->uninit()) {
+        iInitialized = false;
         delete iPlugin;
         iPlugin = nullptr;
         iPluginLoader->unload();
@@ -147,6 +231,46 @@ bool PluginServiceObj::uninit()
     return false;
 }
 
+bool PluginServiceObj::setPluginParams(const QString &aPluginName, const QString &aProfileName,
+                                       const QString &aPluginFilePath)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!iPluginName.isEmpty()) {
+        qCWarning(lcButeoPlugin) << "PluginServiceObj::setPluginParams(): already running plugin" << iPluginName;
+        return false;
+    }
+
+    iPluginName = aPluginName;
+    iProfileName = aProfileName;
+    iPluginFilePath = aPluginFilePath;
+
+    // msyncd waits for the profile specific name before using the plugin,
+    // so the peer connection must be in place before it is registered.
+    const bool attached = attachPeer();
+
+    const QString service = serviceName(aProfileName);
+    if (!QDBusConnection::sessionBus().registerService(service)) {
+        qCWarning(lcButeoPlugin) << "Unable to register dbus service" << service;
+        // Reply with the failure first, msyncd stops waiting on it.
+        QTimer::singleShot(0, this, [] {
+            QCoreApplication::exit(-1);
+        });
+        return false;
+    }
+
+    if (attached) {
+        // Stop emitting signals on the session bus once this call is replied
+        QTimer::singleShot(0, this, [] {
+            QDBusConnection::sessionBus().unregisterObject(DBUS_SERVICE_OBJ_PATH);
+        });
+    }
+
+    qCDebug(lcButeoPlugin) << "Plugin" << aPluginName << "with profile" << aProfileName
+                           << "assigned, registered at dbus" << service;
+    return true;
+}
+
 void PluginServiceObj::abortSync(uchar aStatus)
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
@@ -195,6 +319,18 @@ QString PluginServiceObj::getSyncResults()
     return iPlugin->getSyncResults().toString();
 }
 
+SyncResults PluginServiceObj::syncResults()
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!iPlugin) {
+        qCWarning(lcButeoPlugin) << "PluginServiceObj::syncResults(): called on uninitialized plugin";
+        return SyncResults(QDateTime::currentDateTime(),
+                           SyncResults::SYNC_RESULT_INVALID, SyncResults::NO_ERROR);
+    }
+    return iPlugin->getSyncResults();
+}
+
 bool PluginServiceObj::startSync()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
@@ -204,6 +340,11 @@ bool PluginServiceObj::startSync()
         return false;
     }
 
+    if (!iInitialized) {
+        qCWarning(lcButeoPlugin) << "PluginServiceObj::startSync(): plugin failed to initialize";
+        return false;
+    }
+
     if (ClientPlugin *clientPlugin = qobject_cast<ClientPlugin *>(iPlugin)) {
         return clientPlugin->startSync();
     } else {
@@ -228,6 +369,29 @@ void PluginServiceObj::resume()
     }
 }
 
+bool PluginServiceObj::setListenSocket(const QDBusUnixFileDescriptor &aSocket)
+{
+    FUNCTION_CALL_TRACE(lcButeoTrace);
+
+    if (!aSocket.isValid()) {
+        qCWarning(lcButeoPlugin) << "PluginServiceObj::setListenSocket(): invalid socket";
+        return false;
+    }
+
+    // The descriptor is closed with aSocket, so keep a duplicate
+    const int fd = ::fcntl(aSocket.fileDescriptor(), F_DUPFD_CLOEXEC, 0);
+    if (fd < 0) {
+        qCWarning(lcButeoPlugin) << "PluginServiceObj::setListenSocket(): unable to duplicate socket";
+        return false;
+    }
+
+    if (iListenFd >= 0) {
+        ::close(iListenFd);
+    }
+    iListenFd = fd;
+    return true;
+}
+
 bool PluginServiceObj::startListen()
 {
     FUNCTION_CALL_TRACE(lcButeoTrace);
@@ -29,6 +29,8 @@
 #include <SyncCommonDefs.h>
 #include <SyncPluginLoader.h>
 
+#include <QDBusUnixFileDescriptor>
+
 class QPluginLoader;
 
 using namespace Buteo;
@@ -43,19 +45,35 @@ public:
                      QObject *parent = nullptr);
     virtual ~PluginServiceObj();
 
+    // D-Bus service name used for the plugin of the given profile
+    static QString serviceName(const QString &aProfileName);
+
+    // Private connection to msyncd, used once attachPeer() succeeds
+    void setPeerConnection(const QString &aConnectionName);
+
+    // Serves this object on the peer connection and announces the profile
+    // to msyncd. Returns false if there is no usable peer connection.
+    bool attachPeer();
+
 public Q_SLOTS:
     void abortSync(uchar aStatus);
     bool cleanUp();
     void connectivityStateChanged(int aType, bool aState);
     QString getSyncResults();
+    Buteo::SyncResults syncResults();
     bool init();
     bool uninit();
+    bool setPluginParams(const QString &aPluginName, const QString &aProfileName,
+                         const QString &aPluginFilePath);
 
     // client functions
     bool startSync();
 
     // server functions
     void resume();
+    // Listening socket msyncd opened for the server, passed to the plugin
+    // in the listen_fd key of its profile by the next init()
+    bool setListenSocket(const QDBusUnixFileDescriptor &aSocket);
     bool startListen();
     void stopListen();
     void suspend();
@@ -79,6 +97,12 @@ private:
     QString iPluginName;
     QString iProfileName;
     QString iPluginFilePath;
+    QString iPeerConnectionName;
+    // Duplicate of the socket given to setListenSocket(), -1 if none
+    int iListenFd = -1;
+    // msyncd sends startSync() right behind init() without waiting for
+    // its reply, so the runner itself refuses to sync a failed plugin.
+    bool iInitialized = false;
 };
 
 #endif // PLUGINSERVICEOBJ_H
@@ -22,55 +22,115 @@
 
 #include <QCoreApplication>
 #include <QDBusConnection>
-#include <QRegularExpression>
+#include <QDBusError>
+#include <QDBusServiceWatcher>
+#include <QSocketNotifier>
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include "PluginServiceObj.h"
 #include "ButeoPluginIfaceAdaptor.h"
 #include "Logger.h"
+#include "AsyncLogWriter.h"
 
-#define DBUS_SERVICE_NAME_PREFIX "com.buteo.msyncd.plugin."
 #define DBUS_SERVICE_OBJ_PATH "/"
+#define DBUS_POOL_SERVICE_NAME_PREFIX "com.buteo.msyncd.plugin.pool-"
+#define MSYNCD_SERVICE_NAME "com.meego.msyncd"
+#define PEER_ADDRESS_ENV "BUTEO_PLUGIN_PEER_ADDRESS"
+#define PEER_CONNECTION_NAME "msyncd"
+
+static int termFd[2] = { -1, -1 };
+
+static void termSignalHandler(int)
+{
+    char a = 1;
+    if (::write(termFd[0], &a, sizeof(a)) < 0) {
+        // Nothing to do about it in a signal handler
+    }
+}
 
 int main(int argc, char **argv)
 {
     QCoreApplication app(argc, argv);
+    Buteo::AsyncLogWriter::instance()->install();
     Buteo::configureLegacyLogging();
 
+    // msyncd stops runners with SIGTERM. Write out the queued log records
+    // first, then terminate the way the default action would.
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, termFd) == 0) {
+        QSocketNotifier *termNotifier = new QSocketNotifier(termFd[1], QSocketNotifier::Read, &app);
+        QObject::connect(termNotifier, &QSocketNotifier::activated, [] {
+            Buteo::AsyncLogWriter::instance()->shutdown();
+            ::signal(SIGTERM, SIG_DFL);
+            ::raise(SIGTERM);
+        });
+        ::signal(SIGTERM, termSignalHandler);
+    } else {
+        qCWarning(lcButeoPlugin) << "Couldn't create TERM socketpair";
+    }
+
     // We obtain the plugin name and the profile name from cmdline
     // One way to pass the arguments is via cmdline, the other way is
     // to use the method setPluginParams() dbus method. But setting
     // cmdline arguments is probably cleaner
     QStringList args = app.arguments();
 
-    if (args.length() < 4) {
+    // A runner started with --pool <id> waits on the bus until msyncd
+    // assigns it a plugin with setPluginParams()
+    const bool pooled = args.value(1) == QLatin1String("--pool");
+
+    if (!pooled && args.length() < 4) {
         qCCritical(lcButeoPlugin) << "Plugin name, profile name and plugin path not obtained from cmdline";
     }
 
-    const QString pluginName = args.value(1);
-    const QString profileName = args.value(2);
-    const QString pluginFilePath = args.value(3);
+    const QString pluginName = pooled ? QString() : args.value(1);
+    const QString profileName = pooled ? QString() : args.value(2);
+    const QString pluginFilePath = pooled ? QString() : args.value(3);
 
     PluginServiceObj *serviceObj = new PluginServiceObj(pluginName, profileName, pluginFilePath);
 
     new ButeoPluginIfaceAdaptor(serviceObj);
 
-    // randomly-generated profile names cannot be registered
-    // as dbus service paths due to being purely numeric.
-    int numericIdx = profileName.indexOf(QRegularExpression("[0123456789]"));
-
-    QString servicePath = numericIdx == 0
-                              ? QLatin1String(DBUS_SERVICE_NAME_PREFIX) + QStringLiteral("profile-") + profileName
-                              : QLatin1String(DBUS_SERVICE_NAME_PREFIX) + profileName;
+    QString servicePath = pooled
+                              ? QLatin1String(DBUS_POOL_SERVICE_NAME_PREFIX) + args.value(2)
+                              : PluginServiceObj::serviceName(profileName);
 
     qCDebug(lcButeoPlugin) << "attempting to register dbus service:" << servicePath;
     QDBusConnection connection = QDBusConnection::sessionBus();
     int retn;
 
-    if (connection.registerObject(DBUS_SERVICE_OBJ_PATH, serviceObj)) {
+    if (pooled) {
+        // Idle runners are not tracked by anyone once msyncd is gone
+        QDBusServiceWatcher *msyncdWatcher = new QDBusServiceWatcher(MSYNCD_SERVICE_NAME, connection,
+                                                                     QDBusServiceWatcher::WatchForUnregistration,
+                                                                     serviceObj);
+        QObject::connect(msyncdWatcher, &QDBusServiceWatcher::serviceUnregistered, &app, &QCoreApplication::quit);
+    }
+
+    // msyncd passes the address of its private D-Bus server, calls and
+    // signals go over that connection once attached. The session bus is
+    // still used for the service name, which tells msyncd the plugin is up.
+    const QString peerAddress = QString::fromLocal8Bit(qgetenv(PEER_ADDRESS_ENV));
+    if (!peerAddress.isEmpty()) {
+        QDBusConnection peer = QDBusConnection::connectToPeer(peerAddress, PEER_CONNECTION_NAME);
+        if (peer.isConnected()) {
+            serviceObj->setPeerConnection(peer.name());
+        } else {
+            qCWarning(lcButeoPlugin) << "Unable to connect to msyncd at" << peerAddress << ":"
+                                     << peer.lastError().message();
+        }
+    }
+
+    // Pooled runners attach once they know their profile
+    const bool attached = !pooled && serviceObj->attachPeer();
+
+    if (attached || connection.registerObject(DBUS_SERVICE_OBJ_PATH, serviceObj)) {
         if (connection.registerService(servicePath)) {
             qCDebug(lcButeoPlugin) << "Plugin " << pluginName << " with profile "
                       << profileName << " registered at dbus "
-                      << DBUS_SERVICE_NAME_PREFIX + profileName
+                      << servicePath
                       << " and path " << DBUS_SERVICE_OBJ_PATH;
             // TODO: Should any unix signals be handled?
             retn = app.exec();
@@ -88,5 +148,7 @@ int main(int argc, char **argv)
     }
 
     delete serviceObj;
+    QDBusConnection::disconnectFromPeer(PEER_CONNECTION_NAME);
+    Buteo::AsyncLogWriter::instance()->shutdown();
     return retn;
 }
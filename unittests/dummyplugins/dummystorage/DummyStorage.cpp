@@ -25,9 +25,98 @@
 
 using namespace Buteo;
 
+static const QString CURSOR_TOKEN_PREFIX = "dummy:";
+
+bool DummyStorageItem::write( qint64 aOffset, const QByteArray &aData )
+{
+    if ( aOffset < 0 || aOffset > iData.size() ) {
+        return false;
+    }
+
+    iData.replace( aOffset, aData.size(), aData );
+    return true;
+}
+
+bool DummyStorageItem::read( qint64 aOffset, qint64 aLength, QByteArray &aData ) const
+{
+    if ( aOffset < 0 || aOffset > iData.size() ) {
+        return false;
+    }
+
+    aData = iData.mid( aOffset, aLength );
+    return true;
+}
+
+bool DummyStorageItem::resize( qint64 aLen )
+{
+    iData.resize( aLen );
+    return true;
+}
+
+qint64 DummyStorageItem::getSize() const
+{
+    return iData.size();
+}
+
+QByteArray DummyStorageItem::dataView( qint64 aOffset, qint64 aLength ) const
+{
+    if ( aOffset < 0 || aOffset > iData.size() ) {
+        return QByteArray();
+    }
+
+    if ( aOffset == 0 && ( aLength < 0 || aLength == iData.size() ) ) {
+        // Shares the buffer instead of copying it
+        return iData;
+    }
+
+    return iData.mid( aOffset, aLength );
+}
+
+
+DummyItemCursor::DummyItemCursor( DummyStorage *aStorage, StoragePlugin::ItemSet aSet, int aNext, int aEnd )
+    : iStorage( aStorage )
+    , iSet( aSet )
+    , iNext( aNext )
+    , iEnd( aEnd )
+{
+}
+
+bool DummyItemCursor::nextItemIds( int aBatchSize, QList<QString> &aItemIds )
+{
+    aItemIds.clear();
+    for ( int i = 0; i < aBatchSize && iNext <= iEnd; ++i ) {
+        aItemIds.append( QString::number( iNext++ ) );
+    }
+    return true;
+}
+
+bool DummyItemCursor::nextItems( int aBatchSize, QList<StorageItem *> &aItems )
+{
+    aItems.clear();
+    if ( iSet == StoragePlugin::DELETED_ITEMS ) {
+        return false;
+    }
+
+    QList<QString> itemIds;
+    nextItemIds( aBatchSize, itemIds );
+    aItems = iStorage->getItems( itemIds );
+    return true;
+}
+
+bool DummyItemCursor::atEnd() const
+{
+    return iNext > iEnd;
+}
+
+QString DummyItemCursor::resumeToken() const
+{
+    return CURSOR_TOKEN_PREFIX + QString::number( iNext );
+}
+
 
 DummyStorage::DummyStorage( const QString &aPluginName )
     : StoragePlugin( aPluginName )
+    , iItemCount( 0 )
 {
 
 }
@@ -37,8 +126,10 @@ DummyStorage::~DummyStorage()
 
 }
 
-bool DummyStorage::init( const QMap<QString, QString> & /*aProperties*/ )
+bool DummyStorage::init( const QMap<QString, QString> &aProperties )
 {
+    iProperties = aProperties;
+    iItemCount = qMax( 0, aProperties.value( "item_count" ).toInt() );
     return true;
 }
 
@@ -47,8 +138,11 @@ bool DummyStorage::uninit()
     return true;
 }
 
-bool DummyStorage::getAllItems( QList<StorageItem *> & /*aItems*/ )
+bool DummyStorage::getAllItems( QList<StorageItem *> &aItems )
 {
+    for ( int i = 1; i <= iItemCount; ++i ) {
+        aItems.append( createItem( QString::number( i ) ) );
+    }
     return true;
 }
 
@@ -67,8 +161,11 @@ bool DummyStorage::getDeletedItems( QList<StorageItem *> & /*aDeletedItems*/, co
     return true;
 }
 
-bool DummyStorage::getAllItemIds( QList<QString> & /*aItems*/ )
+bool DummyStorage::getAllItemIds( QList<QString> &aItems )
 {
+    for ( int i = 1; i <= iItemCount; ++i ) {
+        aItems.append( QString::number( i ) );
+    }
     return true;
 }
 
@@ -92,14 +189,19 @@ StorageItem *DummyStorage::newItem()
     return nullptr;
 }
 
-StorageItem *DummyStorage::getItem( const QString & /*aItemId*/ )
+StorageItem *DummyStorage::getItem( const QString &aItemId )
 {
-    return nullptr;
+    return createItem( aItemId );
 }
 
-QList<StorageItem *> DummyStorage::getItems(const QStringList & /*aItemIdList*/ )
+QList<StorageItem *> DummyStorage::getItems(const QStringList &aItemIdList )
 {
     QList<StorageItem *> items;
+    foreach ( const QString &itemId, aItemIdList ) {
+        if ( StorageItem *item = createItem( itemId ) ) {
+            items.append( item );
+        }
+    }
     return items;
 }
 
@@ -151,6 +253,38 @@ QList<StoragePlugin::OperationStatus> DummyStorage::deleteItems( const QList<QSt
     return statuses;
 }
 
+StorageItemCursor *DummyStorage::createCursor( StoragePlugin::ItemSet aSet, const QDateTime & /*aTime*/,
+                                               const QString &aResumeToken )
+{
+    int next = 1;
+    if ( !aResumeToken.isEmpty() ) {
+        bool ok = false;
+        if ( aResumeToken.startsWith( CURSOR_TOKEN_PREFIX ) ) {
+            next = aResumeToken.mid( CURSOR_TOKEN_PREFIX.length() ).toInt( &ok );
+        }
+        if ( !ok || next < 1 ) {
+            return nullptr;
+        }
+    }
+
+    // Only the full item set has items, as with the list based methods
+    int end = ( aSet == ALL_ITEMS ) ? iItemCount : 0;
+    return new DummyItemCursor( this, aSet, next, end );
+}
+
+DummyStorageItem *DummyStorage::createItem( const QString &aItemId ) const
+{
+    bool ok = false;
+    int index = aItemId.toInt( &ok );
+    if ( !ok || index < 1 || index > iItemCount ) {
+        return nullptr;
+    }
+
+    DummyStorageItem *item = new DummyStorageItem;
+    item->setId( aItemId );
+    item->write( 0, "item " + aItemId.toLatin1() );
+    return item;
+}
 
 StoragePlugin *DummyStorageLoader::createPlugin( const QString &aPluginName )
 {
@@ -26,11 +26,65 @@
 
 #include "StoragePlugin.h"
 #include "StoragePluginLoader.h"
+#include "StorageItem.h"
+#include "StorageItemCursor.h"
 
 namespace Buteo {
 
-class DummyStorage : public StoragePlugin
+class DummyStorageItem : public StorageItem, public StorageItemDataAccess
 {
+public:
+
+    virtual bool write( qint64 aOffset, const QByteArray &aData );
+
+    virtual bool read( qint64 aOffset, qint64 aLength, QByteArray &aData ) const;
+
+    virtual bool resize( qint64 aLen );
+
+    virtual qint64 getSize() const;
+
+    virtual QByteArray dataView( qint64 aOffset, qint64 aLength ) const;
+
+private:
+
+    QByteArray iData;
+};
+
+class DummyStorage;
+
+// Pages through the generated items by index
+class DummyItemCursor : public StorageItemCursor
+{
+public:
+
+    DummyItemCursor( DummyStorage *aStorage, StoragePlugin::ItemSet aSet, int aNext, int aEnd );
+
+    virtual bool nextItemIds( int aBatchSize, QList<QString> &aItemIds );
+
+    virtual bool nextItems( int aBatchSize, QList<StorageItem *> &aItems );
+
+    virtual bool atEnd() const;
+
+    virtual QString resumeToken() const;
+
+private:
+
+    DummyStorage *iStorage;
+
+    StoragePlugin::ItemSet iSet;
+
+    // Index of the next item, items are numbered from 1
+    int iNext;
+
+    // Index of the last item
+    int iEnd;
+};
+
+class DummyStorage : public StoragePlugin, public StorageCursorProvider
+{
+    Q_OBJECT
+    Q_INTERFACES(Buteo::StorageCursorProvider)
+
 public:
 
     DummyStorage( const QString &aPluginName );
@@ -75,6 +129,16 @@ public:
 
     virtual QList<OperationStatus> deleteItems( const QList<QString> &aItemIds );
 
+    virtual StorageItemCursor *createCursor( StoragePlugin::ItemSet aSet, const QDateTime &aTime,
+                                             const QString &aResumeToken );
+
+private:
+
+    DummyStorageItem *createItem( const QString &aItemId ) const;
+
+    // Number of generated items, set with the item_count property
+    int iItemCount;
+
 };
 
 
@@ -0,0 +1,100 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "AccountSyncIndexTest.h"
+#include "AccountSyncIndex.h"
+#include <SyncProfile.h>
+#include <ProfileEngineDefs.h>
+
+using namespace Buteo;
+
+void AccountSyncIndexTest::testIndex()
+{
+    SyncProfile contacts("contacts");
+    SyncProfile calendar("calendar");
+    SyncProfile local("local");
+    contacts.setKey(KEY_ACCOUNT_ID, "1");
+    calendar.setKey(KEY_ACCOUNT_ID, "1");
+
+    AccountSyncIndex index;
+    index.updateProfile(contacts);
+    index.updateProfile(calendar);
+    index.updateProfile(local);
+    QCOMPARE(index.accountId("contacts"), QString("1"));
+    QCOMPARE(index.accountId("local"), QString());
+    QCOMPARE(index.profiles(1), QStringList() << "contacts" << "calendar");
+    QVERIFY(index.syncingAccounts().isEmpty());
+
+    // Account is syncing while any of its profiles is queued or running.
+    int failedReason = 0;
+    qlonglong prevSyncTime = 0;
+    qlonglong nextSyncTime = 0;
+    index.setSyncState("contacts", AccountSyncIndex::STATE_QUEUED);
+    index.setSyncState("calendar", AccountSyncIndex::STATE_RUNNING);
+    QCOMPARE(index.syncingAccounts(), QList<unsigned int>() << 1);
+    QCOMPARE(index.status(1, failedReason, prevSyncTime, nextSyncTime), 0);
+    index.setSyncState("contacts", AccountSyncIndex::STATE_RUNNING);
+    index.setSyncState("calendar", AccountSyncIndex::STATE_IDLE);
+    QCOMPARE(index.status(1, failedReason, prevSyncTime, nextSyncTime), 0);
+    index.setSyncState("contacts", AccountSyncIndex::STATE_IDLE);
+    QCOMPARE(index.status(1, failedReason, prevSyncTime, nextSyncTime), 1);
+    QVERIFY(index.syncingAccounts().isEmpty());
+
+    // Moving a running profile to another account moves its state too.
+    index.setSyncState("calendar", AccountSyncIndex::STATE_RUNNING);
+    calendar.setKey(KEY_ACCOUNT_ID, "2");
+    index.updateProfile(calendar);
+    QCOMPARE(index.profiles(1), QStringList() << "contacts");
+    QCOMPARE(index.syncingAccounts(), QList<unsigned int>() << 2);
+
+    index.removeProfile("calendar");
+    QVERIFY(index.profiles(2).isEmpty());
+    QVERIFY(index.syncingAccounts().isEmpty());
+}
+
+void AccountSyncIndexTest::testRebuild()
+{
+    SyncProfile contacts("contacts");
+    SyncProfile calendar("calendar");
+    contacts.setKey(KEY_ACCOUNT_ID, "1");
+    calendar.setKey(KEY_ACCOUNT_ID, "1");
+
+    AccountSyncIndex index;
+    index.updateProfile(contacts);
+    index.updateProfile(calendar);
+    index.setSyncState("contacts", AccountSyncIndex::STATE_RUNNING);
+    index.setSyncState("calendar", AccountSyncIndex::STATE_QUEUED);
+
+    // Calendar was removed and contacts moved to another account on disk.
+    SyncProfile *moved = new SyncProfile("contacts");
+    moved->setKey(KEY_ACCOUNT_ID, "2");
+    QList<SyncProfile *> profiles;
+    profiles << moved;
+    index.rebuild(profiles);
+    qDeleteAll(profiles);
+
+    QVERIFY(index.profiles(1).isEmpty());
+    QCOMPARE(index.profiles(2), QStringList() << "contacts");
+    QCOMPARE(index.syncingAccounts(), QList<unsigned int>() << 2);
+    index.setSyncState("contacts", AccountSyncIndex::STATE_IDLE);
+    QVERIFY(index.syncingAccounts().isEmpty());
+}
+
+QTEST_MAIN(Buteo::AccountSyncIndexTest)
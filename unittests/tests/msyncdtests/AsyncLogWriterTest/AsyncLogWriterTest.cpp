@@ -0,0 +1,56 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "AsyncLogWriterTest.h"
+#include "AsyncLogWriter.h"
+
+using namespace Buteo;
+
+static QStringList writtenMessages;
+static QList<QThread *> writingThreads;
+
+static void recordingHandler(QtMsgType, const QMessageLogContext &, const QString &aMessage)
+{
+    writtenMessages.append(aMessage);
+    writingThreads.append(QThread::currentThread());
+}
+
+void AsyncLogWriterTest::testWriter()
+{
+    QtMessageHandler originalHandler = qInstallMessageHandler(recordingHandler);
+
+    AsyncLogWriter *writer = AsyncLogWriter::instance();
+    writer->install();
+    qWarning("first");
+    qWarning("second");
+    writer->shutdown();
+    // After shutdown records are written synchronously.
+    qWarning("third");
+
+    qInstallMessageHandler(originalHandler);
+
+    QCOMPARE(writtenMessages, QStringList() << "first" << "second" << "third");
+    QCOMPARE(writingThreads.at(0), static_cast<QThread *>(writer));
+    QCOMPARE(writingThreads.at(1), static_cast<QThread *>(writer));
+    QCOMPARE(writingThreads.at(2), QThread::currentThread());
+    QCOMPARE(writer->droppedCount(), quint64(0));
+}
+
+QTEST_MAIN(Buteo::AsyncLogWriterTest)
@@ -21,6 +21,7 @@
  *
  */
 #include "ClientThreadTest.h"
+#include "PluginThreadPool.h"
 #include "SyncResults.h"
 
 using namespace Buteo;
@@ -150,4 +151,31 @@ void ClientThreadTest::testInitError()
     QCOMPARE(spy.count(), 1);
 }
 
+void ClientThreadTest::testWaitTimeout()
+{
+    PluginThreadPool *pool = PluginThreadPool::instance();
+    const int waitTimeout = pool->waitTimeout();
+    pool->setMaxThreads(1);
+    pool->setWaitTimeout(100);
+
+    // The previous session releases its thread from the worker thread
+    QThread *busy = nullptr;
+    QTRY_VERIFY((busy = pool->acquire()) != nullptr);
+
+    iPluginDerived->iTestClSignal = false;
+    ClientThread clientThread;
+    QSignalSpy errorSpy(&clientThread, SIGNAL(initError(const QString &,
+                                                        const QString &,
+                                                        SyncResults::MinorCode)));
+    QSignalSpy finishedSpy(&clientThread, SIGNAL(finished()));
+    QCOMPARE(clientThread.startThread(iPlugin), true);
+
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(errorSpy.count(), 1);
+    QCOMPARE(clientThread.iRunning, false);
+
+    pool->release(busy);
+    pool->setWaitTimeout(waitTimeout);
+}
+
 QTEST_MAIN(Buteo::ClientThreadTest)
@@ -65,6 +65,7 @@ private slots:
     void testClientThread();
     void testGetSyncResults();
     void testInitError();
+    void testWaitTimeout();
 
 private:
     ClientThread *iClientThread;
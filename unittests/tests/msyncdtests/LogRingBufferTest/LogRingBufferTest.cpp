@@ -0,0 +1,83 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "LogRingBufferTest.h"
+#include "LogRingBuffer.h"
+
+#include <QTemporaryDir>
+
+using namespace Buteo;
+
+void LogRingBufferTest::testDump()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.path() + "/recent.log";
+
+    LogRingBuffer *buffer = LogRingBuffer::instance();
+    // No dump prefix without install().
+    QVERIFY(buffer->dump().isEmpty());
+
+    // Overfill the buffer, only the most recent records are kept.
+    for (int i = 0; i < 2000; ++i) {
+        buffer->append(QtDebugMsg, "buteo.msyncd", QString("record %1").arg(i));
+    }
+    buffer->append(QtWarningMsg, "buteo.core", QString(1000, QLatin1Char('x')));
+    QVERIFY(buffer->dump(path));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    QStringList lines = QString::fromUtf8(file.readAll()).split('\n', QString::SkipEmptyParts);
+    QCOMPARE(lines.count(), 1024);
+    QVERIFY(lines.first().endsWith(" D buteo.msyncd: record 977"));
+    QVERIFY(lines.at(lines.count() - 2).endsWith(" D buteo.msyncd: record 1999"));
+    // Long records are truncated.
+    QVERIFY(lines.last().contains(" W buteo.core: xxx"));
+    QVERIFY(lines.last().length() < 1000);
+}
+
+void LogRingBufferTest::testDumpFiles()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    LogRingBuffer *buffer = LogRingBuffer::instance();
+    buffer->install(dir.path() + "/recent");
+    buffer->append(QtWarningMsg, "buteo.msyncd", QString("record"));
+
+    QString first;
+    for (int i = 0; i < 7; ++i) {
+        const QString path = buffer->dump();
+        QVERIFY(!path.isEmpty());
+        QVERIFY(QFile::exists(path));
+        if (first.isEmpty()) {
+            first = path;
+        }
+        // Dump files are named by milliseconds.
+        QThread::msleep(2);
+    }
+
+    // Every dump gets its own file and only the most recent ones are kept.
+    QStringList dumps = QDir(dir.path()).entryList(QStringList() << "recent-*.log", QDir::Files);
+    QCOMPARE(dumps.count(), 5);
+    QVERIFY(!QFile::exists(first));
+}
+
+QTEST_MAIN(Buteo::LogRingBufferTest)
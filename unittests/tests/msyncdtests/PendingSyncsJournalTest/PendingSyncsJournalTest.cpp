@@ -0,0 +1,103 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "PendingSyncsJournalTest.h"
+#include "PendingSyncsJournal.h"
+
+#include <QSettings>
+#include <QTemporaryDir>
+
+using namespace Buteo;
+
+void PendingSyncsJournalTest::testRoundTrip()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.path() + "/pendingsyncs.ini";
+
+    PendingSyncsJournal written;
+    written.iQueue << PendingSyncsJournal::QueuedSync("manual", false, 1000)
+                   << PendingSyncsJournal::QueuedSync("scheduled", true, 2000);
+    written.iWaitingOnline << "offline1" << "offline2";
+    written.iProfileChanges << qMakePair(QString("added"), ProfileManager::PROFILE_ADDED)
+                            << qMakePair(QString("modified"), ProfileManager::PROFILE_MODIFIED);
+    QVERIFY(written.save(path));
+
+    PendingSyncsJournal read;
+    read.load(path);
+    QCOMPARE(read.iQueue.size(), 2);
+    QCOMPARE(read.iQueue.at(0).iProfileName, QString("manual"));
+    QCOMPARE(read.iQueue.at(0).iScheduled, false);
+    QCOMPARE(read.iQueue.at(0).iEnqueueTime, qint64(1000));
+    QCOMPARE(read.iQueue.at(1).iProfileName, QString("scheduled"));
+    QCOMPARE(read.iQueue.at(1).iScheduled, true);
+    QCOMPARE(read.iQueue.at(1).iEnqueueTime, qint64(2000));
+    QCOMPARE(read.iWaitingOnline, written.iWaitingOnline);
+    QCOMPARE(read.iProfileChanges, written.iProfileChanges);
+
+    // Saving an empty state clears the journal
+    QVERIFY(PendingSyncsJournal().save(path));
+    read.load(path);
+    QVERIFY(read.iQueue.isEmpty());
+    QVERIFY(read.iWaitingOnline.isEmpty());
+    QVERIFY(read.iProfileChanges.isEmpty());
+}
+
+void PendingSyncsJournalTest::testMalformedEntries()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.path() + "/pendingsyncs.ini";
+
+    {
+        QSettings journal(path, QSettings::IniFormat);
+        journal.beginWriteArray("queue", 2);
+        journal.setArrayIndex(0);
+        journal.setValue("profile", QString());
+        journal.setArrayIndex(1);
+        journal.setValue("profile", "valid");
+        journal.setValue("enqueued", "garbage");
+        journal.endArray();
+        journal.beginWriteArray("profilechanges", 4);
+        journal.setArrayIndex(0);
+        journal.setValue("profile", "removed");
+        journal.setValue("change", int(ProfileManager::PROFILE_REMOVED));
+        journal.setArrayIndex(1);
+        journal.setValue("profile", "outofrange");
+        journal.setValue("change", 42);
+        journal.setArrayIndex(2);
+        journal.setValue("profile", "notanumber");
+        journal.setValue("change", "added");
+        journal.setArrayIndex(3);
+        journal.setValue("profile", "modified");
+        journal.setValue("change", int(ProfileManager::PROFILE_MODIFIED));
+        journal.endArray();
+    }
+
+    PendingSyncsJournal read;
+    read.load(path);
+    QCOMPARE(read.iQueue.size(), 1);
+    QCOMPARE(read.iQueue.at(0).iProfileName, QString("valid"));
+    QCOMPARE(read.iQueue.at(0).iEnqueueTime, qint64(0));
+    QCOMPARE(read.iProfileChanges.size(), 1);
+    QCOMPARE(read.iProfileChanges.at(0).first, QString("modified"));
+}
+
+QTEST_GUILESS_MAIN(Buteo::PendingSyncsJournalTest)
@@ -44,6 +44,22 @@ void PluginRunnerTest::testPluginRunnerConstructor()
     QCOMPARE(iPRunner->pluginType(), PluginRunner::PLUGIN_CLIENT);
     QCOMPARE(iPRunner->pluginName(), PLUGIN);
 }
+void PluginRunnerTest::testCleanUpWhileStarting()
+{
+    QSignalSpy cleanUpSpy(iPRunner, SIGNAL(cleanUpDone(bool)));
+
+    // Cleanup waits for the plug-in process instead of blocking.
+    iPRunner->iPluginStarting = true;
+    iPRunner->startCleanUp();
+    QCOMPARE(cleanUpSpy.count(), 0);
+    QVERIFY(iPRunner->iCleanUpPending);
+
+    iPRunner->onPluginStarted(iPRunner->plugin(), false);
+    QCOMPARE(cleanUpSpy.count(), 1);
+    QCOMPARE(cleanUpSpy.at(0).at(0).toBool(), false);
+    QVERIFY(!iPRunner->iCleanUpPending);
+    QVERIFY(iPRunner->isReady());
+}
 void PluginRunnerTest::cleanupTestCase()
 {
     QVERIFY(iPManager != 0);
@@ -40,6 +40,7 @@ class PluginRunnerTest : public QObject
 private slots:
     void initTestCase();
     void testPluginRunnerConstructor();
+    void testCleanUpWhileStarting();
     void cleanupTestCase();
 
 private:
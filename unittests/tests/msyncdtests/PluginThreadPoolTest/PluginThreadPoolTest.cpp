@@ -0,0 +1,106 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "PluginThreadPoolTest.h"
+#include "PluginThreadPool.h"
+
+#include <QThread>
+
+using namespace Buteo;
+
+void PluginThreadPoolTest::threadAvailable()
+{
+    ++iNotifications;
+}
+
+void PluginThreadPoolTest::cleanup()
+{
+    PluginThreadPool::instance()->shutdown();
+    iNotifications = 0;
+}
+
+void PluginThreadPoolTest::testReuse()
+{
+    PluginThreadPool *pool = PluginThreadPool::instance();
+    pool->setMaxThreads(2);
+
+    QThread *thread = pool->acquire();
+    QVERIFY(thread);
+    QVERIFY(thread->isRunning());
+    QVERIFY(thread != QThread::currentThread());
+    pool->release(thread);
+    QCOMPARE(pool->threadCount(), 1);
+
+    // The idle thread is handed out again instead of a new one
+    QCOMPARE(pool->acquire(), thread);
+    QCOMPARE(pool->threadCount(), 1);
+    pool->release(thread);
+}
+
+void PluginThreadPoolTest::testLimit()
+{
+    PluginThreadPool *pool = PluginThreadPool::instance();
+    pool->setMaxThreads(2);
+
+    QThread *first = pool->acquire();
+    QThread *second = pool->acquire();
+    QVERIFY(first);
+    QVERIFY(second);
+    QVERIFY(first != second);
+
+    QVERIFY(!pool->acquire(this, "threadAvailable"));
+    QCOMPARE(pool->threadCount(), 2);
+
+    pool->release(first);
+    QTRY_COMPARE(iNotifications, 1);
+    QCOMPARE(pool->acquire(), first);
+
+    // Lowering the limit stops threads once they are released
+    pool->setMaxThreads(1);
+    pool->release(first);
+    pool->release(second);
+    QCOMPARE(pool->threadCount(), 1);
+}
+
+void PluginThreadPoolTest::testUnbounded()
+{
+    PluginThreadPool *pool = PluginThreadPool::instance();
+    pool->setMaxThreads(1);
+
+    // Listening servers do not take the threads of client sessions
+    QThread *server = pool->acquireUnbounded();
+    QThread *otherServer = pool->acquireUnbounded();
+    QVERIFY(server);
+    QVERIFY(otherServer);
+    QVERIFY(server != otherServer);
+    QThread *client = pool->acquire();
+    QVERIFY(client);
+    QCOMPARE(pool->threadCount(), 3);
+    QVERIFY(!pool->acquire());
+
+    // Released threads are kept up to the limit
+    pool->release(server);
+    pool->release(otherServer);
+    pool->release(client);
+    QCOMPARE(pool->threadCount(), 1);
+}
+
+QTEST_GUILESS_MAIN(Buteo::PluginThreadPoolTest)
@@ -0,0 +1 @@
+include(../msyncdtestapplication.pri)
@@ -0,0 +1,94 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "ServerListenerTest.h"
+#include "ServerListener.h"
+#include "RfcommServiceRecord.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Buteo;
+
+void ServerListenerTest::testUnsupportedEndpoint()
+{
+    ServerListener unknown("server", "tcp:1234");
+    QVERIFY(!unknown.listen());
+    QVERIFY(!unknown.isListening());
+
+    ServerListener badChannel("server", "rfcomm:99");
+    QVERIFY(!badChannel.listen());
+
+    ServerListener missingDevice("server", "usb:/nonexistent/ttyGS0");
+    QVERIFY(!missingDevice.listen());
+}
+
+void ServerListenerTest::testDeviceActivation()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QByteArray path = QFile::encodeName(dir.path() + "/ttyGS0");
+    QCOMPARE(mkfifo(path.constData(), 0600), 0);
+
+    ServerListener listener("server", "usb:" + QString::fromLocal8Bit(path));
+    listener.setIdleTimeout(50);
+    QSignalSpy activatedSpy(&listener, SIGNAL(activated(QString)));
+    QSignalSpy idleSpy(&listener, SIGNAL(idle(QString)));
+
+    QVERIFY(listener.listen());
+    QVERIFY(listener.isListening());
+    // Device nodes are opened by the plug-in itself
+    QCOMPARE(listener.socketDescriptor(), -1);
+
+    const int writer = open(path.constData(), O_WRONLY | O_NONBLOCK);
+    QVERIFY(writer >= 0);
+    QCOMPARE(write(writer, "x", 1), ssize_t(1));
+
+    QTRY_COMPARE(activatedSpy.count(), 1);
+    QCOMPARE(activatedSpy.first().first().toString(), QString("server"));
+    QVERIFY(!listener.isListening());
+
+    // No session followed the connection
+    QTRY_COMPARE(idleSpy.count(), 1);
+
+    // The data was left unread, so listening again activates right away
+    QVERIFY(listener.listen());
+    QTRY_COMPARE(activatedSpy.count(), 2);
+
+    listener.close();
+    QVERIFY(!listener.isListening());
+    close(writer);
+}
+
+void ServerListenerTest::testServiceRecord()
+{
+    const QString record = RfcommServiceRecord::serviceRecordXml("sync<ml>", 11,
+                                                                 RfcommServiceRecord::DEFAULT_SERVICE_UUID);
+    QVERIFY(record.contains("<uuid value=\"00000002-0000-1000-8000-0002ee000002\"/>"));
+    // RFCOMM protocol descriptor with the channel
+    QVERIFY(record.contains("<sequence><uuid value=\"0x0003\"/><uint8 value=\"0x0b\"/></sequence>"));
+    QVERIFY(record.contains("<text value=\"sync&lt;ml&gt;\"/>"));
+}
+
+QTEST_GUILESS_MAIN(Buteo::ServerListenerTest)
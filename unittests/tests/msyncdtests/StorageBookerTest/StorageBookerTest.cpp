@@ -91,4 +91,33 @@ void StorageBookerTest::testBooking()
 
 }
 
+void StorageBookerTest::testSharedBooking()
+{
+    const QString STORAGE1 = "Storage1";
+    const QString CLIENT1 = "Client1";
+    const QString CLIENT2 = "Client2";
+    const QString CLIENT3 = "Client3";
+
+    StorageBooker booker;
+
+    // Several readers can hold the storage at the same time.
+    QCOMPARE(booker.reserveStorage(STORAGE1, CLIENT1, StorageBooker::ACCESS_SHARED), true);
+    QCOMPARE(booker.reserveStorage(STORAGE1, CLIENT2, StorageBooker::ACCESS_SHARED), true);
+    QCOMPARE(booker.isStorageAvailable(STORAGE1, CLIENT3, StorageBooker::ACCESS_SHARED), true);
+
+    // Writer has to wait for the readers, new readers wait for the writer.
+    QCOMPARE(booker.reserveStorage(STORAGE1, CLIENT3), false);
+    QCOMPARE(booker.reserveStorage(STORAGE1, CLIENT1, StorageBooker::ACCESS_SHARED), false);
+    QCOMPARE(booker.releaseStorage(STORAGE1), (unsigned)1);
+    QCOMPARE(booker.releaseStorage(STORAGE1), (unsigned)0);
+
+    // Writer gets the storage once readers are gone and excludes readers.
+    QCOMPARE(booker.reserveStorage(STORAGE1, CLIENT3), true);
+    QCOMPARE(booker.reserveStorage(STORAGE1, CLIENT1, StorageBooker::ACCESS_SHARED), false);
+    QCOMPARE(booker.reserveStorage(STORAGE1, CLIENT3, StorageBooker::ACCESS_SHARED), true);
+    QCOMPARE(booker.releaseStorage(STORAGE1), (unsigned)1);
+    QCOMPARE(booker.releaseStorage(STORAGE1), (unsigned)0);
+    QCOMPARE(booker.isStorageAvailable(STORAGE1, CLIENT1, StorageBooker::ACCESS_SHARED), true);
+}
+
 QTEST_MAIN(Buteo::StorageBookerTest)
@@ -34,6 +34,7 @@ class StorageBookerTest: public QObject
 private slots:
 
     void testBooking();
+    void testSharedBooking();
 };
 
 }
@@ -24,6 +24,8 @@
 #include "SyncQueue.h"
 #include "SyncSession.h"
 #include <SyncProfile.h>
+#include <ProfileEngineDefs.h>
+#include <Metrics.h>
 
 using namespace Buteo;
 
@@ -62,4 +64,102 @@ void SyncQueueTest::testQueue()
 
 }
 
+void SyncQueueTest::testFairShare()
+{
+    SyncProfile *a1 = new SyncProfile("A1");
+    SyncProfile *a2 = new SyncProfile("A2");
+    SyncProfile *a3 = new SyncProfile("A3");
+    SyncProfile *b1 = new SyncProfile("B1");
+    a1->setKey(KEY_ACCOUNT_ID, "1");
+    a2->setKey(KEY_ACCOUNT_ID, "1");
+    a3->setKey(KEY_ACCOUNT_ID, "1");
+    b1->setKey(KEY_ACCOUNT_ID, "2");
+    SyncSession sa1(a1);
+    SyncSession sa2(a2);
+    SyncSession sa3(a3);
+    SyncSession sb1(b1);
+    SyncQueue q;
+    q.setMaxRunningPerAccount(1);
+    MetricsHistogram *waits = Metrics::instance()->histogram(QStringLiteral("msyncd_queue_wait_ms"));
+    const qint64 dispatched = waits->count();
+
+    // Account 2 is served right after the first session of account 1.
+    q.enqueue(&sa1);
+    q.enqueue(&sa2);
+    q.enqueue(&sa3);
+    q.enqueue(&sb1);
+    QCOMPARE(q.dequeue(), &sa1);
+    QCOMPARE(q.canStart(&sa2), true);
+    q.sessionStarted(&sa1);
+    QCOMPARE(q.canStart(&sa2), false);
+    QCOMPARE(q.head(), &sb1);
+    QCOMPARE(q.dequeue(), &sb1);
+    q.sessionStarted(&sb1);
+
+    // Account 1 is at its limit until its running session finishes.
+    QVERIFY(q.head() == nullptr);
+    QCOMPARE(q.size(), 2);
+    q.sessionFinished(&sa1);
+    QCOMPARE(q.dequeue(), &sa2);
+
+    QCOMPARE(waits->count(), dispatched + 3);
+}
+
+void SyncQueueTest::testNoAccount()
+{
+    SyncProfile *n1 = new SyncProfile("N1");
+    SyncProfile *n2 = new SyncProfile("N2");
+    SyncProfile *n3 = new SyncProfile("N3");
+    SyncSession sn1(n1);
+    SyncSession sn2(n2);
+    SyncSession sn3(n3);
+    SyncQueue q;
+    q.setMaxRunningPerAccount(1);
+
+    // Profiles without an account are not limited by each other.
+    q.enqueue(&sn1);
+    q.enqueue(&sn2);
+    q.enqueue(&sn3);
+    QCOMPARE(q.dequeue(), &sn1);
+    q.sessionStarted(&sn1);
+    QCOMPARE(q.canStart(&sn2), true);
+    QCOMPARE(q.dequeue(), &sn2);
+    q.sessionStarted(&sn2);
+    QCOMPARE(q.dequeue(), &sn3);
+    QVERIFY(q.isEmpty());
+}
+
+void SyncQueueTest::testPriorityAcrossAccounts()
+{
+    SyncProfile *a1 = new SyncProfile("A1");
+    SyncProfile *a2 = new SyncProfile("A2");
+    SyncProfile *b1 = new SyncProfile("B1");
+    a1->setKey(KEY_ACCOUNT_ID, "1");
+    a2->setKey(KEY_ACCOUNT_ID, "1");
+    b1->setKey(KEY_ACCOUNT_ID, "2");
+    SyncSession sa1(a1);
+    SyncSession sa2(a2);
+    SyncSession sb1(b1);
+    sa1.setScheduled(true);
+    sb1.setScheduled(true);
+    SyncQueue q;
+
+    q.enqueue(&sa1);
+    q.enqueue(&sb1);
+    QCOMPARE(q.dequeue(), &sa1);
+
+    // The manual sync of account 1 outranks the scheduled sync of
+    // account 2, even though account 2 is next in the rotation.
+    q.enqueue(&sa2);
+    QCOMPARE(q.dequeue(), &sa2);
+    QCOMPARE(q.dequeue(), &sb1);
+    QVERIFY(q.isEmpty());
+
+    // Drained accounts leave the rotation and rejoin at its back.
+    q.enqueue(&sb1);
+    q.enqueue(&sa1);
+    QCOMPARE(q.dequeue(), &sb1);
+    QCOMPARE(q.dequeue(), &sa1);
+}
+
 QTEST_MAIN(Buteo::SyncQueueTest)
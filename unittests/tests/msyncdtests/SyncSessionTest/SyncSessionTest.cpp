@@ -29,6 +29,8 @@
 #include <SyncCommonDefs.h>
 
 #include "SyncSession.h"
+#include "ClientPluginRunner.h"
+#include "ClientThread.h"
 #include "PluginManager.h"
 #include "PluginCbInterface.h"
 #include "SyncResults.h"
@@ -324,6 +326,71 @@ void SyncSessionTest::testOnDone()
     QCOMPARE(sampleSpy.count(), 3);
 }
 
+void SyncSessionTest::testProgressWatchdog()
+{
+    qRegisterMetaType<Sync::SyncStatus>("Sync::SyncStatus");
+
+    QSignalSpy sampleSpy(iSyncSession, SIGNAL(finished(QString, Sync::SyncStatus, QString, SyncResults::MinorCode)));
+
+    iSyncSession->setPluginRunner(iSyncSessionPluginRunnerTest, true);
+    iSyncSession->setProgressTimeout(100);
+    isValuePassedTrue = true;
+    SyncSessionPluginRunnerTest::testValue = 0;
+    QVERIFY(iSyncSession->start());
+    QVERIFY(iSyncSession->iWatchdog.isActive());
+
+    // Progress restarts the escalation
+    QTRY_COMPARE(iSyncSession->iStallLevel, 1);
+    iSyncSession->onSyncProgressDetail("sampleProfile", Sync::SYNC_PROGRESS_SENDING_ITEMS);
+    QCOMPARE(iSyncSession->iStallLevel, 0);
+    QVERIFY(!iSyncSession->iStalled);
+
+    // No progress: abort, then give up on the plug-in which cannot be killed
+    QTRY_VERIFY(iSyncSession->iStalled);
+    QCOMPARE(SyncSessionPluginRunnerTest::testValue, 2);
+    QVERIFY(iSyncSession->iAborted);
+    QCOMPARE(sampleSpy.count(), 0);
+
+    QTRY_COMPARE(sampleSpy.count(), 1);
+    QCOMPARE(iSyncSession->iErrorCode, SyncResults::PLUGIN_STALLED);
+    QCOMPARE(iSyncSession->results().minorCode(), SyncResults::PLUGIN_STALLED);
+    QVERIFY(!iSyncSession->iWatchdog.isActive());
+}
+
+void SyncSessionTest::testStalledPlugin()
+{
+    qRegisterMetaType<Sync::SyncStatus>("Sync::SyncStatus");
+
+    PluginManager pluginManager;
+    StalledClientPlugin *plugin = new StalledClientPlugin(*iSyncProfile);
+    ClientPluginRunner *runner = new ClientPluginRunner(plugin->getPluginName(), iSyncProfile,
+                                                        &pluginManager, nullptr);
+    // The plug-in is not in a library, so init() cannot create it
+    runner->iPlugin = plugin;
+    runner->iThread = new ClientThread();
+    runner->iInitialized = true;
+    QPointer<ClientThread> thread(runner->iThread);
+
+    QSignalSpy finishedSpy(iSyncSession, SIGNAL(finished(QString, Sync::SyncStatus, QString, SyncResults::MinorCode)));
+    iSyncSession->setPluginRunner(runner, true);
+    iSyncSession->setProgressTimeout(50);
+    QVERIFY(iSyncSession->start());
+
+    // The plug-in cannot be killed, so the session gives up on it
+    QTRY_COMPARE(finishedSpy.count(), 1);
+    QCOMPARE(iSyncSession->iErrorCode, SyncResults::PLUGIN_STALLED);
+
+    // Deleting the session and its runner does not wait for the plug-in
+    delete iSyncSession;
+    iSyncSession = nullptr;
+    QVERIFY(thread);
+
+    // Once the plug-in returns, its thread object is deleted
+    plugin->iRelease.release();
+    QTRY_VERIFY(thread.isNull());
+    delete plugin;
+}
+
 
 // ############################################
 /*
@@ -396,4 +463,34 @@ bool SyncSessionPluginRunnerTest::cleanUp()
     return true;
 }
 
+StalledClientPlugin::StalledClientPlugin(const SyncProfile &aProfile)
+    : ClientPlugin("stalledPlugin", aProfile, nullptr)
+{
+}
+
+bool StalledClientPlugin::init()
+{
+    return true;
+}
+
+bool StalledClientPlugin::uninit()
+{
+    return true;
+}
+
+bool StalledClientPlugin::startSync()
+{
+    iRelease.acquire();
+    return true;
+}
+
+bool StalledClientPlugin::cleanUp()
+{
+    return true;
+}
+
+void StalledClientPlugin::connectivityStateChanged(Sync::ConnectivityType, bool)
+{
+}
+
 QTEST_MAIN(Buteo::SyncSessionTest)
@@ -26,11 +26,13 @@
 #define SYNCSESSIONTEST_H
 
 #include <QPointer>
+#include <QSemaphore>
 
 #include "SyncResults.h"
 #include "StorageBooker.h"
 #include "SyncProfile.h"
 #include "PluginRunner.h"
+#include "ClientPlugin.h"
 
 namespace Buteo {
 
@@ -56,6 +58,8 @@ private slots:
     void testOnError();
     void testOnTransferProgress();
     void testOnDone();
+    void testProgressWatchdog();
+    void testStalledPlugin();
 
 private:
 
@@ -93,6 +97,23 @@ public:
     static int testValue; // to cross-check the value while calling stop() / abort()
 };
 
+// Does not return from startSync() until released
+class StalledClientPlugin : public ClientPlugin
+{
+    Q_OBJECT
+public:
+    explicit StalledClientPlugin(const SyncProfile &aProfile);
+    bool init();
+    bool uninit();
+    bool startSync();
+    bool cleanUp();
+
+    QSemaphore iRelease;
+
+public slots:
+    void connectivityStateChanged(Sync::ConnectivityType aType, bool aState);
+};
+
 }
 
 #endif // SYNCSESSIONTEST_H
@@ -0,0 +1,79 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "TraceRecorderTest.h"
+#include "TraceRecorder.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+using namespace Buteo;
+
+void TraceRecorderTest::testDisabled()
+{
+    TraceRecorder *recorder = TraceRecorder::instance();
+    QVERIFY(!TraceRecorder::isEnabled());
+    {
+        TraceScope scope("ignored", "test");
+    }
+    recorder->instant("ignored", "test");
+    QVERIFY(!recorder->stop());
+}
+
+void TraceRecorderTest::testTrace()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.path() + "/trace.json";
+
+    TraceRecorder *recorder = TraceRecorder::instance();
+    QVERIFY(recorder->start(path));
+    QVERIFY(TraceRecorder::isEnabled());
+    QVERIFY(!recorder->start(path));
+
+    recorder->asyncBegin("session", "test", "profile");
+    {
+        TraceScope scope("scope", "test", "profile");
+    }
+    recorder->instant("instant", "test");
+    recorder->asyncEnd("session", "test", "profile");
+    QVERIFY(recorder->stop());
+    QVERIFY(!TraceRecorder::isEnabled());
+    QVERIFY(recorder->waitForWritten(5000));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonArray events = QJsonDocument::fromJson(file.readAll()).object().value("traceEvents").toArray();
+    QCOMPARE(events.count(), 4);
+
+    QJsonObject scope = events.at(1).toObject();
+    QCOMPARE(scope.value("name").toString(), QString("scope"));
+    QCOMPARE(scope.value("ph").toString(), QString("X"));
+    QVERIFY(scope.contains("dur"));
+    QCOMPARE(scope.value("args").toObject().value("profile").toString(), QString("profile"));
+
+    QCOMPARE(events.at(0).toObject().value("ph").toString(), QString("b"));
+    QCOMPARE(events.at(2).toObject().value("ph").toString(), QString("i"));
+    QCOMPARE(events.at(3).toObject().value("ph").toString(), QString("e"));
+}
+
+QTEST_MAIN(Buteo::TraceRecorderTest)
@@ -1,10 +1,16 @@
 TEMPLATE = subdirs
 SUBDIRS = \
+        AccountSyncIndexTest \
         AccountsHelperTest \
+        AsyncLogWriterTest \
         ClientPluginRunnerTest \
         ClientThreadTest \
+        LogRingBufferTest \
+        PendingSyncsJournalTest \
         PluginRunnerTest \
+        PluginThreadPoolTest \
         ServerActivatorTest \
+        ServerListenerTest \
         ServerPluginRunnerTest \
         ServerThreadTest \
         StorageBookerTest \
@@ -13,6 +19,7 @@ SUBDIRS = \
         SyncSessionTest \
         SyncSigHandlerTest \
         SynchronizerTest \
+        TraceRecorderTest \
         TransportTrackerTest \
 
 !contains(DEFINES, USE_KEEPALIVE):contains(DEFINES, USE_IPHB) {
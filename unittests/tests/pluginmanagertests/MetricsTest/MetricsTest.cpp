@@ -0,0 +1,68 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "MetricsTest.h"
+#include "Metrics.h"
+
+using namespace Buteo;
+
+void MetricsTest::testCounterAndGauge()
+{
+    Metrics *metrics = Metrics::instance();
+    MetricsCounter *counter = metrics->counter("test_events_total");
+    QCOMPARE(metrics->counter("test_events_total"), counter);
+    counter->add();
+    counter->add(2);
+    QCOMPARE(counter->value(), qint64(3));
+
+    MetricsGauge *gauge = metrics->gauge("test_queue_length");
+    gauge->set(5);
+    gauge->add(-2);
+    QCOMPARE(gauge->value(), qint64(3));
+
+    QString text = metrics->toText();
+    QVERIFY(text.contains("# TYPE test_events_total counter\ntest_events_total 3\n"));
+    QVERIFY(text.contains("# TYPE test_queue_length gauge\ntest_queue_length 3\n"));
+}
+
+void MetricsTest::testHistogram()
+{
+    MetricsHistogram *histogram = Metrics::instance()->histogram("test_latency_ms");
+    const QVector<qint64> bounds = MetricsHistogram::bucketBounds();
+
+    histogram->record(0);
+    histogram->record(bounds.first());
+    histogram->record(bounds.first() + 1);
+    histogram->record(bounds.last() + 1);
+
+    QCOMPARE(histogram->count(), qint64(4));
+    QCOMPARE(histogram->sum(), bounds.first() * 2 + 1 + bounds.last() + 1);
+    QCOMPARE(histogram->bucketCount(0), qint64(2));
+    QCOMPARE(histogram->bucketCount(1), qint64(1));
+    QCOMPARE(histogram->bucketCount(bounds.count()), qint64(1));
+
+    // Buckets are cumulative in the text output.
+    QString text = Metrics::instance()->toText();
+    QVERIFY(text.contains(QString("test_latency_ms_bucket{le=\"%1\"} 3\n").arg(bounds.at(1))));
+    QVERIFY(text.contains("test_latency_ms_bucket{le=\"+Inf\"} 4\n"));
+    QVERIFY(text.contains("test_latency_ms_count 4\n"));
+}
+
+QTEST_GUILESS_MAIN(Buteo::MetricsTest)
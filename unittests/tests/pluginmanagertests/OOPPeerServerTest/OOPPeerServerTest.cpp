@@ -0,0 +1,82 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "OOPPeerServerTest.h"
+#include "OOPPeerServer.h"
+
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusPendingReply>
+#include <QTemporaryDir>
+
+using namespace Buteo;
+
+static const QString PEER_NAME = QStringLiteral("oopPeerServerTest");
+
+// The server lives on this thread, so calls to it must not block.
+static QDBusPendingReply<bool> attach(const QDBusConnection &aPeer, const QString &aProfileName)
+{
+    QDBusMessage call = QDBusMessage::createMethodCall(QString(), QStringLiteral("/msyncd"),
+                                                       QStringLiteral("com.buteo.msyncd.pluginpeer"),
+                                                       QStringLiteral("attach"));
+    call << aProfileName;
+    return aPeer.asyncCall(call);
+}
+
+void OOPPeerServerTest::testAttach()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    OOPPeerServer server(dir.path());
+    QVERIFY(server.isConnected());
+    QVERIFY(!server.peerConnection("profile").isConnected());
+
+    QDBusConnection peer = QDBusConnection::connectToPeer(server.address(), PEER_NAME);
+    QVERIFY(peer.isConnected());
+
+    QDBusPendingReply<bool> reply = attach(peer, "profile");
+    QTRY_VERIFY(reply.isFinished());
+    QVERIFY(reply.isValid());
+    QVERIFY(reply.value());
+    QVERIFY(server.peerConnection("profile").isConnected());
+    QVERIFY(!server.peerConnection("other").isConnected());
+
+    QDBusConnection::disconnectFromPeer(PEER_NAME);
+}
+
+void OOPPeerServerTest::testPeerDisconnect()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    OOPPeerServer server(dir.path());
+    QDBusConnection peer = QDBusConnection::connectToPeer(server.address(), PEER_NAME);
+    QDBusPendingReply<bool> reply = attach(peer, "profile");
+    QTRY_VERIFY(reply.isFinished());
+    QCOMPARE(server.iPeers.count(), 1);
+
+    // A runner which exits is forgotten
+    QDBusConnection::disconnectFromPeer(PEER_NAME);
+    QTRY_COMPARE(server.iPeers.count(), 0);
+    QVERIFY(!server.peerConnection("profile").isConnected());
+}
+
+QTEST_GUILESS_MAIN(Buteo::OOPPeerServerTest)
@@ -0,0 +1,125 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "OOPProcessRegistryTest.h"
+#include "OOPProcessRegistry.h"
+
+#include <QProcess>
+
+using namespace Buteo;
+
+void OOPProcessRegistryTest::init()
+{
+    iPath = QDir::tempPath() + QStringLiteral("/oopprocessregistrytest/runners");
+    QFile::remove(iPath);
+}
+
+void OOPProcessRegistryTest::cleanup()
+{
+    QFile::remove(iPath);
+}
+
+void OOPProcessRegistryTest::testAddRemove()
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    QVERIFY(OOPProcessRegistry::processStartTime(pid) > 0);
+
+    {
+        OOPProcessRegistry registry(iPath);
+        registry.add(pid);
+        QVERIFY(registry.contains(pid));
+    }
+
+    // Entries survive a restart
+    OOPProcessRegistry registry(iPath);
+    QVERIFY(registry.contains(pid));
+
+    registry.remove(pid);
+    QVERIFY(!registry.contains(pid));
+    QVERIFY(!OOPProcessRegistry(iPath).contains(pid));
+}
+
+void OOPProcessRegistryTest::testReapStale()
+{
+    QProcess process;
+    process.start(QStringLiteral("sleep"), QStringList() << QStringLiteral("30"));
+    QVERIFY(process.waitForStarted());
+
+    {
+        OOPProcessRegistry registry(iPath);
+        registry.add(process.processId());
+    }
+
+    OOPProcessRegistry registry(iPath);
+    QCOMPARE(registry.reapStale(), 1);
+    QVERIFY(process.waitForFinished(5000));
+    QCOMPARE(process.exitStatus(), QProcess::CrashExit);
+    QVERIFY(!registry.contains(process.processId()));
+}
+
+void OOPProcessRegistryTest::testReapStaleKillsStuckRunner()
+{
+    // A runner which ignores SIGTERM
+    QProcess process;
+    process.start(QStringLiteral("sh"), QStringList() << QStringLiteral("-c")
+                  << QStringLiteral("trap '' TERM; echo ready; while :; do sleep 1; done"));
+    QVERIFY(process.waitForStarted());
+    QVERIFY(process.waitForReadyRead(5000));
+
+    {
+        OOPProcessRegistry registry(iPath);
+        registry.add(process.processId());
+    }
+
+    OOPProcessRegistry registry(iPath);
+    QElapsedTimer timer;
+    timer.start();
+    QCOMPARE(registry.reapStale(500), 1);
+    QVERIFY(timer.elapsed() >= 500);
+    // Killed by the time reapStale() returns
+    QVERIFY(process.waitForFinished(1000));
+    QCOMPARE(process.exitStatus(), QProcess::CrashExit);
+}
+
+void OOPProcessRegistryTest::testRecycledPidIsNotKilled()
+{
+    QProcess process;
+    process.start(QStringLiteral("sleep"), QStringList() << QStringLiteral("30"));
+    QVERIFY(process.waitForStarted());
+    const qint64 pid = process.processId();
+
+    // Same pid, but a different start time than the recorded process
+    QVERIFY(QDir().mkpath(QFileInfo(iPath).absolutePath()));
+    QFile file(iPath);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+    file.write(QByteArray::number(pid) + ' '
+               + QByteArray::number(OOPProcessRegistry::processStartTime(pid) - 1) + '\n');
+    file.close();
+
+    OOPProcessRegistry registry(iPath);
+    QVERIFY(registry.contains(pid));
+    QCOMPARE(registry.reapStale(), 0);
+    QCOMPARE(process.state(), QProcess::Running);
+
+    process.kill();
+    process.waitForFinished();
+}
+
+QTEST_GUILESS_MAIN(Buteo::OOPProcessRegistryTest)
@@ -0,0 +1,88 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "OOPResourcePolicyTest.h"
+#include "OOPResourcePolicy.h"
+#include "Profile.h"
+#include "ProfileEngineDefs.h"
+
+#include <QProcess>
+
+using namespace Buteo;
+
+void OOPResourcePolicyTest::testFromProfile()
+{
+    OOPResourcePolicy defaults;
+    defaults.iNice = 5;
+    defaults.iMemoryLimit = 1024;
+    QVERIFY(OOPResourcePolicy().isEmpty());
+    QVERIFY(!defaults.isEmpty());
+
+    Profile profile("test", Profile::TYPE_CLIENT);
+    profile.setKey(KEY_PLUGIN_MEMORY_LIMIT, "64");
+    profile.setKey(KEY_PLUGIN_IO_PRIORITY, "9");
+    profile.setKey(KEY_PLUGIN_CPU_TIME_LIMIT, "invalid");
+
+    const OOPResourcePolicy policy = OOPResourcePolicy::fromProfile(profile, defaults);
+    QCOMPARE(policy.iNice, 5);
+    QCOMPARE(policy.iMemoryLimit, Q_INT64_C(64) * 1024 * 1024);
+    QCOMPARE(policy.iIoPriority, 7);
+    QCOMPARE(policy.iCpuTimeLimit, 0);
+    QCOMPARE(policy.iCpuQuota, 0);
+}
+
+void OOPResourcePolicyTest::testApply()
+{
+    QProcess process;
+    process.start(QStringLiteral("sleep"), QStringList() << QStringLiteral("30"));
+    QVERIFY(process.waitForStarted());
+
+    OOPResourcePolicy policy;
+    policy.iNice = 19;
+    policy.iCpuTimeLimit = 60;
+    QVERIFY(policy.apply(process.processId(), QString()).isEmpty());
+
+    QFile limits(QStringLiteral("/proc/%1/limits").arg(process.processId()));
+    QVERIFY(limits.open(QIODevice::ReadOnly));
+    bool found = false;
+    for (const QByteArray &line : limits.readAll().split('\n')) {
+        if (line.startsWith("Max cpu time")) {
+            QCOMPARE(line.mid(12).simplified().split(' ').value(0), QByteArray("60"));
+            found = true;
+        }
+    }
+    QVERIFY(found);
+
+    process.kill();
+    process.waitForFinished();
+    QVERIFY(!OOPResourcePolicy::limitExceeded(process));
+}
+
+void OOPResourcePolicyTest::testCpuTimeLimitExceeded()
+{
+    QProcess process;
+    process.start(QStringLiteral("sh"), QStringList() << QStringLiteral("-c")
+                  << QStringLiteral("kill -XCPU $$"));
+    QVERIFY(process.waitForFinished(5000));
+    QCOMPARE(process.exitStatus(), QProcess::CrashExit);
+    QVERIFY(OOPResourcePolicy::limitExceeded(process));
+}
+
+QTEST_GUILESS_MAIN(Buteo::OOPResourcePolicyTest)
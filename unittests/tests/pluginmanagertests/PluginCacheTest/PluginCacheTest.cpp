@@ -0,0 +1,135 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "PluginCacheTest.h"
+#include "PluginCache.h"
+
+#include <utime.h>
+
+using namespace Buteo;
+
+void PluginCacheTest::init()
+{
+    iDir = new QTemporaryDir;
+    QVERIFY(iDir->isValid());
+    iPluginPath = iDir->path() + QStringLiteral("/plugins/");
+    iCacheFile = iDir->path() + QStringLiteral("/cache/plugins.json");
+
+    QVERIFY(QDir().mkpath(iPluginPath + QStringLiteral("oopp")));
+    createFile(iPluginPath + QStringLiteral("libhcalendar-storage.so"));
+    createFile(iPluginPath + QStringLiteral("libhcalendar-changenotifier.so"));
+    createFile(iPluginPath + QStringLiteral("libsyncml-client.so"));
+    createFile(iPluginPath + QStringLiteral("libsyncml-server.so"));
+    createFile(iPluginPath + QStringLiteral("README"));
+    createFile(iPluginPath + QStringLiteral("oopp/libcaldav-client.so"));
+    // Storages are never run out of process
+    createFile(iPluginPath + QStringLiteral("oopp/libcaldav-storage.so"));
+}
+
+void PluginCacheTest::cleanup()
+{
+    delete iDir;
+    iDir = nullptr;
+}
+
+void PluginCacheTest::createFile(const QString &aPath)
+{
+    QFile file(aPath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+}
+
+void PluginCacheTest::testScan()
+{
+    PluginCache cache(iPluginPath, QString());
+    QVERIFY(!cache.isFromCache());
+
+    QMap<QString, PluginCache::Entry> entries;
+    for (const PluginCache::Entry &entry : cache.entries()) {
+        entries.insert(entry.iPath, entry);
+    }
+    QCOMPARE(entries.count(), 5);
+
+    const PluginCache::Entry storage = entries.value(iPluginPath + QStringLiteral("libhcalendar-storage.so"));
+    QCOMPARE(storage.iKind, PluginCache::STORAGE);
+    QCOMPARE(storage.iName, QStringLiteral("hcalendar"));
+    QVERIFY(!storage.iOutOfProcess);
+
+    const PluginCache::Entry notifier = entries.value(iPluginPath + QStringLiteral("libhcalendar-changenotifier.so"));
+    QCOMPARE(notifier.iKind, PluginCache::STORAGE_CHANGE_NOTIFIER);
+    QCOMPARE(notifier.iName, QStringLiteral("hcalendar"));
+
+    const PluginCache::Entry server = entries.value(iPluginPath + QStringLiteral("libsyncml-server.so"));
+    QCOMPARE(server.iKind, PluginCache::SERVER);
+    QCOMPARE(server.iName, QStringLiteral("syncml"));
+
+    const PluginCache::Entry oopClient = entries.value(iPluginPath + QStringLiteral("oopp/libcaldav-client.so"));
+    QCOMPARE(oopClient.iKind, PluginCache::CLIENT);
+    QCOMPARE(oopClient.iName, QStringLiteral("caldav"));
+    QVERIFY(oopClient.iOutOfProcess);
+
+    // Not a Qt plugin
+    QVERIFY(oopClient.iMetaData.isEmpty());
+}
+
+void PluginCacheTest::testCacheIsUsed()
+{
+    const int count = PluginCache(iPluginPath, iCacheFile).entries().count();
+    QVERIFY(QFile::exists(iCacheFile));
+
+    PluginCache cache(iPluginPath, iCacheFile);
+    QVERIFY(cache.isFromCache());
+    QCOMPARE(cache.entries().count(), count);
+}
+
+void PluginCacheTest::testCacheIsRefreshed()
+{
+    const int count = PluginCache(iPluginPath, iCacheFile).entries().count();
+
+    // Set the time explicitly, the file system may not record
+    // sub-second modification times.
+    createFile(iPluginPath + QStringLiteral("oopp/libcarddav-client.so"));
+    const QByteArray ooppPath = QFile::encodeName(iPluginPath + QStringLiteral("oopp"));
+    struct utimbuf times;
+    times.actime = times.modtime = QDateTime::currentDateTime().addSecs(10).toTime_t();
+    QCOMPARE(utime(ooppPath.constData(), &times), 0);
+
+    PluginCache cache(iPluginPath, iCacheFile);
+    QVERIFY(!cache.isFromCache());
+    QCOMPARE(cache.entries().count(), count + 1);
+    QVERIFY(PluginCache(iPluginPath, iCacheFile).isFromCache());
+}
+
+void PluginCacheTest::testOverwriteIsDetected()
+{
+    QVERIFY(!PluginCache(iPluginPath, iCacheFile).isFromCache());
+
+    // Overwriting a plugin in place leaves the directory untouched
+    const QDateTime directoryTime = QFileInfo(iPluginPath).lastModified();
+    QFile file(iPluginPath + QStringLiteral("libsyncml-client.so"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write("new build") > 0);
+    file.close();
+    QCOMPARE(QFileInfo(iPluginPath).lastModified(), directoryTime);
+
+    QVERIFY(!PluginCache(iPluginPath, iCacheFile).isFromCache());
+    QVERIFY(PluginCache(iPluginPath, iCacheFile).isFromCache());
+}
+
+QTEST_GUILESS_MAIN(Buteo::PluginCacheTest)
@@ -0,0 +1,267 @@
+/*
+ * This file is part of buteo-syncfw package
+ *
+ * Copyright (C) 2026 Jolla Ltd.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "StorageItemTest.h"
+#include "StorageItem.h"
+#include "StoragePlugin.h"
+#include "PluginManager.h"
+
+#include <QBuffer>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTemporaryFile>
+
+#define TEST_PLUGIN_PATH "/opt/tests/buteo-syncfw"
+
+using namespace Buteo;
+
+namespace {
+
+// Relies on the copying implementations of the payload accessors
+class MemoryItem : public StorageItem
+{
+public:
+    bool write(qint64 aOffset, const QByteArray &aData) override
+    {
+        if (aOffset < 0 || aOffset > iData.size()) {
+            return false;
+        }
+        iData.replace(aOffset, aData.size(), aData);
+        ++iWrites;
+        return true;
+    }
+
+    bool read(qint64 aOffset, qint64 aLength, QByteArray &aData) const override
+    {
+        if (aOffset < 0 || aOffset > iData.size()) {
+            return false;
+        }
+        aData = iData.mid(aOffset, aLength);
+        return true;
+    }
+
+    bool resize(qint64 aLen) override
+    {
+        iData.resize(aLen);
+        return true;
+    }
+
+    qint64 getSize() const override
+    {
+        return iData.size();
+    }
+
+    QByteArray iData;
+    int iWrites = 0;
+};
+
+// A stream which never delivers the rest of its data
+class StalledDevice : public QIODevice
+{
+public:
+    bool isSequential() const override
+    {
+        return true;
+    }
+
+    bool atEnd() const override
+    {
+        return false;
+    }
+
+    bool waitForReadyRead(int aMsecs) override
+    {
+        Q_UNUSED(aMsecs);
+        return false;
+    }
+
+protected:
+    qint64 readData(char *aData, qint64 aMaxSize) override
+    {
+        Q_UNUSED(aData);
+        Q_UNUSED(aMaxSize);
+        return 0;
+    }
+
+    qint64 writeData(const char *aData, qint64 aMaxSize) override
+    {
+        Q_UNUSED(aData);
+        Q_UNUSED(aMaxSize);
+        return -1;
+    }
+};
+
+// Returns views over a mapping of its file
+class MappedFileItem : public MemoryItem, public StorageItemDataAccess
+{
+public:
+    explicit MappedFileItem(QFile *aFile)
+        : iFile(aFile), iMap(aFile->map(0, aFile->size()))
+    {
+    }
+
+    QByteArray dataView(qint64 aOffset, qint64 aLength) const override
+    {
+        if (aLength < 0) {
+            aLength = iFile->size() - aOffset;
+        }
+        if (!iMap || aOffset < 0 || aOffset + aLength > iFile->size()) {
+            return QByteArray();
+        }
+        return QByteArray::fromRawData(reinterpret_cast<const char *>(iMap) + aOffset, aLength);
+    }
+
+    QFile *iFile;
+    uchar *iMap;
+};
+
+}
+
+void StorageItemTest::testView()
+{
+    MemoryItem item;
+    item.iData = "0123456789";
+
+    QCOMPARE(item.view(), QByteArray("0123456789"));
+    QCOMPARE(item.view(4), QByteArray("456789"));
+    QCOMPARE(item.view(2, 3), QByteArray("234"));
+    QVERIFY(item.view(11).isNull());
+    QVERIFY(item.view(-1, 2).isNull());
+}
+
+void StorageItemTest::testOpenReader()
+{
+    MemoryItem item;
+    item.iData = "line 1\nline 2\n";
+
+    QScopedPointer<QIODevice> reader(item.openReader());
+    QVERIFY(reader);
+    QVERIFY(reader->isReadable());
+    QCOMPARE(reader->readLine(), QByteArray("line 1\n"));
+    QCOMPARE(reader->readAll(), QByteArray("line 2\n"));
+    QVERIFY(reader->atEnd());
+}
+
+void StorageItemTest::testWriteFrom()
+{
+    // Larger than a single chunk
+    QByteArray data(200 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i % 251);
+    }
+
+    QBuffer source(&data);
+    QVERIFY(source.open(QIODevice::ReadOnly));
+
+    MemoryItem item;
+    item.iData = "previous content";
+    QVERIFY(item.writeFrom(&source));
+    QCOMPARE(item.iData, data);
+    QVERIFY(item.iWrites > 1);
+
+    // An empty device clears the item
+    QBuffer empty;
+    QVERIFY(empty.open(QIODevice::ReadOnly));
+    QVERIFY(item.writeFrom(&empty));
+    QCOMPARE(item.getSize(), qint64(0));
+
+    QBuffer closed;
+    QVERIFY(!item.writeFrom(&closed));
+    QVERIFY(!item.writeFrom(nullptr));
+
+    StalledDevice stalled;
+    QVERIFY(stalled.open(QIODevice::ReadOnly));
+    QVERIFY(!item.writeFrom(&stalled));
+}
+
+void StorageItemTest::testWriteFromSocket()
+{
+    QLocalServer server;
+    QVERIFY(server.listen(QStringLiteral("buteo-storageitemtest-%1").arg(QCoreApplication::applicationPid())));
+
+    QLocalSocket client;
+    client.connectToServer(server.fullServerName());
+    QVERIFY(client.waitForConnected());
+    QVERIFY(server.waitForNewConnection(5000));
+    QLocalSocket *peer = server.nextPendingConnection();
+    QVERIFY(peer);
+
+    // More than a chunk, but within the socket buffer of the kernel
+    const QByteArray data(96 * 1024, 'x');
+    peer->write(data);
+    while (peer->bytesToWrite() > 0) {
+        QVERIFY(peer->waitForBytesWritten());
+    }
+    peer->disconnectFromServer();
+
+    // Nothing has been read by the client yet, so its first read is empty
+    MemoryItem item;
+    QVERIFY(item.writeFrom(&client));
+    QCOMPARE(item.iData.size(), data.size());
+    QCOMPARE(item.iData, data);
+}
+
+void StorageItemTest::testMappedView()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.write("mapped item data");
+    QVERIFY(file.flush());
+
+    MappedFileItem item(&file);
+    QVERIFY(item.iMap);
+
+    const QByteArray view = item.view(7, 4);
+    QCOMPARE(view, QByteArray("item"));
+    QCOMPARE(reinterpret_cast<const uchar *>(view.constData()), item.iMap + 7);
+
+    // The default reader is served from the mapping as well
+    QScopedPointer<QIODevice> reader(item.openReader());
+    QVERIFY(reader);
+    QCOMPARE(reader->readAll(), QByteArray("mapped item data"));
+}
+
+void StorageItemTest::testSharedView()
+{
+    PluginManager pluginManager(TEST_PLUGIN_PATH);
+
+    StoragePlugin *storage = pluginManager.createStorage("hdummy");
+    QVERIFY(storage);
+    QMap<QString, QString> properties;
+    properties.insert("item_count", "1");
+    QVERIFY(storage->init(properties));
+    StorageItem *item = storage->getItem("1");
+    QVERIFY(item);
+
+    // Both views share the buffer of the item
+    const QByteArray first = item->view();
+    const QByteArray second = item->view();
+    QCOMPARE(first, QByteArray("item 1"));
+    QCOMPARE(first.constData(), second.constData());
+
+    // A part of the data is a copy
+    QCOMPARE(item->view(5, 1), QByteArray("1"));
+    QVERIFY(item->view(7).isNull());
+
+    delete item;
+    pluginManager.destroyStorage(storage);
+}
+
+QTEST_GUILESS_MAIN(Buteo::StorageItemTest)
@@ -23,11 +23,54 @@
 #include "StoragePluginTest.h"
 
 #include "PluginManager.h"
+#include "StoragePlugin.h"
+#include "StorageItem.h"
+#include "StorageItemCursor.h"
 
 #define TEST_PLUGIN_PATH "/opt/tests/buteo-syncfw"
 
 using namespace Buteo;
 
+namespace {
+
+// Forwards to another storage, but without a cursor of its own
+class ListOnlyStorage : public StoragePlugin
+{
+public:
+    explicit ListOnlyStorage( StoragePlugin *aStorage )
+        : StoragePlugin( aStorage->getPluginName() ), iStorage( aStorage ) {}
+
+    bool init( const QMap<QString, QString> &aProperties ) { return iStorage->init( aProperties ); }
+    bool uninit() { return iStorage->uninit(); }
+    bool getAllItems( QList<StorageItem *> &aItems ) { return iStorage->getAllItems( aItems ); }
+    bool getAllItemIds( QList<QString> &aItems ) { return iStorage->getAllItemIds( aItems ); }
+    bool getNewItems( QList<StorageItem *> &aItems, const QDateTime &aTime )
+    { return iStorage->getNewItems( aItems, aTime ); }
+    bool getNewItemIds( QList<QString> &aItemIds, const QDateTime &aTime )
+    { return iStorage->getNewItemIds( aItemIds, aTime ); }
+    bool getModifiedItems( QList<StorageItem *> &aItems, const QDateTime &aTime )
+    { return iStorage->getModifiedItems( aItems, aTime ); }
+    bool getModifiedItemIds( QList<QString> &aItemIds, const QDateTime &aTime )
+    { return iStorage->getModifiedItemIds( aItemIds, aTime ); }
+    bool getDeletedItemIds( QList<QString> &aItemIds, const QDateTime &aTime )
+    { return iStorage->getDeletedItemIds( aItemIds, aTime ); }
+    StorageItem *newItem() { return iStorage->newItem(); }
+    StorageItem *getItem( const QString &aItemId ) { return iStorage->getItem( aItemId ); }
+    QList<StorageItem *> getItems( const QStringList &aItemIds ) { return iStorage->getItems( aItemIds ); }
+    OperationStatus addItem( StorageItem &aItem ) { return iStorage->addItem( aItem ); }
+    QList<OperationStatus> addItems( const QList<StorageItem *> &aItems ) { return iStorage->addItems( aItems ); }
+    OperationStatus modifyItem( StorageItem &aItem ) { return iStorage->modifyItem( aItem ); }
+    QList<OperationStatus> modifyItems( const QList<StorageItem *> &aItems )
+    { return iStorage->modifyItems( aItems ); }
+    OperationStatus deleteItem( const QString &aItemId ) { return iStorage->deleteItem( aItemId ); }
+    QList<OperationStatus> deleteItems( const QList<QString> &aItemIds ) { return iStorage->deleteItems( aItemIds ); }
+
+private:
+    StoragePlugin *iStorage;
+};
+
+}
+
 void StoragePluginTest::testCreateDestroy()
 {
     PluginManager pluginManager( TEST_PLUGIN_PATH );
@@ -50,4 +93,118 @@ void StoragePluginTest::testCreateDestroy()
     QVERIFY( pluginManager.iLoadedDlls.count() == 0 );
 }
 
+void StoragePluginTest::testResidency()
+{
+    PluginManager pluginManager( TEST_PLUGIN_PATH );
+    pluginManager.setPluginResidency( 1, 0 );
+
+    StoragePlugin *storage1 = pluginManager.createStorage( "hdummy" );
+    QVERIFY( storage1 );
+    pluginManager.destroyStorage( storage1 );
+
+    // The library stays loaded without a plugin instance
+    QCOMPARE( pluginManager.iLoadedDlls.count(), 1 );
+    QCOMPARE( pluginManager.iResidentDlls.count(), 1 );
+
+    StoragePlugin *storage2 = pluginManager.createStorage( "hdummy" );
+    QVERIFY( storage2 );
+    QCOMPARE( pluginManager.iLoadedDlls.count(), 1 );
+    QCOMPARE( pluginManager.iResidentDlls.count(), 0 );
+    pluginManager.destroyStorage( storage2 );
+
+    // Dropping the limit unloads the resident library
+    pluginManager.setPluginResidency( 0, 0 );
+    QCOMPARE( pluginManager.iLoadedDlls.count(), 0 );
+    QCOMPARE( pluginManager.iResidentDlls.count(), 0 );
+}
+
+void StoragePluginTest::testCursor()
+{
+    PluginManager pluginManager( TEST_PLUGIN_PATH );
+
+    StoragePlugin *storage = pluginManager.createStorage( "hdummy" );
+    QVERIFY( storage );
+    QMap<QString, QString> properties;
+    properties.insert( "item_count", "25" );
+    QVERIFY( storage->init( properties ) );
+
+    // The plugin serves the cursor itself
+    QVERIFY( qobject_cast<StorageCursorProvider *>( storage ) );
+    QScopedPointer<StorageItemCursor> cursor( storage->openCursor( StoragePlugin::ALL_ITEMS ) );
+    QVERIFY( cursor );
+    QVERIFY( cursor->resumeToken().startsWith( "dummy:" ) );
+
+    QList<QString> itemIds;
+    QVERIFY( cursor->nextItemIds( 10, itemIds ) );
+    QCOMPARE( itemIds.count(), 10 );
+    QCOMPARE( itemIds.first(), QString( "1" ) );
+
+    QList<StorageItem *> items;
+    QVERIFY( cursor->nextItems( 10, items ) );
+    QCOMPARE( items.count(), 10 );
+    QCOMPARE( items.first()->getId(), QString( "11" ) );
+    QByteArray data;
+    QVERIFY( items.first()->read( 0, items.first()->getSize(), data ) );
+    QCOMPARE( data, QByteArray( "item 11" ) );
+    qDeleteAll( items );
+    QVERIFY( !cursor->atEnd() );
+
+    // A new cursor continues where the old one stopped
+    QScopedPointer<StorageItemCursor> resumed( storage->openCursor( StoragePlugin::ALL_ITEMS, QDateTime(),
+                                                                   cursor->resumeToken() ) );
+    QVERIFY( resumed );
+    QVERIFY( resumed->nextItemIds( 10, itemIds ) );
+    QCOMPARE( itemIds.count(), 5 );
+    QCOMPARE( itemIds.first(), QString( "21" ) );
+    QVERIFY( resumed->atEnd() );
+    QVERIFY( resumed->nextItemIds( 10, itemIds ) );
+    QVERIFY( itemIds.isEmpty() );
+
+    QVERIFY( !storage->openCursor( StoragePlugin::ALL_ITEMS, QDateTime(), "bogus" ) );
+
+    // Deleted items only have ids
+    QScopedPointer<StorageItemCursor> deleted( storage->openCursor( StoragePlugin::DELETED_ITEMS, QDateTime::currentDateTime() ) );
+    QVERIFY( deleted );
+    QVERIFY( !deleted->nextItems( 10, items ) );
+
+    pluginManager.destroyStorage( storage );
+}
+
+void StoragePluginTest::testListCursor()
+{
+    PluginManager pluginManager( TEST_PLUGIN_PATH );
+
+    StoragePlugin *dummy = pluginManager.createStorage( "hdummy" );
+    QVERIFY( dummy );
+    ListOnlyStorage storage( dummy );
+    QMap<QString, QString> properties;
+    properties.insert( "item_count", "15" );
+    QVERIFY( storage.init( properties ) );
+
+    // Plugins without a cursor of their own are served from the lists
+    QVERIFY( !qobject_cast<StorageCursorProvider *>( &storage ) );
+    QScopedPointer<StorageItemCursor> cursor( storage.openCursor( StoragePlugin::ALL_ITEMS ) );
+    QVERIFY( cursor );
+
+    QList<StorageItem *> items;
+    QVERIFY( cursor->nextItems( 10, items ) );
+    QCOMPARE( items.count(), 10 );
+    QCOMPARE( items.first()->getId(), QString( "1" ) );
+    qDeleteAll( items );
+    QCOMPARE( cursor->resumeToken(), QString( "10" ) );
+
+    QScopedPointer<StorageItemCursor> resumed( storage.openCursor( StoragePlugin::ALL_ITEMS, QDateTime(),
+                                                                   cursor->resumeToken() ) );
+    QVERIFY( resumed );
+    QList<QString> itemIds;
+    QVERIFY( resumed->nextItemIds( 10, itemIds ) );
+    QCOMPARE( itemIds.count(), 5 );
+    QCOMPARE( itemIds.first(), QString( "11" ) );
+    QVERIFY( resumed->atEnd() );
+
+    QVERIFY( !storage.openCursor( StoragePlugin::ALL_ITEMS, QDateTime(), "bogus" ) );
+
+    pluginManager.destroyStorage( dummy );
+}
+
 QTEST_GUILESS_MAIN(Buteo::StoragePluginTest)
@@ -34,6 +34,9 @@ class StoragePluginTest : public QObject
 private slots:
 
     void testCreateDestroy();
+    void testResidency();
+    void testCursor();
+    void testListCursor();
 
 private:
 
@@ -2,5 +2,11 @@ TEMPLATE = subdirs
 SUBDIRS = \
         ClientPluginTest \
         DeletedItemsIdStorageTest \
+        MetricsTest \
+        OOPPeerServerTest \
+        OOPProcessRegistryTest \
+        OOPResourcePolicyTest \
+        PluginCacheTest \
         ServerPluginTest \
+        StorageItemTest \
         StoragePluginTest \
@@ -29,6 +29,9 @@
 
 #include <QScopedPointer>
 #include <QFile>
+#include <QTemporaryDir>
+#include <QSettings>
+#include <QDomDocument>
 
 using namespace Buteo;
 
@@ -687,4 +690,120 @@ void ProfileManagerTest::testBackup()
     QVERIFY(!QFile::exists(fileName + ".bak"));
 }
 
+void ProfileManagerTest::testRetries()
+{
+    QTemporaryDir configDir;
+    QVERIFY(configDir.isValid());
+    QVERIFY(QDir(configDir.path()).mkpath(Profile::TYPE_SYNC));
+
+    QDomDocument doc;
+    QVERIFY(doc.setContent(QString("<profile name=\"retrying\" type=\"sync\">"
+                                   "<attempts>"
+                                   "<attemptdelay value=\"1\"/>"
+                                   "<attemptdelay value=\"1\"/>"
+                                   "<attemptdelay value=\"1\"/>"
+                                   "</attempts>"
+                                   "</profile>")));
+    SyncProfile profile(doc.documentElement());
+    QCOMPARE(profile.retryIntervals().count(), 3);
+
+    {
+        ProfileManager pm;
+        pm.setPaths(configDir.path(), SYSTEMPROFILE_DIR);
+
+        // No retries before the profile has been registered.
+        QVERIFY(!pm.getNextRetryInterval(&profile, SyncResults::CONNECTION_ERROR).isValid());
+
+        // Delay is randomized, but grows with the attempt and stays bounded.
+        pm.addRetriesInfo(&profile);
+        QDateTime now = QDateTime::currentDateTime();
+        QDateTime first = pm.getNextRetryInterval(&profile, SyncResults::PLUGIN_ERROR);
+        QVERIFY(first.isValid());
+        QVERIFY(now.secsTo(first) >= 60);
+        QVERIFY(now.secsTo(first) <= 61);
+    }
+
+    {
+        // Attempt count survives a restart.
+        ProfileManager pm;
+        pm.setPaths(configDir.path(), SYSTEMPROFILE_DIR);
+        pm.addRetriesInfo(&profile);
+        QDateTime now = QDateTime::currentDateTime();
+        QDateTime second = pm.getNextRetryInterval(&profile, SyncResults::PLUGIN_ERROR);
+        QVERIFY(second.isValid());
+        QVERIFY(now.secsTo(second) <= 121);
+        QVERIFY(pm.getNextRetryInterval(&profile, SyncResults::CONNECTION_ERROR).isValid());
+        QVERIFY(!pm.getNextRetryInterval(&profile, SyncResults::CONNECTION_ERROR).isValid());
+
+        // Authentication failures are not retried.
+        pm.retriesDone(profile.name());
+        pm.addRetriesInfo(&profile);
+        QVERIFY(!pm.getNextRetryInterval(&profile, SyncResults::AUTHENTICATION_FAILURE).isValid());
+    }
+
+    {
+        // Retry state of a removed profile is dropped.
+        const QString retriesFile = configDir.path() + "/sync/retries.ini";
+        ProfileManager pm;
+        pm.setPaths(configDir.path(), SYSTEMPROFILE_DIR);
+        QVERIFY(!pm.updateProfile(profile).isEmpty());
+        pm.addRetriesInfo(&profile);
+        QVERIFY(pm.getNextRetryInterval(&profile, SyncResults::PLUGIN_ERROR).isValid());
+        QVERIFY(QSettings(retriesFile, QSettings::IniFormat).childGroups().contains(profile.name()));
+        QVERIFY(pm.removeProfile(profile.name()));
+        QVERIFY(!QSettings(retriesFile, QSettings::IniFormat).childGroups().contains(profile.name()));
+    }
+}
+
+void ProfileManagerTest::testRetryBackoff()
+{
+    QTemporaryDir configDir;
+    QVERIFY(configDir.isValid());
+    QVERIFY(QDir(configDir.path()).mkpath(Profile::TYPE_SYNC));
+
+    QDomDocument doc;
+    QVERIFY(doc.setContent(QString("<profile name=\"backoff\" type=\"sync\">"
+                                   "<attempts>"
+                                   "<attemptdelay value=\"1\"/>"
+                                   "<attemptdelay value=\"10\"/>"
+                                   "</attempts>"
+                                   "</profile>")));
+    SyncProfile profile(doc.documentElement());
+
+    ProfileManager pm;
+    pm.setPaths(configDir.path(), SYSTEMPROFILE_DIR);
+
+    // The delay is random, so sample it enough times to see the bound.
+    const int SAMPLES = 50;
+    qint64 maxPluginError = 0;
+    qint64 maxConnectionError = 0;
+    qint64 maxSecondAttempt = 0;
+    for (int i = 0; i < SAMPLES; ++i) {
+        pm.retriesDone(profile.name());
+        pm.addRetriesInfo(&profile);
+        QDateTime now = QDateTime::currentDateTime();
+        maxPluginError = qMax(maxPluginError,
+                              now.secsTo(pm.getNextRetryInterval(&profile, SyncResults::PLUGIN_ERROR)));
+
+        pm.retriesDone(profile.name());
+        pm.addRetriesInfo(&profile);
+        now = QDateTime::currentDateTime();
+        maxConnectionError = qMax(maxConnectionError,
+                                  now.secsTo(pm.getNextRetryInterval(&profile, SyncResults::CONNECTION_ERROR)));
+        now = QDateTime::currentDateTime();
+        maxSecondAttempt = qMax(maxSecondAttempt,
+                                now.secsTo(pm.getNextRetryInterval(&profile, SyncResults::PLUGIN_ERROR)));
+    }
+
+    // Only connection errors double the bound of the first interval.
+    QVERIFY(maxPluginError <= 61);
+    QVERIFY(maxConnectionError > 61);
+    QVERIFY(maxConnectionError <= 121);
+
+    // The doubled first interval is two minutes, but the ten minute
+    // interval of the second attempt is a floor for the bound.
+    QVERIFY(maxSecondAttempt > 121);
+    QVERIFY(maxSecondAttempt <= 601);
+}
+
 QTEST_GUILESS_MAIN(Buteo::ProfileManagerTest)
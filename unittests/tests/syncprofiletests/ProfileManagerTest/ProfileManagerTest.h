@@ -47,6 +47,8 @@ private slots:
     void testRemovingProfiles();
     void testOverrideKey();
     void testBackup();
+    void testRetries();
+    void testRetryBackoff();
 };
 
 }
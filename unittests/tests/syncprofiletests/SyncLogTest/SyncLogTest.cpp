@@ -22,7 +22,11 @@
  */
 #include "SyncLogTest.h"
 
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QDBusServer>
 #include <QDomDocument>
+#include <QTemporaryDir>
 
 #include "SyncLog.h"
 
@@ -298,4 +302,109 @@ void SyncLogTest::testAddDetails()
                                  TargetResults::ITEM_OPERATION_FAILED).isEmpty());
 }
 
+void SyncLogTest::testDBusSignature()
+{
+    SyncResults::registerDBusTypes();
+
+    QCOMPARE(QString::fromLatin1(QDBusMetaType::typeToSignature(qMetaTypeId<TargetResults>())),
+             QStringLiteral("(s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis))"));
+    QCOMPARE(QString::fromLatin1(QDBusMetaType::typeToSignature(qMetaTypeId<SyncResults>())),
+             QStringLiteral("(xiisba(s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis)))"));
+}
+
+void SyncLogTest::testDBusRoundTrip()
+{
+    SyncResults::registerDBusTypes();
+
+    // Sync times carry milliseconds, which must survive the round trip
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(Q_INT64_C(1253021637123));
+    SyncResults results(time, SyncResults::SYNC_RESULT_FAILED, SyncResults::CONNECTION_ERROR);
+    results.setTargetId(QLatin1String("target-id"));
+    results.setScheduled(true);
+
+    TargetResults target(QLatin1String("hcalendar"), ItemCounts(1, 2, 3), ItemCounts(4, 5, 6));
+    target.addLocalDetails(QLatin1String("123456-7"), TargetResults::ITEM_ADDED);
+    target.addLocalDetails(QLatin1String("123456-11"), TargetResults::ITEM_ADDED,
+                           TargetResults::ITEM_OPERATION_FAILED,
+                           QLatin1String(FAILURE_MESSAGE));
+    target.addRemoteDetails(QLatin1String("147258-9"), TargetResults::ITEM_MODIFIED);
+    target.addRemoteDetails(QLatin1String("147258-11"), TargetResults::ITEM_DELETED,
+                            TargetResults::ITEM_OPERATION_FAILED,
+                            QLatin1String(FAILURE_SERVER));
+    results.addTargetResults(target);
+
+    // A QDBusArgument written in memory cannot be read back, so send the
+    // results over a peer connection to have them really marshalled.
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QDBusServer server(QStringLiteral("unix:dir=") + dir.path());
+    QVERIFY(server.isConnected());
+
+    bool accepted = false;
+    connect(&server, &QDBusServer::newConnection, this,
+            [this, &accepted](const QDBusConnection &aConnection) {
+        QDBusConnection connection(aConnection);
+        accepted = connection.connect(QString(), QStringLiteral("/synclogtest"),
+                                      QStringLiteral("com.buteo.synclogtest"),
+                                      QStringLiteral("results"),
+                                      this, SLOT(onResults(QDBusMessage)));
+    });
+
+    const QString peerName = QStringLiteral("syncLogTest");
+    QDBusConnection peer = QDBusConnection::connectToPeer(server.address(), peerName);
+    QVERIFY(peer.isConnected());
+    QTRY_VERIFY(accepted);
+
+    iReceived = QDBusMessage();
+    QDBusMessage signal = QDBusMessage::createSignal(QStringLiteral("/synclogtest"),
+                                                     QStringLiteral("com.buteo.synclogtest"),
+                                                     QStringLiteral("results"));
+    signal << QVariant::fromValue(results);
+    QVERIFY(peer.send(signal));
+    QTRY_COMPARE(iReceived.type(), QDBusMessage::SignalMessage);
+    QDBusConnection::disconnectFromPeer(peerName);
+
+    QCOMPARE(iReceived.signature(),
+             QStringLiteral("(xiisba(s(uuu)a(sis)a(sis)a(sis)(uuu)a(sis)a(sis)a(sis)))"));
+    SyncResults copy = qdbus_cast<SyncResults>(iReceived.arguments().at(0));
+
+    QCOMPARE(copy.syncTime(), time);
+    QCOMPARE(copy.syncTime().toMSecsSinceEpoch(), time.toMSecsSinceEpoch());
+    QCOMPARE(copy.majorCode(), SyncResults::SYNC_RESULT_FAILED);
+    QCOMPARE(copy.minorCode(), SyncResults::CONNECTION_ERROR);
+    QCOMPARE(copy.getTargetId(), QLatin1String("target-id"));
+    QVERIFY(copy.isScheduled());
+    QCOMPARE(copy.targetResults().count(), 1);
+
+    const TargetResults copied = copy.targetResults().first();
+    QCOMPARE(copied.targetName(), QLatin1String("hcalendar"));
+    QCOMPARE(copied.localItems().added, target.localItems().added);
+    QCOMPARE(copied.localItems().deleted, target.localItems().deleted);
+    QCOMPARE(copied.localItems().modified, target.localItems().modified);
+    QCOMPARE(copied.remoteItems().added, target.remoteItems().added);
+    QCOMPARE(copied.remoteItems().deleted, target.remoteItems().deleted);
+    QCOMPARE(copied.remoteItems().modified, target.remoteItems().modified);
+    QCOMPARE(copied.localDetails(TargetResults::ITEM_ADDED,
+                                 TargetResults::ITEM_OPERATION_SUCCEEDED),
+             QList<QString>() << QLatin1String("123456-7"));
+    QCOMPARE(copied.localDetails(TargetResults::ITEM_ADDED,
+                                 TargetResults::ITEM_OPERATION_FAILED),
+             QList<QString>() << QLatin1String("123456-11"));
+    QCOMPARE(copied.localMessage(QLatin1String("123456-11")),
+             QLatin1String(FAILURE_MESSAGE));
+    QCOMPARE(copied.remoteDetails(TargetResults::ITEM_MODIFIED,
+                                  TargetResults::ITEM_OPERATION_SUCCEEDED),
+             QList<QString>() << QLatin1String("147258-9"));
+    QCOMPARE(copied.remoteDetails(TargetResults::ITEM_DELETED,
+                                  TargetResults::ITEM_OPERATION_FAILED),
+             QList<QString>() << QLatin1String("147258-11"));
+    QCOMPARE(copied.remoteMessage(QLatin1String("147258-11")),
+             QLatin1String(FAILURE_SERVER));
+}
+
+void SyncLogTest::onResults(const QDBusMessage &aMessage)
+{
+    iReceived = aMessage;
+}
+
 QTEST_GUILESS_MAIN(Buteo::SyncLogTest)
@@ -24,6 +24,7 @@
 #define SYNCLOGTEST_H
 
 #include <QtTest/QtTest>
+#include <QDBusMessage>
 
 namespace Buteo {
 
@@ -37,7 +38,14 @@ private slots:
     void testAddResults();
     void testAddDetails();
     void testDetailsFromXML();
+    void testDBusSignature();
+    void testDBusRoundTrip();
 
+public slots:
+    void onResults(const QDBusMessage &aMessage);
+
+private:
+    QDBusMessage iReceived;
 };
 
 }